@@ -8,6 +8,22 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "shader.h"
+#include "glResources.h"
+#include "renderQueue.h"
+#include "bounds.h"
+#include "lod.h"
+#include "bezierEval.h"
+#include "revolve.h"
+#include "tessellate.h"
+#include "tessellatedSurface.h"
+
+// how far, in the curve's own units, the surface may stray from the true one until setTolerance()
+#define BEZIER_DEFAULT_TOLERANCE 0.002f
+// even the coarsest level goes round in at least this many sides
+#define BEZIER_MIN_SIDES 6
+// sectors the sweep is split into when the GPU cuts the surface; each is cut into the spans of
+// TESSELLATION_INITIAL_SPANS along the curve
+#define BEZIER_PATCH_SECTORS 8
 
 # define PI 3.1416
 
@@ -34,223 +50,155 @@ public:
         this->specular = spec;
         this->shininess = shiny;
         this->texture = tex;
-        sphereVAO = hollowBezier(cntrlPoints.data(), ((unsigned int)cntrlPoints.size() / 3) - 1);
+        if (TessellationPath::shared().enabled())
+            buildPatches();
+        else
+            tessellate();
+    }
+    ~BezierCurve()
+    {
+        for (int level = 0; level < LOD_LEVELS; level++)
+            levels[level].release();
+    }
+
+    // cuts the surface again so it strays at most tolerance from the true one, in the curve's own
+    // units; between frames, as the old meshes are released. The GPU picks its own cut every frame
+    void setTolerance(float tolerance)
+    {
+        this->tolerance = tolerance;
+        if (patches.uploaded())
+            return;
+        for (int level = 0; level < LOD_LEVELS; level++)
+            levels[level].release();
+        tessellate();
+    }
+
+    float getTolerance() const
+    {
+        return tolerance;
+    }
 
+    // of the full level; 0 when the GPU cuts the surface
+    unsigned int getTriangleCount() const
+    {
+        return (unsigned int)levels[0].indexCount / 3;
     }
-    ~BezierCurve() {}
     // draw in VertexArray mode
     void drawBezierCurve(Shader& lightingShader, glm::mat4 model) const      // draw surface
     {
         //glBindTexture(GL_TEXTURE_2D, this->texture);
         lightingShader.use();
-        lightingShader.setVec3("material.ambient", glm::vec3(0.969, 0.776, 0.561));
-        lightingShader.setVec3("material.diffuse", glm::vec3(0.969, 0.776, 0.561));
-        lightingShader.setVec3("material.specular", glm::vec3(1.0f, 1.0f, 1.0f));
         lightingShader.setFloat("material.shininess", 32.0f);
+        lightingShader.setVec4("textureRange", glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
         lightingShader.setMat4("model", model);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, texture);
 
-        glBindVertexArray(sphereVAO);
+        bindVertexArray(levels[0].VAO);
         glDrawElements(GL_TRIANGLES,                    // primitive type
-            (unsigned int)indices.size(),          // # of indices
+            levels[0].indexCount,          // # of indices
             GL_UNSIGNED_INT,                 // data type
             (void*)0);                       // offset to indices
-
-        // unbind VAO
-        glBindVertexArray(0);
     }
 
-private:
-    // member functions
-    long long nCr(int n, int r)
+    void queueBezierCurve(RenderQueue& queue, Shader& lightingShader, const glm::mat4& model) const
     {
-        if (r > n / 2)
-            r = n - r; // because C(n, r) == C(n, n - r)
-        long long ans = 1;
-        int i;
-
-        for (i = 1; i <= r; i++)
+        if (patches.uploaded())
         {
-            ans *= n - r + i;
-            ans /= i;
+            patches.queue(queue, texture, texture, 32.0f, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), model);
+            return;
         }
-
-        return ans;
+        queue.addTextured(lightingShader, levels[0].VAO, levels[0].indexCount, texture, texture, 32.0f, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), model);
     }
-    //polynomial interpretation for N points
-    void BezierCurveFN(double t, float xy[2], GLfloat ctrlpoints[], int L)
+
+    // the same at the level the node's size on screen calls for
+    void queueBezierCurve(RenderQueue& queue, Shader& lightingShader, const glm::mat4& model, LodState& lod) const
     {
-        double y = 0;
-        double x = 0;
-        t = t > 1.0 ? 1.0 : t;
-        for (int i = 0; i < L + 1; i++)
+        if (patches.uploaded())
         {
-            long long ncr = nCr(L, i);
-            double oneMinusTpow = pow(1 - t, double(L - i));
-            double tPow = pow(t, double(i));
-            double coef = oneMinusTpow * tPow * ncr;
-            x += coef * ctrlpoints[i * 3];
-            y += coef * ctrlpoints[(i * 3) + 1];
-
+            patches.queue(queue, texture, texture, 32.0f, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), model);
+            return;
         }
-        xy[0] = float(x);
-        xy[1] = float(y);
+        const LodLevel& level = levels[LodSelector::shared().select(bounds.transformed(model), lod)];
+        queue.addTextured(lightingShader, level.VAO, level.indexCount, texture, texture, 32.0f, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), model);
     }
 
-
-    unsigned int hollowBezier(GLfloat ctrlpoints[], int L)
+    // the box of the vertex positions, before any model matrix
+    Bounds localBounds() const
     {
-        int i, j;
-        float x, y, z, r;                //current coordinates
-        float theta;
-        float nx, ny, nz, lengthInv;    // vertex normal
-        float s, t1; // texturecoord
-
-        const float dtheta = 2 * pi / ntheta;        //angular step size
-
-        float t = 0;
-        float dt = 1.0 / nt;
-        float xy[2];
+        return bounds;
+    }
 
-        for (i = 0; i <= nt; ++i)              //step through y
+private:
+    // every level at its tolerance; coarse levels first, so geometry is left holding the full one
+    void tessellate()
+    {
+        for (int level = LOD_LEVELS - 1; level >= 0; level--)
         {
-            BezierCurveFN(t, xy, ctrlpoints, L);
-            r = xy[0];
-            y = xy[1];
-            theta = 0;
-            t += dt;
-            lengthInv = 1.0 / r;
-            //u = 0;
-            //v = 0.025 * (nt - i);//(1/40)
-
-            for (j = 0; j <= ntheta; ++j)
-            {
-                double cosa = cos(theta);
-                double sina = sin(theta);
-                z = r * cosa;
-                x = r * sina;
-
-                coordinates.push_back(x);
-                coordinates.push_back(y);
-                coordinates.push_back(z);
-
-                // normalized vertex normal (nx, ny, nz)
-                // center point of the circle (0,y,0)
-                nx = (x - 0) * lengthInv;
-                ny = (y - y) * lengthInv;
-                nz = (z - 0) * lengthInv;
-
-                normals.push_back(nx);
-                normals.push_back(ny);
-                normals.push_back(nz);
-
-                s = (float)j / ntheta; // U-coordinate
-                t1 = (float)i / nt; // V-coordinate
-                texCoords.push_back(s);
-                texCoords.push_back(t1);
-
-                theta += dtheta;
-            }
+            hollowBezier(cntrlPoints.data(), ((unsigned int)cntrlPoints.size() / 3) - 1, lodTolerance(tolerance, level));
+            levels[level].upload(geometry.vertices, geometry.indices, 8);
         }
+        bounds = Bounds::fromVertices(geometry.vertices.data(), geometry.vertexCount(), 8);
+    }
 
-        // generate index list of triangles
-        // k1--k1+1
-        // |  / |
-        // | /  |
-        // k2--k2+1
-
-        int k1, k2;
-        for (int i = 0; i < nt; ++i)
+    // only the control points, for the GPU to cut; the patches follow the CPU mesh's sweep, texture
+    // coordinates and normals
+    void buildPatches()
+    {
+        BezierEvaluator curve(cntrlPoints.data(), ((int)cntrlPoints.size() / 3) - 1);
+        int first = patches.addProfile(curve);
+        float start = (float)(REVOLVE_FULL_TURN / 4.0), turn = (float)-REVOLVE_FULL_TURN;
+        for (int sector = 0; sector < BEZIER_PATCH_SECTORS; sector++)
         {
-            k1 = i * (ntheta + 1);     // beginning of current stack
-            k2 = k1 + ntheta + 1;      // beginning of next stack
-
-            for (int j = 0; j < ntheta; ++j, ++k1, ++k2)
+            float u0 = (float)sector / BEZIER_PATCH_SECTORS, u1 = (float)(sector + 1) / BEZIER_PATCH_SECTORS;
+            for (int span = 0; span < TESSELLATION_INITIAL_SPANS; span++)
             {
-                // k1 => k2 => k1+1
-                indices.push_back(k1);
-                indices.push_back(k2);
-                indices.push_back(k1 + 1);
-
-                // k1+1 => k2 => k2+1
-                indices.push_back(k1 + 1);
-                indices.push_back(k2);
-                indices.push_back(k2 + 1);
+                float t0 = (float)span / TESSELLATION_INITIAL_SPANS, t1 = (float)(span + 1) / TESSELLATION_INITIAL_SPANS;
+                SurfacePatch patch = { start + turn * u0, start + turn * u1, u0, u1, (float)first, (float)first, (float)(curve.degree() + 1), 1.0f,
+                    t0, t1, t0, t1 };
+                patches.addPatch(patch);
             }
         }
+        patches.upload();
 
-        size_t count = coordinates.size();
-        size_t counttex = texCoords.size();
-        for (int i = 0; i < count; i += 3)
+        // the curve never leaves the box of its control points
+        float widest = 0.0f, lowest = FLT_MAX, highest = -FLT_MAX;
+        for (size_t i = 0; i + 2 < cntrlPoints.size(); i += 3)
         {
-            vertices.push_back(coordinates[i]);
-            vertices.push_back(coordinates[i + 1]);
-            vertices.push_back(coordinates[i + 2]);
-
-            vertices.push_back(normals[i]);
-            vertices.push_back(normals[i + 1]);
-            vertices.push_back(normals[i + 2]);
-
-            size_t texIndex = i / 3 * 2;
-            vertices.push_back(texCoords[texIndex]);
-            vertices.push_back(texCoords[texIndex + 1]);
+            widest = std::max(widest, fabsf(cntrlPoints[i]));
+            lowest = std::min(lowest, cntrlPoints[i + 1]);
+            highest = std::max(highest, cntrlPoints[i + 1]);
         }
+        bounds = Bounds(glm::vec3(-widest, lowest, -widest), glm::vec3(widest, highest, widest));
+    }
 
-        unsigned int bezierVAO;
-        glGenVertexArrays(1, &bezierVAO);
-        glBindVertexArray(bezierVAO);
-
-        // create VBO to copy vertex data to VBO
-        unsigned int bezierVBO;
-        glGenBuffers(1, &bezierVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, bezierVBO);           // for vertex data
-        glBufferData(GL_ARRAY_BUFFER,                   // target
-            (unsigned int)vertices.size() * sizeof(float), // data size, # of bytes
-            vertices.data(),   // ptr to vertex data
-            GL_STATIC_DRAW);                   // usage
-
-        // create EBO to copy index data
-        unsigned int bezierEBO;
-        glGenBuffers(1, &bezierEBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bezierEBO);   // for index data
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,           // target
-            (unsigned int)indices.size() * sizeof(unsigned int),             // data size, # of bytes
-            indices.data(),               // ptr to index data
-            GL_STATIC_DRAW);                   // usage
-
-        // activate attrib arrays
-        glEnableVertexAttribArray(0);
-        glEnableVertexAttribArray(1);
-        glEnableVertexAttribArray(2);
-
-        // set attrib arrays with stride and offset
-        int stride = 32;     // should be 24 bytes
-        glVertexAttribPointer(0, 3, GL_FLOAT, false, stride, (void*)0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, false, stride, (void*)(sizeof(float) * 3));
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 6));
-
-        // unbind VAO, VBO and EBO
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-        return bezierVAO;
+    // the surface swept by the curve into geometry: rings where the curve bends, and as many sides
+    // as the widest ring needs
+    void hollowBezier(GLfloat ctrlpoints[], int L, float tolerance)
+    {
+        BezierEvaluator curve(ctrlpoints, L);
+        vector<float> ts = adaptiveParameters([&curve](float t) { return curve.point(t); }, tolerance);
+        vector<glm::vec2> profile(ts.size());
+        curve.points(ts.data(), ts.size(), profile.data());
+
+        float widest = 0.0f;
+        for (size_t i = 0; i < profile.size(); i++)
+            widest = std::max(widest, fabsf(profile[i].x));
+        int sides = chordSegments(widest, (float)REVOLVE_FULL_TURN, tolerance, BEZIER_MIN_SIDES);
+
+        // normals point straight away from the axis, whatever the slope of the curve
+        revolve([&profile, &ts](int i) {
+            ProfilePoint point = { profile[i].x, profile[i].y, 1.0f, 0.0f, ts[i] };
+            return point;
+        }, (int)ts.size(), RevolveSweep::arc(sides, (float)(REVOLVE_FULL_TURN / 4.0), (float)-REVOLVE_FULL_TURN), geometry);
     }
 
     // memeber vars
-    unsigned int sphereVAO;
-
-    const double pi = 3.14159265389;
-    const int nt = 40;
-    const int ntheta = 20;
-    vector<float> vertices;
-    vector<float> normals;
-    vector<unsigned int> indices;
-    vector<float> coordinates;
-    vector<float> texCoords;
-    int verticesStride;                 // # of bytes to hop to the next vertex (should be 24 bytes)
+    LodLevel levels[LOD_LEVELS];
+    PatchSurface patches;  // uploaded instead of levels when the TessellationPath is enabled
+    Bounds bounds;
+    float tolerance = BEZIER_DEFAULT_TOLERANCE;
+    RevolvedMesh geometry;  // the last level built, the full one once the constructor is done
 
 };
 
@@ -281,186 +229,63 @@ public:
     }
 
     ~BezierSculpt() {
-        glDeleteVertexArrays(1, &sphereVAO);
+        deleteVertexArrays(1, &sphereVAO);
+        deleteBuffers(1, &bezierVBO);
+        deleteBuffers(1, &bezierEBO);
     }
 
     void drawBezierSculpt(Shader& lightingShader, glm::mat4 model) const {
         lightingShader.use();
-        lightingShader.setVec3("material.ambient", glm::vec3(ambient));
-        lightingShader.setVec3("material.diffuse", glm::vec3(diffuse));
-        lightingShader.setVec3("material.specular", glm::vec3(specular));
         lightingShader.setFloat("material.shininess", shininess);
+        lightingShader.setVec4("textureRange", glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
         lightingShader.setMat4("model", model);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, texture);
 
-        glBindVertexArray(sphereVAO);
-        glDrawElements(GL_TRIANGLES, (unsigned int)indices.size(), GL_UNSIGNED_INT, (void*)0);
-        glBindVertexArray(0);
+        bindVertexArray(sphereVAO);
+        glDrawElements(GL_TRIANGLES, (unsigned int)geometry.indices.size(), GL_UNSIGNED_INT, (void*)0);
     }
 
 private:
     unsigned int sphereVAO;
-    const double pi = 3.14159265389;
+    unsigned int bezierVBO, bezierEBO;
     const int nt = 40;      // number of points along the curve
     const int ntheta = 20;  // number of points around the curve
-    vector<float> vertices;
-    vector<float> normals;
-    vector<unsigned int> indices;
-    vector<float> coordinates;
-    vector<float> texCoords;
+    RevolvedMesh geometry;
     const int stride = 8 * sizeof(float);  // 3 pos + 3 normal + 2 tex
 
-    long long nCr(int n, int r) {
-        if (r > n / 2)
-            r = n - r;
-        long long ans = 1;
-        for (int i = 1; i <= r; i++) {
-            ans *= n - r + i;
-            ans /= i;
-        }
-        return ans;
-    }
-
-    void BezierCurveFN(double t, float xy[2], GLfloat ctrlpoints[], int L) {
-        double y = 0, x = 0;
-        t = t > 1.0 ? 1.0 : t;
-        for (int i = 0; i < L + 1; i++) {
-            long long ncr = nCr(L, i);
-            double oneMinusTpow = pow(1 - t, double(L - i));
-            double tPow = pow(t, double(i));
-            double coef = oneMinusTpow * tPow * ncr;
-            x += coef * ctrlpoints[i * 3];
-            y += coef * ctrlpoints[(i * 3) + 1];
-        }
-        xy[0] = float(x);
-        xy[1] = float(y);
-    }
-
-    void BezierDerivative(double t, float dxy[2], GLfloat ctrlpoints[], int L) {
-        double dx = 0, dy = 0;
-        t = t > 1.0 ? 1.0 : t;
-        for (int i = 0; i < L; i++) {
-            long long ncr = nCr(L - 1, i);
-            double oneMinusTpow = pow(1 - t, double(L - 1 - i));
-            double tPow = pow(t, double(i));
-            double coef = L * oneMinusTpow * tPow * ncr;
-            dx += coef * (ctrlpoints[(i + 1) * 3] - ctrlpoints[i * 3]);
-            dy += coef * (ctrlpoints[(i + 1) * 3 + 1] - ctrlpoints[i * 3 + 1]);
-        }
-        dxy[0] = float(dx);
-        dxy[1] = float(dy);
-    }
-
     unsigned int hollowBezier(GLfloat ctrlpoints[], int L) {
-        vertices.clear();
-        normals.clear();
-        indices.clear();
-        coordinates.clear();
-        texCoords.clear();
-
-        int i, j;
-        float x, y, z, r, theta, nx, ny, nz, lengthInv;
-        const float dtheta = 2 * pi / ntheta;
-        float t = 0, dt = 1.0 / nt;
-        float xy[2], dxy[2];
-
-        // Generate points for the full curve but only one-third rotation
-        for (i = 0; i <= nt; ++i) {
-            BezierCurveFN(t, xy, ctrlpoints, L);
-            BezierDerivative(t, dxy, ctrlpoints, L);
-            r = xy[0];
-            y = xy[1];
-            theta = 0;
-
-            for (j = 0; j <= ntheta / 3; ++j) {
-                double cosa = cos(theta);
-                double sina = sin(theta);
-                x = r * cosa;
-                z = r * sina;
-
-                coordinates.push_back(x);
-                coordinates.push_back(y);
-                coordinates.push_back(z);
-
-                // Calculate surface normal using curve tangent and rotational direction
-                float tangentX = dxy[0] * cosa;
-                float tangentY = dxy[1];
-                float tangentZ = dxy[0] * sina;
-
-                // Rotational direction vector
-                float rotX = -sina;
-                float rotZ = cosa;
-
-                // Cross product to get normal
-                nx = tangentY * rotZ;
-                ny = -(tangentX * rotZ - tangentZ * rotX);
-                nz = -tangentY * rotX;
-
-                // Normalize
-                lengthInv = 1.0f / sqrt(nx * nx + ny * ny + nz * nz);
-                nx *= lengthInv;
-                ny *= lengthInv;
-                nz *= lengthInv;
-
-                normals.push_back(nx);
-                normals.push_back(ny);
-                normals.push_back(nz);
-
-                float s = (float)j / (ntheta / 3);
-                float t1 = (float)i / nt;
-                texCoords.push_back(s);
-                texCoords.push_back(t1);
-
-                theta += dtheta;
-            }
-            t += dt;
-        }
-
-        // Generate indices for triangles
-        for (int i = 0; i < nt; ++i) {
-            int k1 = i * (ntheta / 3 + 1);
-            int k2 = k1 + (ntheta / 3 + 1);
-
-            for (int j = 0; j < ntheta / 3; ++j, ++k1, ++k2) {
-                indices.push_back(k1);
-                indices.push_back(k2);
-                indices.push_back(k1 + 1);
-                indices.push_back(k1 + 1);
-                indices.push_back(k2);
-                indices.push_back(k2 + 1);
-            }
-        }
-
-        // Combine all vertex attributes
-        for (size_t i = 0; i < coordinates.size(); i += 3) {
-            vertices.push_back(coordinates[i]);
-            vertices.push_back(coordinates[i + 1]);
-            vertices.push_back(coordinates[i + 2]);
-
-            vertices.push_back(normals[i]);
-            vertices.push_back(normals[i + 1]);
-            vertices.push_back(normals[i + 2]);
-
-            size_t texIndex = (i / 3) * 2;
-            vertices.push_back(texCoords[texIndex]);
-            vertices.push_back(texCoords[texIndex + 1]);
-        }
+        // the profile and its slope for every step at once
+        float t = 0, dt = 1.0f / nt;
+        vector<float> ts;
+        for (int i = 0; i <= nt; ++i, t += dt)
+            ts.push_back(t);
+        BezierEvaluator curve(ctrlpoints, L);
+        vector<glm::vec2> profile(ts.size()), slope(ts.size());
+        curve.points(ts.data(), ts.size(), profile.data());
+        curve.derivatives(ts.data(), ts.size(), slope.data());
+
+        // the full curve but only one-third of the rotation; the normal is the slope turned a quarter
+        const int steps = nt, sides = ntheta / 3;
+        revolve([&profile, &slope, steps](int i) {
+            float lengthInv = 1.0f / sqrtf(slope[i].x * slope[i].x + slope[i].y * slope[i].y);
+            ProfilePoint point = { profile[i].x, profile[i].y, slope[i].y * lengthInv, -slope[i].x * lengthInv, (float)i / steps };
+            return point;
+        }, steps + 1, RevolveSweep::arc(sides, 0.0f, (float)(REVOLVE_FULL_TURN * sides / ntheta)), geometry);
 
         // Create and setup VAO, VBO, and EBO
-        unsigned int bezierVAO, bezierVBO, bezierEBO;
-        glGenVertexArrays(1, &bezierVAO);
-        glGenBuffers(1, &bezierVBO);
-        glGenBuffers(1, &bezierEBO);
+        unsigned int bezierVAO;
+        genVertexArrays(1, &bezierVAO);
+        genBuffers(1, &bezierVBO);
+        genBuffers(1, &bezierEBO);
 
-        glBindVertexArray(bezierVAO);
+        bindVertexArray(bezierVAO);
 
         glBindBuffer(GL_ARRAY_BUFFER, bezierVBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, geometry.vertices.size() * sizeof(float), geometry.vertices.data(), GL_STATIC_DRAW);
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bezierEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, geometry.indices.size() * sizeof(unsigned int), geometry.indices.data(), GL_STATIC_DRAW);
 
         // Position attribute
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
@@ -475,7 +300,7 @@ private:
         glEnableVertexAttribArray(2);
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        bindVertexArray(0);
 
         return bezierVAO;
     }
@@ -9,6 +9,20 @@
 
 using namespace std;
 
+// one entry of spotLights[] in the std140 LightBlock
+struct SpotLightStd140 {
+    glm::vec3 position;
+    float k_c;
+    glm::vec3 direction;
+    float k_l;
+    glm::vec3 ambient;
+    float k_q;
+    glm::vec3 diffuse;
+    float inner_circle;
+    glm::vec3 specular;
+    float outer_circle;
+};
+
 class SpotLight {
 public:
     glm::vec3 position;
@@ -22,6 +36,7 @@ public:
     float inner_circle;
     float outer_circle;
     int Number;
+    bool dirty = true;  // set whenever the light changes; the light block re-uploads it and clears this
 
     SpotLight(float posX, float posY, float posZ, float ambR, float ambG, float ambB, float diffR, float diffG, float diffB, float specR, float specG, float specB, float constant, float linear, float quadratic, int num, float in_circle, float out_circle, float dirX, float dirY, float dirZ) {
 
@@ -50,46 +65,49 @@ public:
         direction = glm::vec3(0, -1, 0);
         Number = 1;
     }
-    void setUpspotLight(Shader& lightingShader)
+    // writes the light as the shader sees it, with the on/off switches applied
+    void writeStd140(SpotLightStd140& block) const
     {
-        lightingShader.use();
-        string lightNumber = to_string(Number);
-        lightingShader.setVec3("spotLights[" + lightNumber + "].position", position);
-        lightingShader.setVec3("spotLights[" + lightNumber + "].ambient", ambient * ambientOn);
-        lightingShader.setVec3("spotLights[" + lightNumber + "].diffuse", diffuse * diffuseOn);
-        lightingShader.setVec3("spotLights[" + lightNumber + "].specular", specular * specularOn);
-        lightingShader.setFloat("spotLights[" + lightNumber + "].k_c", k_c);
-        lightingShader.setFloat("spotLights[" + lightNumber + "].k_l", k_l);
-        lightingShader.setFloat("spotLights[" + lightNumber + "].k_q", k_q);
-        lightingShader.setFloat("spotLights[" + lightNumber + "].inner_circle", inner_circle);
-        lightingShader.setFloat("spotLights[" + lightNumber + "].outer_circle", outer_circle);
-        lightingShader.setVec3("spotLights[" + lightNumber + "].direction", direction);
-
+        block.position = position;
+        block.direction = direction;
+        block.ambient = ambient * ambientOn;
+        block.diffuse = diffuse * diffuseOn;
+        block.specular = specular * specularOn;
+        block.k_c = k_c;
+        block.k_l = k_l;
+        block.k_q = k_q;
+        block.inner_circle = inner_circle;
+        block.outer_circle = outer_circle;
     }
     void turnOff()
     {
         ambientOn = 0.0;
         diffuseOn = 0.0;
         specularOn = 0.0;
+        dirty = true;
     }
     void turnOn()
     {
         ambientOn = 1.0;
         diffuseOn = 1.0;
         specularOn = 1.0;
+        dirty = true;
     }
     void turnAmbientOn()
     {
         ambientOn = 1.0;
+        dirty = true;
     }
     void turnDiffuseOn()
     {
         diffuseOn = 1.0;
+        dirty = true;
     }
 
     void turnSpecularOn()
     {
         specularOn = 1.0;
+        dirty = true;
     }
 
 
@@ -0,0 +1,164 @@
+//
+//  bakedScene.h
+//  test
+//
+//  The draw list of everything that does not move. Static nodes have their
+//  model matrix evaluated once at load time and kept in one contiguous array;
+//  per frame they are only drawn. The few dynamic nodes (the rotating sphere,
+//  the doors, the car) are tagged as such and evaluate their own transforms
+//  every frame, so the CPU cost of a frame follows the moving objects.
+//
+//  Every static node also keeps its world-space box. The boxes go into a
+//  bounding volume hierarchy, and draw() only calls the nodes whose box
+//  touches the view frustum. Dynamic nodes are few and always drawn.
+//
+//  On top of that each node belongs to a cell (see portals.h): from inside
+//  the building the outside is only drawn through the open doors, and the
+//  other way round. Dynamic nodes are tagged with their cell when added.
+//
+//  Large solid nodes (walls, roofs, floors) are baked with their triangles
+//  as occluders; what remains after the portals is tested against the depth
+//  buffer they leave in the OcclusionCuller (see occlusion.h).
+//
+
+#ifndef bakedScene_h
+#define bakedScene_h
+
+#include <glm/glm.hpp>
+#include <functional>
+#include <vector>
+#include "bounds.h"
+#include "bvh.h"
+#include "portals.h"
+#include "occlusion.h"
+
+// one column-major matrix per static node, 16-byte aligned so it can be copied into GPU buffers as is
+struct alignas(16) BakedTransform {
+    glm::mat4 model;
+};
+static_assert(sizeof(BakedTransform) == 64, "BakedTransform must stay tightly packed");
+
+class BakedScene {
+public:
+    typedef std::function<void(const glm::mat4&)> StaticDraw;
+    typedef std::function<void()> DynamicDraw;
+
+    unsigned int portalCulled = 0;     // static nodes in the frustum that the last draw() hid behind walls
+    unsigned int occlusionCulled = 0;  // static nodes past the portals that the last draw() found occluded
+
+    BakedScene() {}
+
+    BakedScene(const BakedScene&) = delete;
+    BakedScene& operator=(const BakedScene&) = delete;
+
+    // stores the already evaluated transform; draw receives it back every frame it is in view.
+    // localBounds is the box of the mesh that draw puts down, before model; a node with an
+    // occluder hides what is behind it and is itself never tested for occlusion
+    void bake(const glm::mat4& model, const Bounds& localBounds, StaticDraw draw, const OccluderMesh* occluder = NULL)
+    {
+        BakedTransform transform = { model };
+        transforms.push_back(transform);
+        worldBounds.push_back(localBounds.transformed(model));
+        staticDraws.push_back(draw);
+        occluderNodes.push_back(occluder != NULL);
+        if (occluder != NULL && !occluder->empty())
+        {
+            Occluder placed = { occluder, model, worldBounds.back() };
+            occluders.push_back(placed);
+        }
+        hierarchyBuilt = false;
+    }
+
+    // a node whose transform depends on per-frame state; draw computes it itself.
+    // It is skipped while nothing of its cell can be seen
+    void addDynamic(DynamicDraw draw, int cell = CELL_BOTH)
+    {
+        dynamicDraws.push_back(draw);
+        dynamicCells.push_back((unsigned char)cell);
+    }
+
+    // as soon as the camera is known, so the occluders are rasterized while the frame is set up
+    void beginOcclusion(OcclusionCuller& occlusion, const glm::mat4& viewProjection, const glm::vec3& eye) const
+    {
+        occlusion.begin(viewProjection, eye, occluders);
+    }
+
+    // frustum from projection * view; portals already updated and occlusion begun for this frame
+    void draw(const Frustum& frustum, const CellPortals& portals, OcclusionCuller& occlusion)
+    {
+        if (!hierarchyBuilt)
+        {
+            hierarchy.build(worldBounds);
+            cells.resize(worldBounds.size());
+            for (size_t i = 0; i < worldBounds.size(); i++)
+                cells[i] = (unsigned char)portals.classify(worldBounds[i]);
+            hierarchyBuilt = true;
+        }
+        hierarchy.query(frustum, visible);
+        size_t kept = 0;
+        for (size_t i = 0; i < visible.size(); i++)
+            if (portals.visible(cells[visible[i]], worldBounds[visible[i]]))
+                visible[kept++] = visible[i];
+        portalCulled = (unsigned int)(visible.size() - kept);
+        visible.resize(kept);
+
+        occlusion.wait();
+        kept = 0;
+        for (size_t i = 0; i < visible.size(); i++)
+            if (occluderNodes[visible[i]] || !occlusion.occluded(worldBounds[visible[i]]))
+                visible[kept++] = visible[i];
+        occlusionCulled = (unsigned int)(visible.size() - kept);
+        visible.resize(kept);
+
+        for (size_t i = 0; i < visible.size(); i++)
+            staticDraws[visible[i]](transforms[visible[i]].model);
+        for (size_t i = 0; i < dynamicDraws.size(); i++)
+            if (portals.cellVisible(dynamicCells[i]))
+                dynamicDraws[i]();
+    }
+
+    // static nodes the last draw() called
+    size_t visibleCount() const
+    {
+        return visible.size();
+    }
+
+    // hierarchy boxes the last draw() tested
+    unsigned int nodesTested() const
+    {
+        return hierarchy.nodesTested;
+    }
+
+    size_t staticCount() const
+    {
+        return staticDraws.size();
+    }
+
+    size_t dynamicCount() const
+    {
+        return dynamicDraws.size();
+    }
+
+private:
+    std::vector<BakedTransform> transforms;  // parallel to staticDraws
+    std::vector<Bounds> worldBounds;         // parallel to staticDraws
+    std::vector<StaticDraw> staticDraws;
+    std::vector<unsigned char> cells;        // parallel to staticDraws, classified with the hierarchy
+    std::vector<unsigned char> occluderNodes; // parallel to staticDraws
+    std::vector<Occluder> occluders;
+    std::vector<DynamicDraw> dynamicDraws;
+    std::vector<unsigned char> dynamicCells; // parallel to dynamicDraws
+    BoundingVolumeHierarchy hierarchy;
+    bool hierarchyBuilt = false;
+    std::vector<unsigned int> visible;
+};
+
+// what the scene file can place by name: the draw, the local box of its mesh and, for solid
+// meshes, the triangles that make it an occluder
+struct BakedDrawable {
+    BakedScene::StaticDraw draw;
+    Bounds bounds;
+    const OccluderMesh* occluder = NULL;
+};
+
+#endif /* bakedScene_h */
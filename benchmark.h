@@ -0,0 +1,775 @@
+//
+//  benchmark.h
+//  test
+//
+//  Headless frame-time benchmark:
+//
+//      Auditorium --benchmark <frames> [--benchmark-out <file.json>] [--texture-threads <n>]
+//                [--no-occlusion] [--no-tessellation]
+//
+//  renders offscreen (OSMesa on GLFW's null platform where available) along a
+//  fixed camera path at a fixed time step, so every run draws the same frames.
+//  --texture-threads 0 loads textures on the main thread, --no-occlusion skips
+//  the CPU depth buffer and --no-tessellation keeps the curved surfaces on the
+//  CPU. The JSON has the startup figures (texture_startup, curved_surfaces,
+//  forest), frame-time percentiles (cpu_frame_ms, frame_ms_with_finish) and
+//  per-frame averages of draws, triangles, binds, uniform uploads and culling
+//  (per_frame, state_filter_per_frame); draws are counted by wrapping glad's
+//  entry points, so triangles made from patches are not among them.
+//
+//      Auditorium --microbenchmark [<file.json>]
+//
+//  times the geometry generators on the CPU against the code they replaced
+//  (bezier_eval, revolve, fractal_tree) and exits without opening a window.
+//
+
+#ifndef benchmark_h
+#define benchmark_h
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "camera.h"
+#include "shader.h"
+#include "glState.h"
+#include "bezierEval.h"
+#include "revolve.h"
+#include "fractal.h"
+
+// frames drawn before measuring starts, so shader compilation and first uploads stay out of the numbers
+#define BENCHMARK_WARMUP_FRAMES 5
+#define BENCHMARK_FRAME_STEP (1.0f / 60.0f)
+// many more points than a profile is swept with, so the timings are well above the clock's resolution
+#define BENCHMARK_BEZIER_SAMPLES 200000
+// a sphere far finer than any in the scene: sectors round, stacks from pole to pole
+#define BENCHMARK_REVOLVE_SECTORS 1024
+#define BENCHMARK_REVOLVE_STACKS 512
+// levels of the fractal tree the generators are timed on, 2^20 - 1 segments
+#define BENCHMARK_FRACTAL_DEPTH 20
+
+// what the driver was asked to do in one frame
+struct GLDrawStats {
+    unsigned int drawCalls = 0;
+    unsigned long long triangles = 0;
+    unsigned int programBinds = 0;
+    unsigned int textureBinds = 0;
+    unsigned int vertexArrayBinds = 0;
+
+    unsigned int stateChanges() const
+    {
+        return programBinds + textureBinds + vertexArrayBinds;
+    }
+
+    void reset()
+    {
+        *this = GLDrawStats();
+    }
+};
+
+inline GLDrawStats& glDrawStats()
+{
+    static GLDrawStats stats;
+    return stats;
+}
+
+inline unsigned long long trianglesFor(GLenum mode, GLsizei count)
+{
+    if (mode == GL_TRIANGLES)
+        return count / 3;
+    if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count > 2)
+        return count - 2;
+    return 0;
+}
+
+// the real entry points, saved before the counting ones take their place
+struct GLDrawEntryPoints {
+    PFNGLDRAWELEMENTSPROC drawElements = NULL;
+    PFNGLDRAWARRAYSPROC drawArrays = NULL;
+    PFNGLDRAWELEMENTSINSTANCEDPROC drawElementsInstanced = NULL;
+    PFNGLDRAWARRAYSINSTANCEDPROC drawArraysInstanced = NULL;
+    PFNGLUSEPROGRAMPROC useProgram = NULL;
+    PFNGLBINDTEXTUREPROC bindTexture = NULL;
+    PFNGLBINDVERTEXARRAYPROC bindVertexArray = NULL;
+};
+
+inline GLDrawEntryPoints& glDrawEntryPoints()
+{
+    static GLDrawEntryPoints entryPoints;
+    return entryPoints;
+}
+
+inline void APIENTRY countedDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    glDrawStats().drawCalls++;
+    glDrawStats().triangles += trianglesFor(mode, count);
+    glDrawEntryPoints().drawElements(mode, count, type, indices);
+}
+
+inline void APIENTRY countedDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    glDrawStats().drawCalls++;
+    glDrawStats().triangles += trianglesFor(mode, count);
+    glDrawEntryPoints().drawArrays(mode, first, count);
+}
+
+inline void APIENTRY countedDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount)
+{
+    glDrawStats().drawCalls++;
+    glDrawStats().triangles += trianglesFor(mode, count) * instanceCount;
+    glDrawEntryPoints().drawElementsInstanced(mode, count, type, indices, instanceCount);
+}
+
+inline void APIENTRY countedDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount)
+{
+    glDrawStats().drawCalls++;
+    glDrawStats().triangles += trianglesFor(mode, count) * instanceCount;
+    glDrawEntryPoints().drawArraysInstanced(mode, first, count, instanceCount);
+}
+
+inline void APIENTRY countedUseProgram(GLuint program)
+{
+    glDrawStats().programBinds++;
+    glDrawEntryPoints().useProgram(program);
+}
+
+inline void APIENTRY countedBindTexture(GLenum target, GLuint texture)
+{
+    glDrawStats().textureBinds++;
+    glDrawEntryPoints().bindTexture(target, texture);
+}
+
+inline void APIENTRY countedBindVertexArray(GLuint array)
+{
+    glDrawStats().vertexArrayBinds++;
+    glDrawEntryPoints().bindVertexArray(array);
+}
+
+// one point of the camera path; yaw and pitch as the Camera takes them
+struct BenchmarkKey {
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+
+class FrameBenchmark {
+public:
+    FrameBenchmark() {}
+
+    FrameBenchmark(const FrameBenchmark&) = delete;
+    FrameBenchmark& operator=(const FrameBenchmark&) = delete;
+
+    // false on a malformed command line; without --benchmark the program runs as usual
+    bool parseArguments(int argc, char** argv)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc)
+            {
+                if (!parseCount(argv[++i], 1, frames))
+                {
+                    std::cout << "FrameBenchmark: --benchmark needs a positive number of frames, not \"" << argv[i] << "\"" << std::endl;
+                    return false;
+                }
+            }
+            else if (strcmp(argv[i], "--benchmark-out") == 0 && i + 1 < argc)
+                outputPath = argv[++i];
+            else if (strcmp(argv[i], "--texture-threads") == 0 && i + 1 < argc)
+            {
+                if (!parseCount(argv[++i], 0, textureThreads))
+                {
+                    std::cout << "FrameBenchmark: --texture-threads needs a number of threads, not \"" << argv[i] << "\"" << std::endl;
+                    return false;
+                }
+            }
+            else if (strcmp(argv[i], "--no-occlusion") == 0)
+                occlusion = false;
+            else if (strcmp(argv[i], "--no-tessellation") == 0)
+                tessellation = false;
+            else
+            {
+                std::cout << "usage: " << argv[0] << " [--benchmark <frames> [--benchmark-out <file.json>] [--texture-threads <n>] [--no-occlusion] [--no-tessellation]]" << std::endl;
+                std::cout << "       " << argv[0] << " --microbenchmark [<file.json>]" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool active() const
+    {
+        return frames > 0;
+    }
+
+    // worker threads for the TextureLoader, -1 for its default
+    int textureLoaderThreads() const
+    {
+        return textureThreads;
+    }
+
+    // whether nodes are tested against the CPU depth buffer of the occluders
+    bool occlusionEnabled() const
+    {
+        return occlusion;
+    }
+
+    // whether the curved surfaces may be cut on the GPU when the context allows it
+    bool tessellationEnabled() const
+    {
+        return tessellation;
+    }
+
+    // how long texture loading held up the main thread and how long until every texture was on the GPU
+    void recordTextureStartup(unsigned int textures, unsigned int compressed, size_t bytes, double blockedMilliseconds, double residentMilliseconds)
+    {
+        textureCount = textures;
+        textureCompressed = compressed;
+        textureBytes = bytes;
+        textureBlockedMilliseconds = blockedMilliseconds;
+        textureResidentMilliseconds = residentMilliseconds;
+    }
+
+    // whether the curved surfaces ended up cut on the GPU, and the bytes of control points uploaded for them
+    void recordCurvedSurfaces(bool tessellated, unsigned int bytes)
+    {
+        curvedSurfacesTessellated = tessellated;
+        patchBytes = bytes;
+    }
+
+    void recordForest(unsigned int trees, unsigned int cells, unsigned int branchTriangles)
+    {
+        forestTrees = trees;
+        forestCells = cells;
+        forestBranchTriangles = branchTriangles;
+    }
+
+    // static scene nodes that survived culling this frame, out of total, and the boxes found occluded; call before endFrame
+    void recordVisibility(unsigned int visible, unsigned int total, unsigned int occluded)
+    {
+        visibleNodes = visible;
+        totalNodes = total;
+        occludedNodes = occluded;
+    }
+
+    bool finished() const
+    {
+        return frame >= frames + BENCHMARK_WARMUP_FRAMES;
+    }
+
+    // before glfwInit: the null platform needs no display (GLFW 3.4)
+    void hintPlatform() const
+    {
+#ifdef GLFW_PLATFORM_NULL
+        if (active())
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+    }
+
+    // after glfwInit: an invisible window with a software context where available
+    void hintWindow() const
+    {
+        if (!active())
+            return;
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef GLFW_OSMESA_CONTEXT_API
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+#endif
+    }
+
+    // needs a current context with glad loaded
+    bool createTarget(int targetWidth, int targetHeight)
+    {
+        width = targetWidth;
+        height = targetHeight;
+
+        glGenRenderbuffers(1, &colorRBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glGenRenderbuffers(1, &depthRBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRBO);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRBO);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cout << "FrameBenchmark: offscreen framebuffer is incomplete" << std::endl;
+            return false;
+        }
+        glViewport(0, 0, width, height);
+
+        const char* rendererName = (const char*)glGetString(GL_RENDERER);
+        renderer = rendererName != NULL ? rendererName : "unknown";
+        installCounters();
+        return true;
+    }
+
+    // needs the context to still be current
+    void releaseTarget()
+    {
+        if (FBO != 0)
+            glDeleteFramebuffers(1, &FBO);
+        if (colorRBO != 0)
+            glDeleteRenderbuffers(1, &colorRBO);
+        if (depthRBO != 0)
+            glDeleteRenderbuffers(1, &depthRBO);
+        FBO = colorRBO = depthRBO = 0;
+    }
+
+    // positions the camera for this frame and starts its clock
+    void beginFrame(Camera& camera)
+    {
+        BenchmarkKey key = pathAt((float)frame / (float)(frames + BENCHMARK_WARMUP_FRAMES));
+        camera.SetPose(key.position, key.yaw, key.pitch);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glDrawStats().reset();
+        uploadsAtStart = uniformStats().uploads;
+        stateAtStart = glStateStats();
+        start = std::chrono::high_resolution_clock::now();
+    }
+
+    // call after the last draw of the frame, before anything resets uniformStats() or glStateStats()
+    void endFrame()
+    {
+        std::chrono::high_resolution_clock::time_point submitted = std::chrono::high_resolution_clock::now();
+        glFinish();
+        std::chrono::high_resolution_clock::time_point finished = std::chrono::high_resolution_clock::now();
+
+        if (frame >= BENCHMARK_WARMUP_FRAMES)
+        {
+            Sample sample;
+            sample.cpuMilliseconds = std::chrono::duration<double, std::milli>(submitted - start).count();
+            sample.frameMilliseconds = std::chrono::duration<double, std::milli>(finished - start).count();
+            sample.draws = glDrawStats();
+            sample.uniformUploads = uniformStats().uploads - uploadsAtStart;
+            sample.visibleNodes = visibleNodes;
+            sample.totalNodes = totalNodes;
+            sample.occludedNodes = occludedNodes;
+            for (int i = 0; i < STATE_CALL_COUNT; i++)
+            {
+                sample.state.issued[i] = glStateStats().issued[i] - stateAtStart.issued[i];
+                sample.state.filtered[i] = glStateStats().filtered[i] - stateAtStart.filtered[i];
+            }
+            samples.push_back(sample);
+        }
+        frame++;
+    }
+
+    // fixed step, so animation does not depend on how fast the machine is
+    float frameTime() const
+    {
+        return BENCHMARK_FRAME_STEP;
+    }
+
+    bool writeReport() const
+    {
+        if (samples.empty())
+            return false;
+
+        std::vector<double> cpu, total;
+        double drawCalls = 0.0, triangles = 0.0, programBinds = 0.0, textureBinds = 0.0, vertexArrayBinds = 0.0, uniformUploads = 0.0;
+        double visibleNodes = 0.0, totalNodes = 0.0, occludedNodes = 0.0;
+        double stateIssued[STATE_CALL_COUNT] = { 0.0 }, stateFiltered[STATE_CALL_COUNT] = { 0.0 };
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            cpu.push_back(samples[i].cpuMilliseconds);
+            total.push_back(samples[i].frameMilliseconds);
+            drawCalls += samples[i].draws.drawCalls;
+            triangles += (double)samples[i].draws.triangles;
+            programBinds += samples[i].draws.programBinds;
+            textureBinds += samples[i].draws.textureBinds;
+            vertexArrayBinds += samples[i].draws.vertexArrayBinds;
+            uniformUploads += samples[i].uniformUploads;
+            visibleNodes += samples[i].visibleNodes;
+            totalNodes += samples[i].totalNodes;
+            occludedNodes += samples[i].occludedNodes;
+            for (int j = 0; j < STATE_CALL_COUNT; j++)
+            {
+                stateIssued[j] += samples[i].state.issued[j];
+                stateFiltered[j] += samples[i].state.filtered[j];
+            }
+        }
+        std::sort(cpu.begin(), cpu.end());
+        std::sort(total.begin(), total.end());
+        double n = (double)samples.size();
+
+        FILE* out = outputPath.empty() ? stdout : fopen(outputPath.c_str(), "w");
+        if (out == NULL)
+        {
+            std::cout << "FrameBenchmark: cannot write " << outputPath << std::endl;
+            return false;
+        }
+        fprintf(out, "{\n");
+        fprintf(out, "  \"renderer\": \"%s\",\n", escaped(renderer).c_str());
+        fprintf(out, "  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %u,\n  \"warmup_frames\": %d,\n", width, height, (unsigned int)samples.size(), BENCHMARK_WARMUP_FRAMES);
+        fprintf(out, "  \"texture_startup\": { \"threads\": %d, \"textures\": %u, \"compressed\": %u, \"gpu_bytes\": %llu, \"main_thread_blocked_ms\": %.2f, \"resident_ms\": %.2f },\n",
+            textureThreads, textureCount, textureCompressed, (unsigned long long)textureBytes, textureBlockedMilliseconds, textureResidentMilliseconds);
+        fprintf(out, "  \"curved_surfaces\": { \"gpu_tessellation\": %s, \"patch_bytes\": %u },\n", curvedSurfacesTessellated ? "true" : "false", patchBytes);
+        fprintf(out, "  \"forest\": { \"trees\": %u, \"cells\": %u, \"branch_triangles_per_tree\": %u },\n", forestTrees, forestCells, forestBranchTriangles);
+        fprintf(out, "  \"cpu_frame_ms\": { \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n",
+            percentile(cpu, 50.0), percentile(cpu, 95.0), percentile(cpu, 99.0), cpu.back());
+        fprintf(out, "  \"frame_ms_with_finish\": { \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n",
+            percentile(total, 50.0), percentile(total, 95.0), percentile(total, 99.0), total.back());
+        fprintf(out, "  \"per_frame\": {\n");
+        fprintf(out, "    \"draw_calls\": %.1f,\n", drawCalls / n);
+        fprintf(out, "    \"triangles\": %.1f,\n", triangles / n);
+        fprintf(out, "    \"state_changes\": %.1f,\n", (programBinds + textureBinds + vertexArrayBinds) / n);
+        fprintf(out, "    \"program_binds\": %.1f,\n", programBinds / n);
+        fprintf(out, "    \"texture_binds\": %.1f,\n", textureBinds / n);
+        fprintf(out, "    \"vertex_array_binds\": %.1f,\n", vertexArrayBinds / n);
+        fprintf(out, "    \"uniform_uploads\": %.1f,\n", uniformUploads / n);
+        fprintf(out, "    \"visible_static_nodes\": %.1f,\n", visibleNodes / n);
+        fprintf(out, "    \"visible_fraction\": %.3f,\n", totalNodes > 0.0 ? visibleNodes / totalNodes : 1.0);
+        fprintf(out, "    \"occluded_boxes\": %.1f\n", occludedNodes / n);
+        fprintf(out, "  },\n");
+        // calls that went through glState.h: how many reached the driver and how many were dropped
+        static const char* stateCallNames[STATE_CALL_COUNT] = { "use_program", "bind_vertex_array", "active_texture", "bind_texture", "line_width" };
+        fprintf(out, "  \"state_filter_per_frame\": {\n");
+        for (int i = 0; i < STATE_CALL_COUNT; i++)
+            fprintf(out, "    \"%s\": { \"issued\": %.1f, \"filtered\": %.1f }%s\n", stateCallNames[i], stateIssued[i] / n, stateFiltered[i] / n,
+                i + 1 < STATE_CALL_COUNT ? "," : "");
+        fprintf(out, "  }\n}\n");
+        if (out != stdout)
+            fclose(out);
+        return true;
+    }
+
+private:
+    struct Sample {
+        double cpuMilliseconds;    // until the last command was submitted
+        double frameMilliseconds;  // until the GPU finished it as well
+        GLDrawStats draws;
+        unsigned int uniformUploads;
+        unsigned int visibleNodes, totalNodes, occludedNodes;
+        GLStateStats state;
+    };
+
+    int frames = 0;
+    int frame = 0;
+    std::string outputPath;
+    std::string renderer;
+    int textureThreads = -1;
+    bool occlusion = true;
+    bool tessellation = true;
+    bool curvedSurfacesTessellated = false;
+    unsigned int patchBytes = 0;
+    unsigned int forestTrees = 0, forestCells = 0, forestBranchTriangles = 0;
+    unsigned int textureCount = 0, textureCompressed = 0;
+    size_t textureBytes = 0;
+    double textureBlockedMilliseconds = 0.0, textureResidentMilliseconds = 0.0;
+    int width = 0, height = 0;
+    unsigned int FBO = 0, colorRBO = 0, depthRBO = 0;
+    unsigned int uploadsAtStart = 0;
+    unsigned int visibleNodes = 0, totalNodes = 0, occludedNodes = 0;
+    GLStateStats stateAtStart;
+    std::chrono::high_resolution_clock::time_point start;
+    std::vector<Sample> samples;
+
+    // the seats from the entrance, the hall from the stage, the stage from the balcony, the outside
+    static BenchmarkKey pathAt(float t)
+    {
+        static const BenchmarkKey path[] = {
+            { glm::vec3(0.0f, 1.1f, -5.2f), -90.0f, 0.0f },
+            { glm::vec3(8.0f, 2.0f, 0.0f), 0.0f, -5.0f },
+            { glm::vec3(-10.0f, 7.0f, 0.0f), 180.0f, -10.0f },
+            { glm::vec3(-40.0f, 3.0f, 30.0f), 143.0f, 0.0f },
+            { glm::vec3(0.0f, 1.1f, -5.2f), 270.0f, 0.0f }
+        };
+        const int segments = sizeof(path) / sizeof(path[0]) - 1;
+        float position = t * segments;
+        int segment = std::min((int)position, segments - 1);
+        float f = position - segment;
+        const BenchmarkKey& a = path[segment];
+        const BenchmarkKey& b = path[segment + 1];
+        BenchmarkKey key = { glm::mix(a.position, b.position, f), a.yaw + (b.yaw - a.yaw) * f, a.pitch + (b.pitch - a.pitch) * f };
+        return key;
+    }
+
+    // a whole number no smaller than minimum, with nothing after it
+    static bool parseCount(const char* text, int minimum, int& value)
+    {
+        char* end = NULL;
+        long parsed = strtol(text, &end, 10);
+        if (end == text || *end != '\0' || parsed < minimum || parsed > INT_MAX)
+            return false;
+        value = (int)parsed;
+        return true;
+    }
+
+    static double percentile(const std::vector<double>& sorted, double p)
+    {
+        size_t index = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    static std::string escaped(const std::string& text)
+    {
+        std::string result;
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            if (text[i] == '"' || text[i] == '\\')
+                result += '\\';
+            result += text[i];
+        }
+        return result;
+    }
+
+    // glad calls through function pointers, so the counters can be slotted in front of the driver
+    static void installCounters()
+    {
+        GLDrawEntryPoints& real = glDrawEntryPoints();
+        if (real.drawElements != NULL)
+            return;
+        real.drawElements = glad_glDrawElements;
+        real.drawArrays = glad_glDrawArrays;
+        real.drawElementsInstanced = glad_glDrawElementsInstanced;
+        real.drawArraysInstanced = glad_glDrawArraysInstanced;
+        real.useProgram = glad_glUseProgram;
+        real.bindTexture = glad_glBindTexture;
+        real.bindVertexArray = glad_glBindVertexArray;
+        glad_glDrawElements = countedDrawElements;
+        glad_glDrawArrays = countedDrawArrays;
+        glad_glDrawElementsInstanced = countedDrawElementsInstanced;
+        glad_glDrawArraysInstanced = countedDrawArraysInstanced;
+        glad_glUseProgram = countedUseProgram;
+        glad_glBindTexture = countedBindTexture;
+        glad_glBindVertexArray = countedBindVertexArray;
+    }
+};
+
+// the textbook form the evaluator replaced, nCr and two pow() per control point
+inline glm::vec2 bezierReferencePoint(double t, const float* ctrlpoints, int degree)
+{
+    double x = 0.0, y = 0.0;
+    t = t > 1.0 ? 1.0 : t;
+    for (int i = 0; i <= degree; i++)
+    {
+        int r = i > degree / 2 ? degree - i : i;
+        long long ncr = 1;
+        for (int j = 1; j <= r; j++)
+        {
+            ncr *= degree - r + j;
+            ncr /= j;
+        }
+        double coef = pow(1.0 - t, double(degree - i)) * pow(t, double(i)) * ncr;
+        x += coef * ctrlpoints[i * 3];
+        y += coef * ctrlpoints[i * 3 + 1];
+    }
+    return glm::vec2((float)x, (float)y);
+}
+
+// how the cylinder, torus, sphere and Bezier generators swept before revolve(): cos() and sin() per
+// vertex, one vector per attribute, interleaved at the end
+template <class Profile>
+void revolveReference(const Profile& profile, int rings, const RevolveSweep& sweep, RevolvedMesh& mesh)
+{
+    std::vector<float> coordinates, normals, texCoords;
+    mesh.vertices.clear();
+    mesh.indices.clear();
+    mesh.stride = 8;
+    for (int i = 0; i < rings; i++)
+    {
+        ProfilePoint p = profile(i);
+        for (int j = 0; j <= sweep.segments; j++)
+        {
+            float angle = sweep.start + sweep.turn * j / sweep.segments;
+            coordinates.push_back(p.r * cosf(angle));
+            coordinates.push_back(p.y);
+            coordinates.push_back(p.r * sinf(angle));
+            normals.push_back(p.nr * cosf(angle));
+            normals.push_back(p.ny);
+            normals.push_back(p.nr * sinf(angle));
+            texCoords.push_back((float)j / sweep.segments);
+            texCoords.push_back(p.v);
+        }
+    }
+    for (int i = 0; i + 1 < rings; i++)
+    {
+        int k1 = i * (sweep.segments + 1);
+        int k2 = k1 + sweep.segments + 1;
+        for (int j = 0; j < sweep.segments; j++, k1++, k2++)
+        {
+            mesh.indices.push_back(k1);
+            mesh.indices.push_back(k2);
+            mesh.indices.push_back(k1 + 1);
+            mesh.indices.push_back(k1 + 1);
+            mesh.indices.push_back(k2);
+            mesh.indices.push_back(k2 + 1);
+        }
+    }
+    for (size_t i = 0, j = 0; i < coordinates.size(); i += 3, j += 2)
+    {
+        mesh.vertices.push_back(coordinates[i]);
+        mesh.vertices.push_back(coordinates[i + 1]);
+        mesh.vertices.push_back(coordinates[i + 2]);
+        mesh.vertices.push_back(normals[i]);
+        mesh.vertices.push_back(normals[i + 1]);
+        mesh.vertices.push_back(normals[i + 2]);
+        mesh.vertices.push_back(texCoords[j]);
+        mesh.vertices.push_back(texCoords[j + 1]);
+    }
+}
+
+// how the trees were grown before generateFractalTree(): recursion with two glm::rotate() matrices
+// and six push_back()s per branch
+inline void fractalTreeReference(std::vector<float>& vertices, const glm::vec3& start, const glm::vec3& direction, float angleDegrees, int depth)
+{
+    if (depth == 0)
+        return;
+    glm::vec3 end = start + direction;
+    vertices.push_back(start.x);
+    vertices.push_back(start.y);
+    vertices.push_back(start.z);
+    vertices.push_back(end.x);
+    vertices.push_back(end.y);
+    vertices.push_back(end.z);
+    float angleRadians = glm::radians(angleDegrees);
+    glm::mat4 rotationLeft = glm::rotate(glm::mat4(1.0f), angleRadians, glm::vec3(0.0f, 0.0f, 1.0f));
+    glm::mat4 rotationRight = glm::rotate(glm::mat4(1.0f), -angleRadians, glm::vec3(0.0f, 0.0f, 1.0f));
+    fractalTreeReference(vertices, end, glm::vec3(rotationLeft * glm::vec4(direction * FRACTAL_BRANCH_SCALE, 0.0f)), angleDegrees, depth - 1);
+    fractalTreeReference(vertices, end, glm::vec3(rotationRight * glm::vec4(direction * FRACTAL_BRANCH_SCALE, 0.0f)), angleDegrees, depth - 1);
+}
+
+// CPU timings of the geometry generators against the code each of them replaced, started with
+// Auditorium --microbenchmark [<file.json>]; needs no window or GL context, and draws nothing
+class GeneratorBenchmark {
+public:
+    // ctrlpoints: the profile the Bezier evaluator is timed on; outputPath: NULL for stdout
+    bool run(const float* ctrlpoints, int degree, const char* outputPath)
+    {
+        measureBezier(ctrlpoints, degree);
+        measureRevolve();
+        measureFractalTree();
+        return writeReport(outputPath);
+    }
+
+private:
+    int bezierDegree = 0;
+    double bezierReferenceMilliseconds = 0.0, bezierSingleMilliseconds = 0.0, bezierBatchMilliseconds = 0.0;
+    float bezierMaxError = 0.0f;
+    unsigned int revolveVertices = 0;
+    double revolveReferenceMilliseconds = 0.0, revolveFirstMilliseconds = 0.0, revolveCachedMilliseconds = 0.0;
+    unsigned int fractalSegments = 0;
+    int fractalThreads = 0;
+    double fractalReferenceMilliseconds = 0.0, fractalSerialMilliseconds = 0.0, fractalThreadedMilliseconds = 0.0;
+    float fractalMaxError = 0.0f;
+
+    // the same points of one curve three ways: pow()/nCr(), the evaluator one at a time and in batches
+    void measureBezier(const float* ctrlpoints, int degree)
+    {
+        std::vector<float> ts(BENCHMARK_BEZIER_SAMPLES);
+        for (int i = 0; i < BENCHMARK_BEZIER_SAMPLES; i++)
+            ts[i] = (float)i / (BENCHMARK_BEZIER_SAMPLES - 1);
+        std::vector<glm::vec2> reference(ts.size()), single(ts.size()), batch(ts.size());
+
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < ts.size(); i++)
+            reference[i] = bezierReferencePoint(ts[i], ctrlpoints, degree);
+        std::chrono::high_resolution_clock::time_point referenceDone = std::chrono::high_resolution_clock::now();
+        BezierEvaluator curve(ctrlpoints, degree);
+        for (size_t i = 0; i < ts.size(); i++)
+            single[i] = curve.point(ts[i]);
+        std::chrono::high_resolution_clock::time_point singleDone = std::chrono::high_resolution_clock::now();
+        curve.points(ts.data(), ts.size(), batch.data());
+        std::chrono::high_resolution_clock::time_point batchDone = std::chrono::high_resolution_clock::now();
+
+        bezierDegree = degree;
+        bezierReferenceMilliseconds = std::chrono::duration<double, std::milli>(referenceDone - start).count();
+        bezierSingleMilliseconds = std::chrono::duration<double, std::milli>(singleDone - referenceDone).count();
+        bezierBatchMilliseconds = std::chrono::duration<double, std::milli>(batchDone - singleDone).count();
+        bezierMaxError = 0.0f;
+        for (size_t i = 0; i < ts.size(); i++)
+        {
+            glm::vec2 d = glm::abs(batch[i] - reference[i]);
+            bezierMaxError = std::max(bezierMaxError, std::max(d.x, d.y));
+        }
+    }
+
+    // one fine sphere generated the old way and through revolve(), the second time with its tables cached
+    void measureRevolve()
+    {
+        const int stacks = BENCHMARK_REVOLVE_STACKS;
+        std::vector<float> latitude(stacks + 1);
+        for (int i = 0; i <= stacks; i++)
+            latitude[i] = (float)(REVOLVE_FULL_TURN / 4.0 - REVOLVE_FULL_TURN / 2.0 * i / stacks);
+        auto sphere = [&latitude](int i) {
+            ProfilePoint point = { cosf(latitude[i]), sinf(latitude[i]), cosf(latitude[i]), sinf(latitude[i]), (float)i / BENCHMARK_REVOLVE_STACKS };
+            return point;
+        };
+        RevolveSweep sweep = RevolveSweep::full(BENCHMARK_REVOLVE_SECTORS);
+        RevolvedMesh mesh;
+
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        revolveReference(sphere, stacks + 1, sweep, mesh);
+        std::chrono::high_resolution_clock::time_point referenceDone = std::chrono::high_resolution_clock::now();
+        revolve(sphere, stacks + 1, sweep, mesh);
+        std::chrono::high_resolution_clock::time_point firstDone = std::chrono::high_resolution_clock::now();
+        revolve(sphere, stacks + 1, sweep, mesh);
+        std::chrono::high_resolution_clock::time_point cachedDone = std::chrono::high_resolution_clock::now();
+
+        revolveVertices = (unsigned int)mesh.vertexCount();
+        revolveReferenceMilliseconds = std::chrono::duration<double, std::milli>(referenceDone - start).count();
+        revolveFirstMilliseconds = std::chrono::duration<double, std::milli>(firstDone - referenceDone).count();
+        revolveCachedMilliseconds = std::chrono::duration<double, std::milli>(cachedDone - firstDone).count();
+    }
+
+    // the same tree three ways: recursively, and with the generator on one thread and on every core
+    void measureFractalTree()
+    {
+        std::vector<float> reference, serial(fractalTreeSegments(BENCHMARK_FRACTAL_DEPTH) * 6), threaded(serial.size());
+
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        fractalTreeReference(reference, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 30.0f, BENCHMARK_FRACTAL_DEPTH);
+        std::chrono::high_resolution_clock::time_point referenceDone = std::chrono::high_resolution_clock::now();
+        generateFractalTree(serial.data(), 1.0f, 30.0f, BENCHMARK_FRACTAL_DEPTH, 1);
+        std::chrono::high_resolution_clock::time_point serialDone = std::chrono::high_resolution_clock::now();
+        generateFractalTree(threaded.data(), 1.0f, 30.0f, BENCHMARK_FRACTAL_DEPTH);
+        std::chrono::high_resolution_clock::time_point threadedDone = std::chrono::high_resolution_clock::now();
+
+        fractalSegments = (unsigned int)fractalTreeSegments(BENCHMARK_FRACTAL_DEPTH);
+        fractalThreads = std::max(1, (int)std::thread::hardware_concurrency());
+        fractalReferenceMilliseconds = std::chrono::duration<double, std::milli>(referenceDone - start).count();
+        fractalSerialMilliseconds = std::chrono::duration<double, std::milli>(serialDone - referenceDone).count();
+        fractalThreadedMilliseconds = std::chrono::duration<double, std::milli>(threadedDone - serialDone).count();
+        fractalMaxError = 0.0f;
+        for (size_t i = 0; i < serial.size() && i < reference.size(); i++)
+            fractalMaxError = std::max(fractalMaxError, std::max(fabsf(serial[i] - reference[i]), fabsf(threaded[i] - reference[i])));
+    }
+
+    bool writeReport(const char* outputPath) const
+    {
+        FILE* out = outputPath == NULL ? stdout : fopen(outputPath, "w");
+        if (out == NULL)
+        {
+            std::cout << "GeneratorBenchmark: cannot write " << outputPath << std::endl;
+            return false;
+        }
+        fprintf(out, "{\n");
+        fprintf(out, "  \"bezier_eval\": { \"degree\": %d, \"samples\": %d, \"pow_ncr_ms\": %.3f, \"evaluator_ms\": %.3f, \"batch_ms\": %.3f, \"max_error\": %g },\n",
+            bezierDegree, BENCHMARK_BEZIER_SAMPLES, bezierReferenceMilliseconds, bezierSingleMilliseconds, bezierBatchMilliseconds, bezierMaxError);
+        fprintf(out, "  \"revolve\": { \"sectors\": %d, \"stacks\": %d, \"vertices\": %u, \"per_vertex_trig_ms\": %.3f, \"revolve_ms\": %.3f, \"revolve_cached_tables_ms\": %.3f },\n",
+            BENCHMARK_REVOLVE_SECTORS, BENCHMARK_REVOLVE_STACKS, revolveVertices, revolveReferenceMilliseconds, revolveFirstMilliseconds, revolveCachedMilliseconds);
+        fprintf(out, "  \"fractal_tree\": { \"depth\": %d, \"segments\": %u, \"threads\": %d, \"recursive_ms\": %.3f, \"iterative_ms\": %.3f, \"threaded_ms\": %.3f, \"max_error\": %g }\n",
+            BENCHMARK_FRACTAL_DEPTH, fractalSegments, fractalThreads, fractalReferenceMilliseconds, fractalSerialMilliseconds, fractalThreadedMilliseconds, fractalMaxError);
+        fprintf(out, "}\n");
+        if (out != stdout)
+            fclose(out);
+        return true;
+    }
+};
+
+#endif /* benchmark_h */
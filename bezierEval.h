@@ -0,0 +1,145 @@
+//
+//  bezierEval.h
+//  test
+//
+//  Evaluation of the Bezier profiles the surfaces of revolution are swept
+//  from. The binomial coefficients are folded into the control points once,
+//  when the evaluator is made, and a point is then the Bernstein sum in
+//  Horner form: one pass over the control points, no pow() and no nCr().
+//  The derivative is the same sum over the differences of the control
+//  points. A batch of parameters is evaluated four at a time with SSE where
+//  the target has it; the scalar path does the same operations in the same
+//  order, so both give the same numbers.
+//
+
+#ifndef bezierEval_h
+#define bezierEval_h
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BEZIER_SSE 1
+#endif
+
+static_assert(sizeof(glm::vec2) == 2 * sizeof(float), "the batch stores x y pairs straight into glm::vec2");
+
+class BezierEvaluator {
+public:
+    // degree + 1 control points, x y z each as the curve classes keep them; z is not used
+    BezierEvaluator(const float* ctrlpoints, int degree) : n(degree)
+    {
+        // one row of Pascal's triangle per degree, in double so the large middle terms stay exact
+        std::vector<double> binomial(1, 1.0), previous;
+        for (int row = 1; row <= n; row++)
+        {
+            previous = binomial;
+            binomial.assign(row + 1, 1.0);
+            for (int i = 1; i < row; i++)
+                binomial[i] = previous[i - 1] + previous[i];
+        }
+        for (int i = 0; i <= n; i++)
+        {
+            px.push_back((float)(binomial[i] * ctrlpoints[i * 3]));
+            py.push_back((float)(binomial[i] * ctrlpoints[i * 3 + 1]));
+        }
+        // the derivative is degree times the curve of degree - 1 over the differences
+        for (int i = 0; i < n; i++)
+        {
+            dx.push_back((float)(n * previous[i] * (ctrlpoints[(i + 1) * 3] - ctrlpoints[i * 3])));
+            dy.push_back((float)(n * previous[i] * (ctrlpoints[(i + 1) * 3 + 1] - ctrlpoints[i * 3 + 1])));
+        }
+    }
+
+    int degree() const
+    {
+        return n;
+    }
+
+    // control point i with its binomial folded in, as point() sums them
+    glm::vec2 weighted(int i) const
+    {
+        return glm::vec2(px[i], py[i]);
+    }
+
+    // t past 1 (from summing steps) is taken as 1
+    glm::vec2 point(float t) const
+    {
+        return sum(px, py, n, t);
+    }
+
+    glm::vec2 derivative(float t) const
+    {
+        if (n == 0)
+            return glm::vec2(0.0f);
+        return sum(dx, dy, n - 1, t);
+    }
+
+    void points(const float* ts, size_t count, glm::vec2* out) const
+    {
+        sumBatch(px, py, n, ts, count, out);
+    }
+
+    void derivatives(const float* ts, size_t count, glm::vec2* out) const
+    {
+        if (n == 0)
+        {
+            for (size_t i = 0; i < count; i++)
+                out[i] = glm::vec2(0.0f);
+            return;
+        }
+        sumBatch(dx, dy, n - 1, ts, count, out);
+    }
+
+private:
+    int n;
+    std::vector<float> px, py;  // binomial(n, i) * P[i]
+    std::vector<float> dx, dy;  // n * binomial(n - 1, i) * (P[i + 1] - P[i])
+
+    // sum of w[i] t^i (1 - t)^(m - i): each step multiplies what is there by (1 - t) and adds the next term
+    static glm::vec2 sum(const std::vector<float>& wx, const std::vector<float>& wy, int m, float t)
+    {
+        t = t > 1.0f ? 1.0f : t;
+        float u = 1.0f - t;
+        float tPow = 1.0f;
+        float x = wx[0], y = wy[0];
+        for (int i = 1; i <= m; i++)
+        {
+            tPow = tPow * t;
+            x = x * u + wx[i] * tPow;
+            y = y * u + wy[i] * tPow;
+        }
+        return glm::vec2(x, y);
+    }
+
+    static void sumBatch(const std::vector<float>& wx, const std::vector<float>& wy, int m, const float* ts, size_t count, glm::vec2* out)
+    {
+        size_t k = 0;
+#ifdef BEZIER_SSE
+        const __m128 one = _mm_set1_ps(1.0f);
+        for (; k + 4 <= count; k += 4)
+        {
+            __m128 t = _mm_min_ps(_mm_loadu_ps(ts + k), one);
+            __m128 u = _mm_sub_ps(one, t);
+            __m128 tPow = one;
+            __m128 x = _mm_set1_ps(wx[0]), y = _mm_set1_ps(wy[0]);
+            for (int i = 1; i <= m; i++)
+            {
+                tPow = _mm_mul_ps(tPow, t);
+                x = _mm_add_ps(_mm_mul_ps(x, u), _mm_mul_ps(_mm_set1_ps(wx[i]), tPow));
+                y = _mm_add_ps(_mm_mul_ps(y, u), _mm_mul_ps(_mm_set1_ps(wy[i]), tPow));
+            }
+            // interleave into x y pairs, which is how glm::vec2 lies in memory
+            _mm_storeu_ps(&out[k].x, _mm_unpacklo_ps(x, y));
+            _mm_storeu_ps(&out[k + 2].x, _mm_unpackhi_ps(x, y));
+        }
+#endif
+        for (; k < count; k++)
+            out[k] = sum(wx, wy, m, ts[k]);
+    }
+};
+
+#endif /* bezierEval_h */
@@ -0,0 +1,154 @@
+//
+//  bounds.h
+//  test
+//
+//  Axis-aligned bounding boxes and the view frustum they are tested against.
+//  Meshes compute their local box from their own vertex positions; a node's
+//  world box is that box carried through its model matrix. The frustum
+//  planes come straight out of projection * view (Gribb and Hartmann), so
+//  they always match what the shaders draw with.
+//
+
+#ifndef bounds_h
+#define bounds_h
+
+#include <glm/glm.hpp>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+struct Bounds {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    // empty until something is added; an empty box is outside every frustum
+    Bounds() : min(FLT_MAX), max(-FLT_MAX) {}
+    Bounds(const glm::vec3& lo, const glm::vec3& hi) : min(lo), max(hi) {}
+
+    bool empty() const
+    {
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+
+    void add(const glm::vec3& point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void add(const Bounds& other)
+    {
+        if (other.empty())
+            return;
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    glm::vec3 center() const
+    {
+        return (min + max) * 0.5f;
+    }
+
+    glm::vec3 extent() const
+    {
+        return (max - min) * 0.5f;
+    }
+
+    bool contains(const glm::vec3& point) const
+    {
+        return point.x >= min.x && point.y >= min.y && point.z >= min.z && point.x <= max.x && point.y <= max.y && point.z <= max.z;
+    }
+
+    bool contains(const Bounds& other) const
+    {
+        return contains(other.min) && contains(other.max);
+    }
+
+    bool intersects(const Bounds& other) const
+    {
+        return other.max.x >= min.x && other.max.y >= min.y && other.max.z >= min.z
+            && other.min.x <= max.x && other.min.y <= max.y && other.min.z <= max.z;
+    }
+
+    // grown by amount on every side; a negative amount shrinks it
+    Bounds expanded(float amount) const
+    {
+        return Bounds(min - glm::vec3(amount), max + glm::vec3(amount));
+    }
+
+    // the box of every vertex position; stride is in floats and the position comes first
+    static Bounds fromVertices(const float* vertices, size_t vertexCount, int stride)
+    {
+        Bounds bounds;
+        for (size_t i = 0; i < vertexCount; i++)
+            bounds.add(glm::vec3(vertices[i * stride], vertices[i * stride + 1], vertices[i * stride + 2]));
+        return bounds;
+    }
+
+    // the box around this box after model (Arvo): the center moves, the extent takes |M|
+    Bounds transformed(const glm::mat4& model) const
+    {
+        if (empty())
+            return *this;
+        glm::vec3 c = glm::vec3(model * glm::vec4(center(), 1.0f));
+        glm::vec3 e = extent();
+        glm::vec3 r;
+        for (int i = 0; i < 3; i++)
+            r[i] = fabsf(model[0][i]) * e.x + fabsf(model[1][i]) * e.y + fabsf(model[2][i]) * e.z;
+        return Bounds(c - r, c + r);
+    }
+};
+
+enum FrustumTest {
+    FRUSTUM_OUTSIDE,
+    FRUSTUM_INTERSECTS,
+    FRUSTUM_INSIDE
+};
+
+struct Frustum {
+    glm::vec4 planes[6];  // left, right, bottom, top, near, far; normals point inwards
+
+    Frustum() {}
+
+    // from projection * view; a box is then tested in world space
+    explicit Frustum(const glm::mat4& viewProjection)
+    {
+        const glm::mat4& m = viewProjection;
+        for (int i = 0; i < 3; i++)
+        {
+            glm::vec4 row(m[0][i], m[1][i], m[2][i], m[3][i]);
+            glm::vec4 w(m[0][3], m[1][3], m[2][3], m[3][3]);
+            planes[i * 2] = w + row;
+            planes[i * 2 + 1] = w - row;
+        }
+        for (int i = 0; i < 6; i++)
+            planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+
+    // only the box corner furthest along each plane normal (and the nearest one) is checked
+    FrustumTest test(const Bounds& bounds) const
+    {
+        if (bounds.empty())
+            return FRUSTUM_OUTSIDE;
+        glm::vec3 c = bounds.center(), e = bounds.extent();
+        FrustumTest result = FRUSTUM_INSIDE;
+        for (int i = 0; i < 6; i++)
+        {
+            glm::vec3 n = glm::vec3(planes[i]);
+            float distance = glm::dot(n, c) + planes[i].w;
+            float radius = fabsf(n.x) * e.x + fabsf(n.y) * e.y + fabsf(n.z) * e.z;
+            if (distance < -radius)
+                return FRUSTUM_OUTSIDE;
+            if (distance < radius)
+                result = FRUSTUM_INTERSECTS;
+        }
+        return result;
+    }
+
+    bool visible(const Bounds& bounds) const
+    {
+        return test(bounds) != FRUSTUM_OUTSIDE;
+    }
+};
+
+#endif /* bounds_h */
@@ -0,0 +1,117 @@
+//
+//  bvh.h
+//  test
+//
+//  A bounding volume hierarchy over world-space boxes. It is built top down,
+//  splitting each range at the median centroid along its widest axis, and
+//  stored depth first: a node's left child follows it directly and every
+//  subtree owns one contiguous range of the item order. A frustum query can
+//  therefore skip a whole subtree that is outside, and take a subtree that
+//  is fully inside without testing anything below it.
+//
+
+#ifndef bvh_h
+#define bvh_h
+
+#include <algorithm>
+#include <vector>
+#include "bounds.h"
+
+#define BVH_LEAF_SIZE 4
+
+class BoundingVolumeHierarchy {
+public:
+    unsigned int nodesTested = 0;  // boxes the last query tested
+
+    BoundingVolumeHierarchy() {}
+
+    void build(const std::vector<Bounds>& items)
+    {
+        nodes.clear();
+        order.resize(items.size());
+        centers.resize(items.size());
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            order[i] = (unsigned int)i;
+            centers[i] = items[i].center();
+        }
+        if (!items.empty())
+            subdivide(items, 0, (unsigned int)items.size());
+    }
+
+    // the items whose boxes touch the frustum, subtree by subtree
+    void query(const Frustum& frustum, std::vector<unsigned int>& visible)
+    {
+        visible.clear();
+        nodesTested = 0;
+        if (nodes.empty())
+            return;
+
+        unsigned int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const Node& node = nodes[stack[--top]];
+            nodesTested++;
+            FrustumTest test = frustum.test(node.bounds);
+            if (test == FRUSTUM_OUTSIDE)
+                continue;
+            if (test == FRUSTUM_INSIDE || node.right == 0)
+            {
+                // a leaf only partly inside is small enough to be drawn whole
+                visible.insert(visible.end(), order.begin() + node.first, order.begin() + node.first + node.count);
+                continue;
+            }
+            stack[top++] = node.right;
+            stack[top++] = (unsigned int)(&node - &nodes[0]) + 1;
+        }
+    }
+
+    size_t nodeCount() const
+    {
+        return nodes.size();
+    }
+
+private:
+    struct Node {
+        Bounds bounds;
+        unsigned int first, count;  // the range of order below this node
+        unsigned int right;         // 0 for a leaf; the left child is the next node
+    };
+
+    std::vector<Node> nodes;
+    std::vector<unsigned int> order;
+    std::vector<glm::vec3> centers;
+
+    unsigned int subdivide(const std::vector<Bounds>& items, unsigned int first, unsigned int count)
+    {
+        unsigned int index = (unsigned int)nodes.size();
+        nodes.push_back(Node());
+        Bounds bounds, centroids;
+        for (unsigned int i = first; i < first + count; i++)
+        {
+            bounds.add(items[order[i]]);
+            centroids.add(centers[order[i]]);
+        }
+        nodes[index].bounds = bounds;
+        nodes[index].first = first;
+        nodes[index].count = count;
+        nodes[index].right = 0;
+        if (count <= BVH_LEAF_SIZE)
+            return index;
+
+        glm::vec3 size = centroids.max - centroids.min;
+        int axis = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+        unsigned int half = count / 2;
+        std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+            [this, axis](unsigned int a, unsigned int b) { return centers[a][axis] < centers[b][axis]; });
+
+        subdivide(items, first, half);
+        unsigned int right = subdivide(items, first + half, count - half);
+        nodes[index].right = right;
+        return index;
+    }
+};
+
+#endif /* bvh_h */
@@ -146,6 +146,15 @@ public:
             Zoom = 45.0f;
     }
 
+    // places the camera directly, e.g. along a scripted path
+    void SetPose(glm::vec3 position, float yaw, float pitch)
+    {
+        Position = position;
+        Yaw = yaw;
+        Pitch = pitch;
+        updateCameraVectors();
+    }
+
 private:
     // calculates the front vector from the Camera's (updated) Euler Angles
     void updateCameraVectors()
@@ -14,6 +14,9 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "shader.h"
+#include "meshCache.h"
+#include "renderQueue.h"
+#include "materialTable.h"
 
 using namespace std;
 
@@ -24,6 +27,7 @@ public:
     glm::vec3 ambient;
     glm::vec3 diffuse;
     glm::vec3 specular;
+    int materialIndex = 0;  // row in MaterialTable
 
     // texture property
     float TXmin = 0.0f;
@@ -48,6 +52,7 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
 
         setUpCubeVertexDataAndConfigureVertexAttribute();
     }
@@ -68,11 +73,7 @@ public:
     // destructor
     ~Cube()
     {
-        glDeleteVertexArrays(1, &cubeVAO);
-        glDeleteVertexArrays(1, &lightCubeVAO);
-        glDeleteVertexArrays(1, &lightTexCubeVAO);
-        glDeleteBuffers(1, &cubeVBO);
-        glDeleteBuffers(1, &cubeEBO);
+        MeshCache::shared().release(mesh);
     }
 
     void drawCubeWithTexture(Shader& lightingShaderWithTexture, glm::mat4 model = glm::mat4(1.0f))
@@ -85,30 +86,45 @@ public:
 
 
         // bind diffuse map
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, this->diffuseMap);
+        bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, this->diffuseMap);
         // bind specular map
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, this->specularMap);
+        bindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D, this->specularMap);
 
+        lightingShaderWithTexture.setVec4("textureRange", glm::vec4(this->TXmin, this->TYmin, this->TXmax, this->TYmax));
         lightingShaderWithTexture.setMat4("model", model);
 
-        glBindVertexArray(lightTexCubeVAO);
+        bindVertexArray(mesh->texturedVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
+    // records the same draw in queue; it is issued, sorted by state, when the queue is submitted
+    void queueCubeWithTexture(RenderQueue& queue, Shader& lightingShaderWithTexture, const glm::mat4& model) const
+    {
+        queue.addTextured(lightingShaderWithTexture, mesh->texturedVAO, 36, this->diffuseMap, this->specularMap, this->shininess,
+            glm::vec4(this->TXmin, this->TYmin, this->TXmax, this->TYmax), model);
+    }
+
+    // the box of the mesh before any model matrix
+    Bounds localBounds() const
+    {
+        return mesh->bounds;
+    }
+
+    // the triangles the occlusion culler draws when a node of this mesh hides what is behind it
+    const OccluderMesh* occluder() const
+    {
+        return &mesh->occluder;
+    }
+
     void drawCubeWithMaterialisticProperty(Shader& lightingShader, glm::mat4 model = glm::mat4(1.0f))
     {
         lightingShader.use();
 
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
-        lightingShader.setFloat("material.shininess", this->shininess);
+        lightingShader.setInt("materialIndex", this->materialIndex);
 
         lightingShader.setMat4("model", model);
 
-        glBindVertexArray(lightCubeVAO);
+        bindVertexArray(mesh->litVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
@@ -119,7 +135,7 @@ public:
         shader.setVec3("color", glm::vec3(r, g, b));
         shader.setMat4("model", model);
 
-        glBindVertexArray(cubeVAO);
+        bindVertexArray(mesh->colorVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
@@ -129,6 +145,7 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
     }
 
     void setTextureProperty(unsigned int dMap, unsigned int sMap, float shiny)
@@ -138,12 +155,14 @@ public:
         this->shininess = shiny;
     }
 
+    // the MeshCache key of the geometry, for drawing it instanced
+    const string& meshKey() const
+    {
+        return mesh->key;
+    }
+
 private:
-    unsigned int cubeVAO;
-    unsigned int lightCubeVAO;
-    unsigned int lightTexCubeVAO;
-    unsigned int cubeVBO;
-    unsigned int cubeEBO;
+    SharedMesh* mesh = NULL;
 
     void setUpCubeVertexDataAndConfigureVertexAttribute()
     {
@@ -153,10 +172,10 @@ private:
         float cube_vertices[] = {
             // positions      // normals         // texture
             // back
-            -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, TXmin, TYmin,
-            0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, TXmax, TYmin,
-            0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, TXmax, TYmax,
-            -0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, TXmin, TYmin,
+            -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0, 0,
+            0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1, 0,
+            0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1, 1,
+            -0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0, 0,
 
             // right
             0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 0, 0,
@@ -165,22 +184,22 @@ private:
             0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 0, 0,
 
             // front
-            -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, TXmin, TYmin,
-            0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, TXmax, TYmin,
-            0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, TXmax, TYmax,
-            -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, TXmin, TYmin,
+            -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0, 0,
+            0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1, 0,
+            0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1, 1,
+            -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0, 0,
 
             // left
-            -0.5f, -0.5f, 0.5f, -1.0f, 0.0f, 0.0f, TXmin, TYmin,
-            -0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, TXmin, TYmax,
-            -0.5f, 0.5f, -0.5f, -1.0f, 0.0f, 0.0f, TXmax, TYmax,
-            -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, TXmax, TYmin,
+            -0.5f, -0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 0, 0,
+            -0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 0, 1,
+            -0.5f, 0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 1, 1,
+            -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 1, 0,
 
             // top
-            0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, TXmin, TYmin,
-            0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, TXmin, TYmax,
-            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, TXmax, TYmax,
-            -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, TXmax, TYmin,
+            0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0, 0,
+            0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0, 1,
+            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 1, 1,
+            -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 1, 0,
 
             // bottom
             -0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 0, 0,
@@ -209,53 +228,7 @@ private:
             22, 23, 20
         };
 
-        glGenVertexArrays(1, &cubeVAO);
-        glGenVertexArrays(1, &lightCubeVAO);
-        glGenVertexArrays(1, &lightTexCubeVAO);
-        glGenBuffers(1, &cubeVBO);
-        glGenBuffers(1, &cubeEBO);
-
-
-        glBindVertexArray(lightTexCubeVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(cube_vertices), cube_vertices, GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-
-        // position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        // vertex normal attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)12);
-        glEnableVertexAttribArray(1);
-
-        // texture coordinate attribute
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)24);
-        glEnableVertexAttribArray(2);
-
-
-        glBindVertexArray(lightCubeVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)12);
-        glEnableVertexAttribArray(1);
-
-
-        glBindVertexArray(cubeVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
+        mesh = MeshCache::shared().create(MeshCache::key("Cube"), cube_vertices, sizeof(cube_vertices), 8, cube_indices, sizeof(cube_indices));
     }
 
 };
@@ -269,6 +242,7 @@ public:
     glm::vec3 ambient;
     glm::vec3 diffuse;
     glm::vec3 specular;
+    int materialIndex = 0;
 
     // texture property
     float TXmin = 0.0f;
@@ -293,6 +267,7 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
 
         setUpCubeVertexDataAndConfigureVertexAttribute();
     }
@@ -313,11 +288,7 @@ public:
     // destructor
     ~Cube2()
     {
-        glDeleteVertexArrays(1, &cubeVAO);
-        glDeleteVertexArrays(1, &lightCubeVAO);
-        glDeleteVertexArrays(1, &lightTexCubeVAO);
-        glDeleteBuffers(1, &cubeVBO);
-        glDeleteBuffers(1, &cubeEBO);
+        MeshCache::shared().release(mesh);
     }
 
     void drawCubeWithTexture(Shader& lightingShaderWithTexture, glm::mat4 model = glm::mat4(1.0f))
@@ -330,30 +301,44 @@ public:
 
 
         // bind diffuse map
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, this->diffuseMap);
+        bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, this->diffuseMap);
         // bind specular map
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, this->specularMap);
+        bindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D, this->specularMap);
 
+        lightingShaderWithTexture.setVec4("textureRange", glm::vec4(this->TXmin, this->TYmin, this->TXmax, this->TYmax));
         lightingShaderWithTexture.setMat4("model", model);
 
-        glBindVertexArray(lightTexCubeVAO);
+        bindVertexArray(mesh->texturedVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
+    void queueCubeWithTexture(RenderQueue& queue, Shader& lightingShaderWithTexture, const glm::mat4& model) const
+    {
+        queue.addTextured(lightingShaderWithTexture, mesh->texturedVAO, 36, this->diffuseMap, this->specularMap, this->shininess,
+            glm::vec4(this->TXmin, this->TYmin, this->TXmax, this->TYmax), model);
+    }
+
+    // the box of the mesh before any model matrix
+    Bounds localBounds() const
+    {
+        return mesh->bounds;
+    }
+
+    // the triangles the occlusion culler draws when a node of this mesh hides what is behind it
+    const OccluderMesh* occluder() const
+    {
+        return &mesh->occluder;
+    }
+
     void drawCubeWithMaterialisticProperty(Shader& lightingShader, glm::mat4 model = glm::mat4(1.0f))
     {
         lightingShader.use();
 
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
-        lightingShader.setFloat("material.shininess", this->shininess);
+        lightingShader.setInt("materialIndex", this->materialIndex);
 
         lightingShader.setMat4("model", model);
 
-        glBindVertexArray(lightCubeVAO);
+        bindVertexArray(mesh->litVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
@@ -364,7 +349,7 @@ public:
         shader.setVec3("color", glm::vec3(r, g, b));
         shader.setMat4("model", model);
 
-        glBindVertexArray(cubeVAO);
+        bindVertexArray(mesh->colorVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
@@ -374,6 +359,7 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
     }
 
     void setTextureProperty(unsigned int dMap, unsigned int sMap, float shiny)
@@ -384,11 +370,7 @@ public:
     }
 
 private:
-    unsigned int cubeVAO;
-    unsigned int lightCubeVAO;
-    unsigned int lightTexCubeVAO;
-    unsigned int cubeVBO;
-    unsigned int cubeEBO;
+    SharedMesh* mesh = NULL;
 
     void setUpCubeVertexDataAndConfigureVertexAttribute()
     {
@@ -416,22 +398,22 @@ private:
             -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0, 0,
 
             // left
-            -0.5f, -0.5f, 0.5f, -1.0f, 0.0f, 0.0f, TXmin, TYmin,
-            -0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, TXmin, TYmax,
-            -0.5f, 0.5f, -0.5f, -1.0f, 0.0f, 0.0f, TXmax, TYmax,
-            -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, TXmax, TYmin,
+            -0.5f, -0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 0, 0,
+            -0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 0, 1,
+            -0.5f, 0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 1, 1,
+            -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 1, 0,
 
             // top
-            0.25f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, TXmin, TYmin,
-            0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, TXmin, TYmax,
-            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, TXmax, TYmax,
-            -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, TXmax, TYmin,
+            0.25f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0, 0,
+            0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0, 1,
+            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 1, 1,
+            -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 1, 0,
 
             // bottom
-            -0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, TXmin, TYmin,
-            0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, TXmin, TYmax,
-            0.25f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f, TXmax, TYmax,
-            -0.5f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f, TXmax, TYmin
+            -0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 0, 0,
+            0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 0, 1,
+            0.25f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f, 1, 1,
+            -0.5f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f, 1, 0
         };
 
         unsigned int cube_indices[] = {
@@ -454,53 +436,7 @@ private:
             22, 23, 20
         };
 
-        glGenVertexArrays(1, &cubeVAO);
-        glGenVertexArrays(1, &lightCubeVAO);
-        glGenVertexArrays(1, &lightTexCubeVAO);
-        glGenBuffers(1, &cubeVBO);
-        glGenBuffers(1, &cubeEBO);
-
-
-        glBindVertexArray(lightTexCubeVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(cube_vertices), cube_vertices, GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-
-        // position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        // vertex normal attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)12);
-        glEnableVertexAttribArray(1);
-
-        // texture coordinate attribute
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)24);
-        glEnableVertexAttribArray(2);
-
-
-        glBindVertexArray(lightCubeVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)12);
-        glEnableVertexAttribArray(1);
-
-
-        glBindVertexArray(cubeVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
+        mesh = MeshCache::shared().create(MeshCache::key("Cube2"), cube_vertices, sizeof(cube_vertices), 8, cube_indices, sizeof(cube_indices));
     }
 
 };
@@ -513,6 +449,7 @@ public:
     glm::vec3 ambient;
     glm::vec3 diffuse;
     glm::vec3 specular;
+    int materialIndex = 0;
 
     // Texture properties
     float TXmin = 0.0f;
@@ -537,6 +474,7 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
 
         setUpRoofVertexDataAndConfigureVertexAttribute();
     }
@@ -557,11 +495,7 @@ public:
     // Destructor
     ~Roof()
     {
-        glDeleteVertexArrays(1, &roofVAO);
-        glDeleteVertexArrays(1, &lightRoofVAO);
-        glDeleteVertexArrays(1, &lightTexRoofVAO);
-        glDeleteBuffers(1, &roofVBO);
-        glDeleteBuffers(1, &roofEBO);
+        MeshCache::shared().release(mesh);
     }
 
     void drawRoofWithTexture(Shader& lightingShaderWithTexture, glm::mat4 model = glm::mat4(1.0f))
@@ -573,30 +507,44 @@ public:
         lightingShaderWithTexture.setFloat("material.shininess", this->shininess);
 
         // Bind diffuse map
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, this->diffuseMap);
+        bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, this->diffuseMap);
         // Bind specular map
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, this->specularMap);
+        bindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D, this->specularMap);
 
+        lightingShaderWithTexture.setVec4("textureRange", glm::vec4(this->TXmin, this->TYmin, this->TXmax, this->TYmax));
         lightingShaderWithTexture.setMat4("model", model);
 
-        glBindVertexArray(lightTexRoofVAO);
+        bindVertexArray(mesh->texturedVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
+    void queueRoofWithTexture(RenderQueue& queue, Shader& lightingShaderWithTexture, const glm::mat4& model) const
+    {
+        queue.addTextured(lightingShaderWithTexture, mesh->texturedVAO, 36, this->diffuseMap, this->specularMap, this->shininess,
+            glm::vec4(this->TXmin, this->TYmin, this->TXmax, this->TYmax), model);
+    }
+
+    // the box of the mesh before any model matrix
+    Bounds localBounds() const
+    {
+        return mesh->bounds;
+    }
+
+    // the triangles the occlusion culler draws when a node of this mesh hides what is behind it
+    const OccluderMesh* occluder() const
+    {
+        return &mesh->occluder;
+    }
+
     void drawRoofWithMaterialisticProperty(Shader& lightingShader, glm::mat4 model = glm::mat4(1.0f))
     {
         lightingShader.use();
 
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
-        lightingShader.setFloat("material.shininess", this->shininess);
+        lightingShader.setInt("materialIndex", this->materialIndex);
 
         lightingShader.setMat4("model", model);
 
-        glBindVertexArray(lightRoofVAO);
+        bindVertexArray(mesh->litVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
@@ -607,7 +555,7 @@ public:
         shader.setVec3("color", glm::vec3(r, g, b));
         shader.setMat4("model", model);
 
-        glBindVertexArray(roofVAO);
+        bindVertexArray(mesh->colorVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
@@ -617,6 +565,7 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
     }
 
     void setTextureProperty(unsigned int dMap, unsigned int sMap, float shiny)
@@ -627,11 +576,7 @@ public:
     }
 
 private:
-    unsigned int roofVAO;
-    unsigned int lightRoofVAO;
-    unsigned int lightTexRoofVAO;
-    unsigned int roofVBO;
-    unsigned int roofEBO;
+    SharedMesh* mesh = NULL;
 
     void setUpRoofVertexDataAndConfigureVertexAttribute()
     {
@@ -657,16 +602,16 @@ private:
             -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0, 0,
 
             // left
-            -0.5f, -0.5f, 0.5f, -1.0f, 0.0f, 0.0f, TXmin, TYmin,
-            -0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, TXmin, TYmax,
-            -0.5f, 0.5f, -0.5f, -1.0f, 0.0f, 0.0f, TXmax, TYmax,
-            -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, TXmax, TYmin,
+            -0.5f, -0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 0, 0,
+            -0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 0, 1,
+            -0.5f, 0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 1, 1,
+            -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 1, 0,
 
             // top
-            0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, TXmin, TYmin,
-            0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, TXmin, TYmax,
-            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, TXmax, TYmax,
-            -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, TXmax, TYmin,
+            0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0, 0,
+            0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0, 1,
+            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 1, 1,
+            -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 1, 0,
 
             // bottom
             -0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 0, 0,
@@ -695,50 +640,7 @@ private:
             22, 23, 20
         };
 
-        glGenVertexArrays(1, &roofVAO);
-        glGenVertexArrays(1, &lightRoofVAO);
-        glGenVertexArrays(1, &lightTexRoofVAO);
-        glGenBuffers(1, &roofVBO);
-        glGenBuffers(1, &roofEBO);
-
-        glBindVertexArray(lightTexRoofVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, roofVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(roof_vertices), roof_vertices, GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, roofEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(roof_indices), roof_indices, GL_STATIC_DRAW);
-
-        // Position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        // Normal attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)12);
-        glEnableVertexAttribArray(1);
-
-        // Texture coordinate attribute
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)24);
-        glEnableVertexAttribArray(2);
-
-        glBindVertexArray(lightRoofVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, roofVBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, roofEBO);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)12);
-        glEnableVertexAttribArray(1);
-
-        glBindVertexArray(roofVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, roofVBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, roofEBO);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
+        mesh = MeshCache::shared().create(MeshCache::key("Roof"), roof_vertices, sizeof(roof_vertices), 8, roof_indices, sizeof(roof_indices));
     }
 };
 
@@ -750,6 +652,7 @@ public:
     glm::vec3 ambient;
     glm::vec3 diffuse;
     glm::vec3 specular;
+    int materialIndex = 0;
 
     // texture property
     float TXmin = 0.0f;
@@ -774,6 +677,7 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
 
         setUpCubeVertexDataAndConfigureVertexAttribute();
     }
@@ -794,11 +698,7 @@ public:
     // destructor
     ~Angular_roof()
     {
-        glDeleteVertexArrays(1, &cubeVAO);
-        glDeleteVertexArrays(1, &lightCubeVAO);
-        glDeleteVertexArrays(1, &lightTexCubeVAO);
-        glDeleteBuffers(1, &cubeVBO);
-        glDeleteBuffers(1, &cubeEBO);
+        MeshCache::shared().release(mesh);
     }
 
     void drawCubeWithTexture(Shader& lightingShaderWithTexture, glm::mat4 model = glm::mat4(1.0f))
@@ -811,30 +711,44 @@ public:
 
 
         // bind diffuse map
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, this->diffuseMap);
+        bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, this->diffuseMap);
         // bind specular map
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, this->specularMap);
+        bindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D, this->specularMap);
 
+        lightingShaderWithTexture.setVec4("textureRange", glm::vec4(this->TXmin, this->TYmin, this->TXmax, this->TYmax));
         lightingShaderWithTexture.setMat4("model", model);
 
-        glBindVertexArray(lightTexCubeVAO);
+        bindVertexArray(mesh->texturedVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
+    void queueCubeWithTexture(RenderQueue& queue, Shader& lightingShaderWithTexture, const glm::mat4& model) const
+    {
+        queue.addTextured(lightingShaderWithTexture, mesh->texturedVAO, 36, this->diffuseMap, this->specularMap, this->shininess,
+            glm::vec4(this->TXmin, this->TYmin, this->TXmax, this->TYmax), model);
+    }
+
+    // the box of the mesh before any model matrix
+    Bounds localBounds() const
+    {
+        return mesh->bounds;
+    }
+
+    // the triangles the occlusion culler draws when a node of this mesh hides what is behind it
+    const OccluderMesh* occluder() const
+    {
+        return &mesh->occluder;
+    }
+
     void drawCubeWithMaterialisticProperty(Shader& lightingShader, glm::mat4 model = glm::mat4(1.0f))
     {
         lightingShader.use();
 
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
-        lightingShader.setFloat("material.shininess", this->shininess);
+        lightingShader.setInt("materialIndex", this->materialIndex);
 
         lightingShader.setMat4("model", model);
 
-        glBindVertexArray(lightCubeVAO);
+        bindVertexArray(mesh->litVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
@@ -845,7 +759,7 @@ public:
         shader.setVec3("color", glm::vec3(r, g, b));
         shader.setMat4("model", model);
 
-        glBindVertexArray(cubeVAO);
+        bindVertexArray(mesh->colorVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
@@ -855,6 +769,7 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
     }
 
     void setTextureProperty(unsigned int dMap, unsigned int sMap, float shiny)
@@ -865,11 +780,7 @@ public:
     }
 
 private:
-    unsigned int cubeVAO;
-    unsigned int lightCubeVAO;
-    unsigned int lightTexCubeVAO;
-    unsigned int cubeVBO;
-    unsigned int cubeEBO;
+    SharedMesh* mesh = NULL;
 
     void setUpCubeVertexDataAndConfigureVertexAttribute()
     {
@@ -897,22 +808,22 @@ private:
             -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0, 0,
 
             // left
-            -0.5f, -0.5f, 0.5f, -1.0f, 0.0f, 0.0f, TXmin, TYmin,
-            -0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, TXmin, TYmax,
-            -0.5f, 0.5f, -0.5f, -1.0f, 0.0f, 0.0f, TXmax, TYmax,
-            -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, TXmax, TYmin,
+            -0.5f, -0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 0, 0,
+            -0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 0, 1,
+            -0.5f, 0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 1, 1,
+            -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 1, 0,
 
             // top
-            0.25f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, TXmin, TYmin,
-            0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, TXmin, TYmax,
-            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, TXmax, TYmax,
-            -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, TXmax, TYmin,
+            0.25f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0, 0,
+            0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0, 1,
+            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 1, 1,
+            -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 1, 0,
 
             // bottom
-            -0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, TXmin, TYmin,
-            0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, TXmin, TYmax,
-            0.25f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f, TXmax, TYmax,
-            -0.5f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f, TXmax, TYmin
+            -0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 0, 0,
+            0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 0, 1,
+            0.25f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f, 1, 1,
+            -0.5f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f, 1, 0
         };
 
         unsigned int cube_indices[] = {
@@ -935,53 +846,8 @@ private:
             22, 23, 20
         };
 
-        glGenVertexArrays(1, &cubeVAO);
-        glGenVertexArrays(1, &lightCubeVAO);
-        glGenVertexArrays(1, &lightTexCubeVAO);
-        glGenBuffers(1, &cubeVBO);
-        glGenBuffers(1, &cubeEBO);
-
-
-        glBindVertexArray(lightTexCubeVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(cube_vertices), cube_vertices, GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-
-        // position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        // vertex normal attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)12);
-        glEnableVertexAttribArray(1);
-
-        // texture coordinate attribute
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)24);
-        glEnableVertexAttribArray(2);
-
-
-        glBindVertexArray(lightCubeVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)12);
-        glEnableVertexAttribArray(1);
-
-
-        glBindVertexArray(cubeVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
+        // same geometry as Cube2, so both share one upload
+        mesh = MeshCache::shared().create(MeshCache::key("Cube2"), cube_vertices, sizeof(cube_vertices), 8, cube_indices, sizeof(cube_indices));
     }
 
 };
@@ -993,6 +859,7 @@ public:
     glm::vec3 ambient;
     glm::vec3 diffuse;
     glm::vec3 specular;
+    int materialIndex = 0;
 
     // texture property
     float TXmin = 0.0f;
@@ -1017,6 +884,7 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
 
         setUpRightWallVertexDataAndConfigureVertexAttribute();
     }
@@ -1037,11 +905,7 @@ public:
     // destructor
     ~RightWall()
     {
-        glDeleteVertexArrays(1, &rightWallVAO);
-        glDeleteVertexArrays(1, &lightRightWallVAO);
-        glDeleteVertexArrays(1, &lightTexRightWallVAO);
-        glDeleteBuffers(1, &rightWallVBO);
-        glDeleteBuffers(1, &rightWallEBO);
+        MeshCache::shared().release(mesh);
     }
 
     void drawRightWallWithTexture(Shader& lightingShaderWithTexture, glm::mat4 model = glm::mat4(1.0f))
@@ -1053,30 +917,44 @@ public:
         lightingShaderWithTexture.setFloat("material.shininess", this->shininess);
 
         // bind diffuse map
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, this->diffuseMap);
+        bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, this->diffuseMap);
         // bind specular map
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, this->specularMap);
+        bindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D, this->specularMap);
 
+        lightingShaderWithTexture.setVec4("textureRange", glm::vec4(this->TXmin, this->TYmin, this->TXmax, this->TYmax));
         lightingShaderWithTexture.setMat4("model", model);
 
-        glBindVertexArray(lightTexRightWallVAO);
+        bindVertexArray(mesh->texturedVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
+    void queueRightWallWithTexture(RenderQueue& queue, Shader& lightingShaderWithTexture, const glm::mat4& model) const
+    {
+        queue.addTextured(lightingShaderWithTexture, mesh->texturedVAO, 36, this->diffuseMap, this->specularMap, this->shininess,
+            glm::vec4(this->TXmin, this->TYmin, this->TXmax, this->TYmax), model);
+    }
+
+    // the box of the mesh before any model matrix
+    Bounds localBounds() const
+    {
+        return mesh->bounds;
+    }
+
+    // the triangles the occlusion culler draws when a node of this mesh hides what is behind it
+    const OccluderMesh* occluder() const
+    {
+        return &mesh->occluder;
+    }
+
     void drawRightWallWithMaterialisticProperty(Shader& lightingShader, glm::mat4 model = glm::mat4(1.0f))
     {
         lightingShader.use();
 
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
-        lightingShader.setFloat("material.shininess", this->shininess);
+        lightingShader.setInt("materialIndex", this->materialIndex);
 
         lightingShader.setMat4("model", model);
 
-        glBindVertexArray(lightRightWallVAO);
+        bindVertexArray(mesh->litVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
@@ -1087,7 +965,7 @@ public:
         shader.setVec3("color", glm::vec3(r, g, b));
         shader.setMat4("model", model);
 
-        glBindVertexArray(rightWallVAO);
+        bindVertexArray(mesh->colorVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
@@ -1097,6 +975,7 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
     }
 
     void setTextureProperty(unsigned int dMap, unsigned int sMap, float shiny)
@@ -1107,11 +986,7 @@ public:
     }
 
 private:
-    unsigned int rightWallVAO;
-    unsigned int lightRightWallVAO;
-    unsigned int lightTexRightWallVAO;
-    unsigned int rightWallVBO;
-    unsigned int rightWallEBO;
+    SharedMesh* mesh = NULL;
 
     void setUpRightWallVertexDataAndConfigureVertexAttribute()
     {
@@ -1121,40 +996,40 @@ private:
         float rightWall_vertices[] = {
             // positions      // normals         // texture
             // back
-            -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, TXmax, TYmin,
-            0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, TXmin, TYmin,
-            0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, TXmin, TYmax,
-            -0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, TXmax, TYmax,
+            -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1, 0,
+            0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0, 0,
+            0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0, 1,
+            -0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1, 1,
 
             // right
-            0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, TXmax, TYmin,
-            0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 0.0f, TXmax, TYmax,
-            0.5f, -0.5f, 0.5f, 1.0f, 0.0f, 0.0f, TXmin, TYmin,
-            0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 0.0f, TXmin, TYmax,
+            0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1, 0,
+            0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1, 1,
+            0.5f, -0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 0, 0,
+            0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 0, 1,
 
             // front
-            -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, TXmin, TYmin,
-            0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, TXmax, TYmin,
-            0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, TXmax, TYmax,
-            -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, TXmin, TYmax,
+            -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0, 0,
+            0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1, 0,
+            0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1, 1,
+            -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0, 1,
 
             // left
-            -0.5f, -0.5f, 0.5f, -1.0f, 0.0f, 0.0f, TXmin, TYmin,
-            -0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, TXmin, TYmax,
-            -0.5f, 0.5f, -0.5f, -1.0f, 0.0f, 0.0f, TXmax, TYmax,
-            -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, TXmax, TYmin,
+            -0.5f, -0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 0, 0,
+            -0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 0, 1,
+            -0.5f, 0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 1, 1,
+            -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 1, 0,
 
             // top
-            0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, TXmin, TYmin,
-            0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, TXmin, TYmax,
-            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, TXmax, TYmax,
-            -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, TXmax, TYmin,
+            0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0, 0,
+            0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0, 1,
+            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 1, 1,
+            -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 1, 0,
 
             // bottom
-            -0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, TXmin, TYmin,
-            0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, TXmin, TYmax,
-            0.5f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f, TXmax, TYmax,
-            -0.5f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f,TXmax, TYmin,
+            -0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 0, 0,
+            0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 0, 1,
+            0.5f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f, 1, 1,
+            -0.5f, -0.5f, 0.5f, 0.0f, -1.0f, 0.0f,1, 0,
         };
 
         unsigned int rightWall_indices[] = {
@@ -1177,50 +1052,7 @@ private:
             22, 23, 20
         };
 
-        glGenVertexArrays(1, &rightWallVAO);
-        glGenVertexArrays(1, &lightRightWallVAO);
-        glGenVertexArrays(1, &lightTexRightWallVAO);
-        glGenBuffers(1, &rightWallVBO);
-        glGenBuffers(1, &rightWallEBO);
-
-        glBindVertexArray(lightTexRightWallVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, rightWallVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(rightWall_vertices), rightWall_vertices, GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rightWallEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(rightWall_indices), rightWall_indices, GL_STATIC_DRAW);
-
-        // position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        // vertex normal attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)12);
-        glEnableVertexAttribArray(1);
-
-        // texture coordinate attribute
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)24);
-        glEnableVertexAttribArray(2);
-
-        glBindVertexArray(lightRightWallVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, rightWallVBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rightWallEBO);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)12);
-        glEnableVertexAttribArray(1);
-
-        glBindVertexArray(rightWallVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, rightWallVBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rightWallEBO);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
+        mesh = MeshCache::shared().create(MeshCache::key("RightWall"), rightWall_vertices, sizeof(rightWall_vertices), 8, rightWall_indices, sizeof(rightWall_indices));
     }
 };
 
@@ -1231,6 +1063,7 @@ public:
     glm::vec3 ambient;
     glm::vec3 diffuse;
     glm::vec3 specular;
+    int materialIndex = 0;
 
     // texture property
     float TXmin = 0.0f;
@@ -1255,6 +1088,7 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
 
         setUpDoorVertexDataAndConfigureVertexAttribute();
     }
@@ -1275,9 +1109,7 @@ public:
     // destructor
     ~Door()
     {
-        glDeleteVertexArrays(1, &doorVAO);
-        glDeleteBuffers(1, &doorVBO);
-        glDeleteBuffers(1, &doorEBO);
+        MeshCache::shared().release(mesh);
     }
 
     void drawDoorWithTexture(Shader& lightingShaderWithTexture, glm::mat4 model = glm::mat4(1.0f))
@@ -1289,30 +1121,38 @@ public:
         lightingShaderWithTexture.setFloat("material.shininess", this->shininess);
 
         // bind diffuse map
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, this->diffuseMap);
+        bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, this->diffuseMap);
         // bind specular map
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, this->specularMap);
+        bindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D, this->specularMap);
 
+        lightingShaderWithTexture.setVec4("textureRange", glm::vec4(this->TXmin, this->TYmin, this->TXmax, this->TYmax));
         lightingShaderWithTexture.setMat4("model", model);
 
-        glBindVertexArray(doorVAO);
+        bindVertexArray(mesh->texturedVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
+    void queueDoorWithTexture(RenderQueue& queue, Shader& lightingShaderWithTexture, const glm::mat4& model) const
+    {
+        queue.addTextured(lightingShaderWithTexture, mesh->texturedVAO, 36, this->diffuseMap, this->specularMap, this->shininess,
+            glm::vec4(this->TXmin, this->TYmin, this->TXmax, this->TYmax), model);
+    }
+
+    // the box of the mesh before any model matrix
+    Bounds localBounds() const
+    {
+        return mesh->bounds;
+    }
+
     void drawDoorWithMaterialisticProperty(Shader& lightingShader, glm::mat4 model = glm::mat4(1.0f))
     {
         lightingShader.use();
 
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
-        lightingShader.setFloat("material.shininess", this->shininess);
+        lightingShader.setInt("materialIndex", this->materialIndex);
 
         lightingShader.setMat4("model", model);
 
-        glBindVertexArray(doorVAO);
+        bindVertexArray(mesh->litVAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     }
 
@@ -1322,6 +1162,7 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
     }
 
     void setTextureProperty(unsigned int dMap, unsigned int sMap, float shiny)
@@ -1332,9 +1173,7 @@ public:
     }
 
 private:
-    unsigned int doorVAO;
-    unsigned int doorVBO;
-    unsigned int doorEBO;
+    SharedMesh* mesh = NULL;
 
     void setUpDoorVertexDataAndConfigureVertexAttribute()
     {
@@ -1344,10 +1183,10 @@ private:
         float door_vertices[] = {
             // positions      // normals         // texture
             // back
-            -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, TXmin, TYmin,
-            0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, TXmax, TYmin,
-            0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, TXmax, TYmax,
-            -0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, TXmin, TYmin,
+            -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0, 0,
+            0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1, 0,
+            0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 1, 1,
+            -0.5f, 0.5f, -0.5f, 0.0f, 0.0f, -1.0f, 0, 0,
 
             // right
             0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 0, 0,
@@ -1356,22 +1195,22 @@ private:
             0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 0, 0,
 
             // front
-            -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, TXmin, TYmin,
-            0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, TXmax, TYmin,
-            0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, TXmax, TYmax,
-            -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, TXmin, TYmin,
+            -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0, 0,
+            0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1, 0,
+            0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1, 1,
+            -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0, 0,
 
             // left
-            -0.5f, -0.5f, 0.5f, -1.0f, 0.0f, 0.0f, TXmin, TYmin,
-            -0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, TXmin, TYmax,
-            -0.5f, 0.5f, -0.5f, -1.0f, 0.0f, 0.0f, TXmax, TYmax,
-            -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, TXmax, TYmin,
+            -0.5f, -0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 0, 0,
+            -0.5f, 0.5f, 0.5f, -1.0f, 0.0f, 0.0f, 0, 1,
+            -0.5f, 0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 1, 1,
+            -0.5f, -0.5f, -0.5f, -1.0f, 0.0f, 0.0f, 1, 0,
 
             // top
-            0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, TXmin, TYmin,
-            0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, TXmin, TYmax,
-            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, TXmax, TYmax,
-            -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, TXmax, TYmin,
+            0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0, 0,
+            0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0, 1,
+            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 1, 1,
+            -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 1, 0,
 
             // bottom
             -0.5f, -0.5f, -0.5f, 0.0f, -1.0f, 0.0f, 0, 0,
@@ -1400,31 +1239,8 @@ private:
             22, 23, 20
         };
 
-        glGenVertexArrays(1, &doorVAO);
-        glGenBuffers(1, &doorVBO);
-        glGenBuffers(1, &doorEBO);
-
-        glBindVertexArray(doorVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, doorVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(door_vertices), door_vertices, GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, doorEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(door_indices), door_indices, GL_STATIC_DRAW);
-
-        // position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        // vertex normal attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)12);
-        glEnableVertexAttribArray(1);
-
-        // texture coordinate attribute
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)24);
-        glEnableVertexAttribArray(2);
-
-        glBindVertexArray(0);
+        // same geometry as Cube, so both share one upload
+        mesh = MeshCache::shared().create(MeshCache::key("Cube"), door_vertices, sizeof(door_vertices), 8, door_indices, sizeof(door_indices));
     }
 };
 
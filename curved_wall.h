@@ -4,7 +4,20 @@
 #include <vector>
 #include <glm/glm.hpp>
 #include <glad/glad.h>
-#include "Shader.h" // Include your Shader class here
+#include "shader.h" // Include your Shader class here
+#include "glResources.h"
+#include "renderQueue.h"
+#include "bounds.h"
+#include "occlusion.h"
+#include "lod.h"
+#include "tessellate.h"
+#include "tessellatedSurface.h"
+
+// how far, in the wall's own units, its faces may stray from the true arc until setTolerance()
+#define CURVED_WALL_DEFAULT_TOLERANCE 0.01f
+#define CURVED_WALL_MIN_SEGMENTS 2
+// sectors each curved face is split into when the GPU cuts the wall
+#define CURVED_WALL_PATCH_SECTORS 2
 
 class CubicCurvedWallTex
 {
@@ -14,58 +27,32 @@ public:
     glm::vec3 specular;
     float shininess;
 
-    CubicCurvedWallTex(float outerRadius = 10.0f, float innerRadius = 9.8f, float height = 10.0f, float angle = 90.0f, int segmentCount = 50,
+    CubicCurvedWallTex(float outerRadius = 10.0f, float innerRadius = 9.8f, float height = 10.0f, float angle = 90.0f, float tolerance = CURVED_WALL_DEFAULT_TOLERANCE,
         glm::vec3 amb = glm::vec3(1.0f, 0.5f, 0.31f),
         glm::vec3 diff = glm::vec3(1.0f, 0.5f, 0.31f),
         glm::vec3 spec = glm::vec3(0.5f, 0.5f, 0.5f),
         float shiny = 32.0f)
         : verticesStride(32)
     {
-        set(outerRadius, innerRadius, height, angle, segmentCount, amb, diff, spec, shiny);
-        buildCoordinatesAndIndices();
-        buildVertices();
-
-        glGenVertexArrays(1, &wallVAO);
-        glBindVertexArray(wallVAO);
-
-        // Create VBO for vertex data
-        unsigned int wallVBO;
-        glGenBuffers(1, &wallVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, wallVBO);
-        glBufferData(GL_ARRAY_BUFFER, getVertexSize(), getVertices(), GL_STATIC_DRAW);
-
-        // Create EBO for index data
-        unsigned int wallEBO;
-        glGenBuffers(1, &wallEBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, wallEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, getIndexSize(), getIndices(), GL_STATIC_DRAW);
-
-        // Enable vertex attributes
-        glEnableVertexAttribArray(0); // Position
-        glEnableVertexAttribArray(1); // Normal
-        glEnableVertexAttribArray(2); // Texture Coordinates
-
-        // Set attribute pointers
-        int stride = this->getVerticesStride();
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);                        // Position
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 3));      // Normal
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 6));      // Texture Coordinates
-
-        // Unbind VAO and buffers
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        set(outerRadius, innerRadius, height, angle, tolerance, amb, diff, spec, shiny);
+        if (TessellationPath::shared().enabled())
+            buildPatches();
+        tessellate();
     }
 
-    ~CubicCurvedWallTex() {}
+    ~CubicCurvedWallTex()
+    {
+        for (int level = 0; level < LOD_LEVELS; level++)
+            levels[level].release();
+    }
 
-    void set(float outerRadius, float innerRadius, float height, float angle, int segments, glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny)
+    void set(float outerRadius, float innerRadius, float height, float angle, float tolerance, glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny)
     {
         this->outerRadius = outerRadius;
         this->innerRadius = innerRadius;
         this->height = height;
         this->angle = glm::radians(angle); // Convert degrees to radians
-        this->segmentCount = segments > 2 ? segments : 2; // Ensure at least two segments
+        this->tolerance = tolerance;
         this->ambient = amb;
         this->diffuse = diff;
         this->specular = spec;
@@ -110,29 +97,137 @@ public:
     void drawCubicCurvedWall(Shader& lightingShader, unsigned int texture, glm::mat4 model) const
     {
         lightingShader.use();
-
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
         lightingShader.setFloat("material.shininess", this->shininess);
+        lightingShader.setVec4("textureRange", glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
         lightingShader.setMat4("model", model);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, texture);
 
-        glBindVertexArray(wallVAO);
+        bindVertexArray(levels[0].VAO);
         glDrawElements(GL_TRIANGLES, getIndexCount(), GL_UNSIGNED_INT, (void*)0);
-        glBindVertexArray(0);
+    }
+
+    void queueCubicCurvedWall(RenderQueue& queue, Shader& lightingShader, unsigned int texture, const glm::mat4& model) const
+    {
+        if (patches.uploaded())
+        {
+            patches.queue(queue, texture, texture, this->shininess, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), model);
+            return;
+        }
+        queue.addTextured(lightingShader, levels[0].VAO, getIndexCount(), texture, texture, this->shininess, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), model);
+    }
+
+    // the same at the level the node's size on screen calls for
+    void queueCubicCurvedWall(RenderQueue& queue, Shader& lightingShader, unsigned int texture, const glm::mat4& model, LodState& lod) const
+    {
+        if (patches.uploaded())
+        {
+            patches.queue(queue, texture, texture, this->shininess, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), model);
+            return;
+        }
+        const LodLevel& level = levels[LodSelector::shared().select(bounds.transformed(model), lod)];
+        queue.addTextured(lightingShader, level.VAO, level.indexCount, texture, texture, this->shininess, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), model);
+    }
+
+    // the box of the vertex positions, before any model matrix
+    Bounds localBounds() const
+    {
+        return bounds;
+    }
+
+    // the wall is solid, so its own triangles serve as an occluder
+    const OccluderMesh* occluder() const
+    {
+        return &occluderMesh;
+    }
+
+    // cuts the arc again so its faces stray at most tolerance from it, in the wall's own units;
+    // between frames, as the old meshes are released and the occluder is rebuilt in place
+    void setTolerance(float tolerance)
+    {
+        for (int level = 0; level < LOD_LEVELS; level++)
+            levels[level].release();
+        this->tolerance = tolerance;
+        tessellate();
+    }
+
+    float getTolerance() const
+    {
+        return tolerance;
     }
 
 private:
-    void buildCoordinatesAndIndices()
+    // the arc has the same curvature all along, so equal steps are already the fewest; the outer
+    // face is the wider one and sets their number. Coarse levels first, so the vectors are left
+    // holding the full one. When the GPU cuts the wall only the full one is built, for the box
+    // and the occluder, and nothing is uploaded
+    void tessellate()
+    {
+        bool patched = patches.uploaded();
+        for (int level = patched ? 0 : LOD_LEVELS - 1; level >= 0; level--)
+        {
+            buildCoordinatesAndIndices(chordSegments(std::max(outerRadius, innerRadius), angle, lodTolerance(tolerance, level), CURVED_WALL_MIN_SEGMENTS));
+            buildVertices();
+            if (!patched)
+                levels[level].upload(vertices, indices, verticesStride / sizeof(float));
+        }
+        bounds = Bounds::fromVertices(vertices.data(), vertices.size() / 8, 8);
+        occluderMesh = OccluderMesh::fromVertices(vertices.data(), vertices.size() / 8, 8, indices.data(), indices.size());
+    }
+
+    // only the corners, for the GPU to cut: every face is a straight profile, swept round the arc
+    // for the four long faces and across from the inner to the outer edge for the two ends. The
+    // profiles run so that each face's normal points out of the wall
+    void buildPatches()
     {
-        float thetaStep = angle / segmentCount;
+        float halfHeight = height / 2.0f;
+        float outerDown[] = { outerRadius, halfHeight, 0.0f, outerRadius, -halfHeight, 0.0f };
+        float outerUp[] = { outerRadius, -halfHeight, 0.0f, outerRadius, halfHeight, 0.0f };
+        float innerDown[] = { innerRadius, halfHeight, 0.0f, innerRadius, -halfHeight, 0.0f };
+        float innerUp[] = { innerRadius, -halfHeight, 0.0f, innerRadius, halfHeight, 0.0f };
+        float top[] = { innerRadius, halfHeight, 0.0f, outerRadius, halfHeight, 0.0f };
+        float bottom[] = { outerRadius, -halfHeight, 0.0f, innerRadius, -halfHeight, 0.0f };
+        int outerDownFirst = patches.addProfile(BezierEvaluator(outerDown, 1));
+        int outerUpFirst = patches.addProfile(BezierEvaluator(outerUp, 1));
+        int innerDownFirst = patches.addProfile(BezierEvaluator(innerDown, 1));
+        int innerUpFirst = patches.addProfile(BezierEvaluator(innerUp, 1));
+        int topFirst = patches.addProfile(BezierEvaluator(top, 1));
+        int bottomFirst = patches.addProfile(BezierEvaluator(bottom, 1));
+
+        // profile, texture v at its start and at its end
+        const float faces[4][3] = {
+            { (float)outerDownFirst, 1.0f, 0.0f },
+            { (float)innerUpFirst, 0.0f, 1.0f },
+            { (float)topFirst, 0.0f, 1.0f },
+            { (float)bottomFirst, 0.0f, 1.0f }
+        };
+        for (int face = 0; face < 4; face++)
+            for (int sector = 0; sector < CURVED_WALL_PATCH_SECTORS; sector++)
+            {
+                float u0 = (float)sector / CURVED_WALL_PATCH_SECTORS, u1 = (float)(sector + 1) / CURVED_WALL_PATCH_SECTORS;
+                SurfacePatch patch = { angle * u0, angle * u1, u0, u1, faces[face][0], faces[face][0], 2.0f, 0.0f,
+                    0.0f, 1.0f, faces[face][1], faces[face][2] };
+                patches.addPatch(patch);
+            }
+        SurfacePatch startEnd = { 0.0f, 0.0f, 0.0f, 1.0f, (float)innerDownFirst, (float)outerDownFirst, 2.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f };
+        SurfacePatch finishEnd = { angle, angle, 0.0f, 1.0f, (float)innerUpFirst, (float)outerUpFirst, 2.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f };
+        patches.addPatch(startEnd);
+        patches.addPatch(finishEnd);
+        patches.upload();
+    }
+
+    void buildCoordinatesAndIndices(int segments)
+    {
+        coordinates.clear();
+        normals.clear();
+        texCoords.clear();
+        indices.clear();
+
+        float thetaStep = angle / segments;
         float halfHeight = height / 2.0f;
 
         // Outer and inner wall vertices
-        for (int i = 0; i <= segmentCount; ++i)
+        for (int i = 0; i <= segments; ++i)
         {
             float theta = i * thetaStep;
 
@@ -147,7 +242,7 @@ private:
             normals.push_back(cosf(theta));
             normals.push_back(0.0f);
             normals.push_back(sinf(theta));
-            texCoords.push_back((float)i / segmentCount);
+            texCoords.push_back((float)i / segments);
             texCoords.push_back(0.0f);
 
             // Top vertex (outer)
@@ -157,7 +252,7 @@ private:
             normals.push_back(cosf(theta));
             normals.push_back(0.0f);
             normals.push_back(sinf(theta));
-            texCoords.push_back((float)i / segmentCount);
+            texCoords.push_back((float)i / segments);
             texCoords.push_back(1.0f);
 
             // Inner wall
@@ -171,7 +266,7 @@ private:
             normals.push_back(-cosf(theta));
             normals.push_back(0.0f);
             normals.push_back(-sinf(theta));
-            texCoords.push_back((float)i / segmentCount);
+            texCoords.push_back((float)i / segments);
             texCoords.push_back(0.0f);
 
             // Top vertex (inner)
@@ -181,12 +276,12 @@ private:
             normals.push_back(-cosf(theta));
             normals.push_back(0.0f);
             normals.push_back(-sinf(theta));
-            texCoords.push_back((float)i / segmentCount);
+            texCoords.push_back((float)i / segments);
             texCoords.push_back(1.0f);
         }
 
         // Create indices for the outer and inner walls
-        for (int i = 0; i < segmentCount; ++i)
+        for (int i = 0; i < segments; ++i)
         {
             int k1 = i * 4; // Outer bottom-left
             int k2 = k1 + 1; // Outer top-left
@@ -210,7 +305,7 @@ private:
             indices.push_back(k3);
 
             // Connect inner and outer walls at the sides (caps)
-            if (i == 0 || i == segmentCount - 1)
+            if (i == 0 || i == segments - 1)
             {
                 // Left cap
                 indices.push_back(k1);
@@ -233,7 +328,7 @@ private:
         }
 
         // Top and bottom caps
-        for (int i = 0; i < segmentCount; ++i)
+        for (int i = 0; i < segments; ++i)
         {
             int k1 = i * 4;     // Outer bottom-left
             int k2 = k1 + 4;   // Outer bottom-right
@@ -277,13 +372,16 @@ private:
 
 private:
     float outerRadius, innerRadius, height, angle;
-    int segmentCount;
+    float tolerance;
     std::vector<float> coordinates;
     std::vector<float> normals;
     std::vector<float> texCoords;
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
-    unsigned int wallVAO;
+    OccluderMesh occluderMesh;
+    LodLevel levels[LOD_LEVELS];
+    PatchSurface patches;  // uploaded instead of levels when the TessellationPath is enabled
+    Bounds bounds;
     int verticesStride;
 };
 
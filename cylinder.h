@@ -14,11 +14,28 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "shader.h"
+#include "meshCache.h"
+#include "renderQueue.h"
+#include "materialTable.h"
+#include "lod.h"
+#include "revolve.h"
 
 # define PI 3.1416
 
+// a far-away cylinder still keeps this many sides
+#define CYLINDER_MIN_LOD_SECTORS 6
+
 using namespace std;
 
+// the line from the bottom rim to the top rim, swept round and closed with a cap at each end
+inline void revolveCylinder(float radius, float height, int sectors, RevolvedMesh& mesh, int flags)
+{
+    revolve([radius, height](int i) {
+        ProfilePoint point = { radius, i == 0 ? -height / 2.0f : height / 2.0f, 1.0f, 0.0f, (float)i };
+        return point;
+    }, 2, RevolveSweep::full(sectors), mesh, flags | REVOLVE_CAP_FIRST | REVOLVE_CAP_LAST);
+}
+
 class Cylinder
 {
 public:
@@ -36,48 +53,28 @@ public:
         : verticesStride(32) // Updated stride for position, normal, and texture coordinates
     {
         set(radius, height, sectorCount, amb, diff, spec, shiny);
-        buildCoordinatesAndIndices();
-        buildVertices();
-
-        glGenVertexArrays(1, &cylinderVAO);
-        glBindVertexArray(cylinderVAO);
-
-        // Create VBO for vertex data
-        unsigned int cylinderVBO;
-        glGenBuffers(1, &cylinderVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, cylinderVBO);
-        glBufferData(GL_ARRAY_BUFFER,
-            this->getVertexSize(),
-            this->getVertices(),
-            GL_STATIC_DRAW);
-
-        // Create EBO for index data
-        unsigned int cylinderEBO;
-        glGenBuffers(1, &cylinderEBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cylinderEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-            this->getIndexSize(),
-            this->getIndices(),
-            GL_STATIC_DRAW);
-
-        // Activate attribute arrays
-        glEnableVertexAttribArray(0); // Position
-        glEnableVertexAttribArray(1); // Normal
-        glEnableVertexAttribArray(2); // Texture coordinates
-
-        // Set attribute pointers
-        int stride = this->getVerticesStride();
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);                        // Position
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 3));      // Normal
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 6));      // Texture
-
-        // Unbind VAO and buffers
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        // cylinders of the same shape share their meshes, so only the first one is tessellated;
+        // the coarse levels are built first so the vectors are left holding the full one
+        for (int level = LOD_LEVELS - 1; level >= 0; level--)
+        {
+            int sectors = lodSegments(this->sectorCount, level, CYLINDER_MIN_LOD_SECTORS);
+            string key = MeshCache::key("Cylinder", this->radius, this->height, (float)sectors);
+            levels[level] = MeshCache::shared().acquire(key);
+            if (levels[level] == NULL)
+            {
+                build(sectors, REVOLVE_TEXCOORDS);
+                levels[level] = MeshCache::shared().create(key, this->getVertices(), this->getVertexSize(), this->getVerticesStride() / sizeof(float),
+                    this->getIndices(), this->getIndexSize());
+            }
+        }
+        mesh = levels[0];
     }
 
-    ~Cylinder() {}
+    ~Cylinder()
+    {
+        for (int level = 0; level < LOD_LEVELS; level++)
+            MeshCache::shared().release(levels[level]);
+    }
 
     // Setters
     void set(float radius, float height, int sectors, glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny)
@@ -95,171 +92,77 @@ public:
     }
 
     // Getters
-    unsigned int getVertexCount() const { return (unsigned int)coordinates.size() / 3; }
-    unsigned int getVertexSize() const { return (unsigned int)vertices.size() * sizeof(float); }
+    unsigned int getVertexCount() const { return (unsigned int)geometry.vertexCount(); }
+    unsigned int getVertexSize() const { return (unsigned int)geometry.vertices.size() * sizeof(float); }
     int getVerticesStride() const { return verticesStride; }
-    const float* getVertices() const { return vertices.data(); }
-    unsigned int getIndexSize() const { return (unsigned int)indices.size() * sizeof(unsigned int); }
-    const unsigned int* getIndices() const { return indices.data(); }
-    unsigned int getIndexCount() const { return (unsigned int)indices.size(); }
+    const float* getVertices() const { return geometry.vertices.data(); }
+    unsigned int getIndexSize() const { return (unsigned int)geometry.indices.size() * sizeof(unsigned int); }
+    const unsigned int* getIndices() const { return geometry.indices.data(); }
+    unsigned int getIndexCount() const { return (unsigned int)mesh->indexCount; }  // indices stay empty when the mesh came from the cache
+    const string& meshKey(int level = 0) const { return levels[level]->key; }  // for drawing the cylinder instanced
+    vector<string> meshKeys() const  // every level, for an instanced batch with levels of detail
+    {
+        vector<string> keys;
+        for (int level = 0; level < LOD_LEVELS; level++)
+            keys.push_back(levels[level]->key);
+        return keys;
+    }
 
     // Draw the cylinder
     void drawCylinder(Shader& lightingShader, unsigned int texture, glm::mat4 model) const
     {
         lightingShader.use();
-
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
         lightingShader.setFloat("material.shininess", this->shininess);
 
+        lightingShader.setVec4("textureRange", glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
         lightingShader.setMat4("model", model);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, texture);
 
-        glBindVertexArray(cylinderVAO);
+        bindVertexArray(mesh->texturedVAO);
         glDrawElements(GL_TRIANGLES, this->getIndexCount(), GL_UNSIGNED_INT, (void*)0);
-        glBindVertexArray(0);
     }
 
-private:
-    // Build geometry
-    void buildCoordinatesAndIndices()
+    // single-texture meshes use their map for the specular unit as well, as the textured cubes do
+    void queueCylinder(RenderQueue& queue, Shader& lightingShader, unsigned int texture, const glm::mat4& model) const
     {
-        float x, z; // Vertex position
-        float nx, nz; // Vertex normal
-        float sectorStep = 2 * PI / sectorCount;
-        float sectorAngle;
-
-        // Generate coordinates, normals, and texture coordinates
-        for (int i = 0; i <= sectorCount; ++i)
-        {
-            sectorAngle = i * sectorStep;
-
-            x = radius * cosf(sectorAngle);
-            z = radius * sinf(sectorAngle);
-
-            // Bottom circle vertex
-            coordinates.push_back(x);
-            coordinates.push_back(-height / 2.0f);
-            coordinates.push_back(z);
-
-            // Top circle vertex
-            coordinates.push_back(x);
-            coordinates.push_back(height / 2.0f);
-            coordinates.push_back(z);
-
-            // Normals (pointing outwards)
-            nx = cosf(sectorAngle);
-            nz = sinf(sectorAngle);
-            normals.push_back(nx);
-            normals.push_back(0.0f);
-            normals.push_back(nz);
-            normals.push_back(nx);
-            normals.push_back(0.0f);
-            normals.push_back(nz);
-
-            // Texture coordinates
-            float u = (float)i / sectorCount; // Horizontal wrapping
-            texCoords.push_back(u);
-            texCoords.push_back(0.0f); // Bottom
-            texCoords.push_back(u);
-            texCoords.push_back(1.0f); // Top
-        }
-
-        // Center point for bottom and top circles
-        coordinates.push_back(0.0f); // Bottom center
-        coordinates.push_back(-height / 2.0f);
-        coordinates.push_back(0.0f);
-
-        coordinates.push_back(0.0f); // Top center
-        coordinates.push_back(height / 2.0f);
-        coordinates.push_back(0.0f);
-
-        normals.push_back(0.0f); // Bottom center normal
-        normals.push_back(-1.0f);
-        normals.push_back(0.0f);
-
-        normals.push_back(0.0f); // Top center normal
-        normals.push_back(1.0f);
-        normals.push_back(0.0f);
-
-        texCoords.push_back(0.5f); // Bottom center texture coordinates
-        texCoords.push_back(0.5f);
-
-        texCoords.push_back(0.5f); // Top center texture coordinates
-        texCoords.push_back(0.5f);
-
-        // Indices for the side surface
-        for (int i = 0; i < sectorCount; ++i)
-        {
-            int k1 = i * 2;     // Bottom vertex index
-            int k2 = k1 + 1;    // Top vertex index
-
-            // Two triangles per sector
-            indices.push_back(k1);
-            indices.push_back(k2);
-            indices.push_back(k1 + 2);
-
-            indices.push_back(k2);
-            indices.push_back(k2 + 2);
-            indices.push_back(k1 + 2);
-        }
-
-        // Indices for the bottom circle
-        int bottomCenterIndex = (int)coordinates.size() / 3 - 2; // Index of the bottom center
-        for (int i = 0; i < sectorCount; ++i)
-        {
-            int k1 = i * 2;     // Bottom vertex index
-            int k2 = (i + 1) * 2; // Next bottom vertex index
-
-            indices.push_back(bottomCenterIndex);
-            indices.push_back(k1);
-            indices.push_back(k2);
-        }
-
-        // Indices for the top circle
-        int topCenterIndex = (int)coordinates.size() / 3 - 1; // Index of the top center
-        for (int i = 0; i < sectorCount; ++i)
-        {
-            int k1 = i * 2 + 1;     // Top vertex index
-            int k2 = (i + 1) * 2 + 1; // Next top vertex index
-
-            indices.push_back(topCenterIndex);
-            indices.push_back(k2);
-            indices.push_back(k1);
-        }
+        queue.addTextured(lightingShader, mesh->texturedVAO, this->getIndexCount(), texture, texture, this->shininess,
+            glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), model);
     }
 
+    // the same at the level the node's size on screen calls for
+    void queueCylinder(RenderQueue& queue, Shader& lightingShader, unsigned int texture, const glm::mat4& model, LodState& lod) const
+    {
+        const SharedMesh* level = levels[selectLevel(model, lod)];
+        queue.addTextured(lightingShader, level->texturedVAO, level->indexCount, texture, texture, this->shininess,
+            glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), model);
+    }
 
-    void buildVertices()
+    // for callers that draw the levels themselves, e.g. one instanced batch per level
+    int selectLevel(const glm::mat4& model, LodState& lod) const
     {
-        for (size_t i = 0, j = 0; i < coordinates.size(); i += 3, j += 2)
-        {
-            vertices.push_back(coordinates[i]);
-            vertices.push_back(coordinates[i + 1]);
-            vertices.push_back(coordinates[i + 2]);
+        return LodSelector::shared().select(mesh->bounds.transformed(model), lod);
+    }
 
-            vertices.push_back(normals[i]);
-            vertices.push_back(normals[i + 1]);
-            vertices.push_back(normals[i + 2]);
+    // the box of the mesh before any model matrix
+    Bounds localBounds() const
+    {
+        return mesh->bounds;
+    }
 
-            vertices.push_back(texCoords[j]);
-            vertices.push_back(texCoords[j + 1]);
-        }
+private:
+    void build(int sectors, int flags)
+    {
+        revolveCylinder(radius, height, sectors, geometry, flags);
     }
 
     // Member variables
-    unsigned int cylinderVAO;
+    SharedMesh* mesh = NULL;  // levels[0]
+    SharedMesh* levels[LOD_LEVELS] = { NULL };
     float radius;
     float height;
     int sectorCount; // Longitude, # of slices
-    vector<float> vertices;
-    vector<float> normals;
-    vector<unsigned int> indices;
-    vector<float> texCoords; // Texture coordinates
-    vector<float> coordinates;
+    RevolvedMesh geometry;  // the last level built, the full one once the constructor is done
     int verticesStride; // 32 bytes for position, normal, and texture coordinates
 };
 
@@ -271,6 +174,7 @@ public:
     glm::vec3 diffuse;
     glm::vec3 specular;
     float shininess;
+    int materialIndex = 0;  // row in MaterialTable
 
     // Constructor
     CylinderNoTex(float radius = 1.0f, float height = 2.0f, int sectorCount = 18,
@@ -281,46 +185,21 @@ public:
         : verticesStride(24) // Updated stride for position and normal
     {
         set(radius, height, sectorCount, amb, diff, spec, shiny);
-        buildCoordinatesAndIndices();
-        buildVertices();
-
-        glGenVertexArrays(1, &cylinderVAO);
-        glBindVertexArray(cylinderVAO);
-
-        // Create VBO for vertex data
-        unsigned int cylinderVBO;
-        glGenBuffers(1, &cylinderVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, cylinderVBO);
-        glBufferData(GL_ARRAY_BUFFER,
-            this->getVertexSize(),
-            this->getVertices(),
-            GL_STATIC_DRAW);
-
-        // Create EBO for index data
-        unsigned int cylinderEBO;
-        glGenBuffers(1, &cylinderEBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cylinderEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-            this->getIndexSize(),
-            this->getIndices(),
-            GL_STATIC_DRAW);
-
-        // Activate attribute arrays
-        glEnableVertexAttribArray(0); // Position
-        glEnableVertexAttribArray(1); // Normal
-
-        // Set attribute pointers
-        int stride = this->getVerticesStride();
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);                        // Position
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 3));      // Normal
-
-        // Unbind VAO and buffers
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        // cylinders of the same shape share one mesh, so only the first one is tessellated
+        string key = MeshCache::key("CylinderNoTex", this->radius, this->height, (float)this->sectorCount);
+        mesh = MeshCache::shared().acquire(key);
+        if (mesh == NULL)
+        {
+            build(this->sectorCount, 0);
+            mesh = MeshCache::shared().create(key, this->getVertices(), this->getVertexSize(), this->getVerticesStride() / sizeof(float),
+                this->getIndices(), this->getIndexSize());
+        }
     }
 
-    ~CylinderNoTex() {}
+    ~CylinderNoTex()
+    {
+        MeshCache::shared().release(mesh);
+    }
 
     // Setters
     void set(float radius, float height, int sectors, glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny)
@@ -335,136 +214,54 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
     }
 
     // Getters
-    unsigned int getVertexCount() const { return (unsigned int)coordinates.size() / 3; }
-    unsigned int getVertexSize() const { return (unsigned int)vertices.size() * sizeof(float); }
+    unsigned int getVertexCount() const { return (unsigned int)geometry.vertexCount(); }
+    unsigned int getVertexSize() const { return (unsigned int)geometry.vertices.size() * sizeof(float); }
     int getVerticesStride() const { return verticesStride; }
-    const float* getVertices() const { return vertices.data(); }
-    unsigned int getIndexSize() const { return (unsigned int)indices.size() * sizeof(unsigned int); }
-    const unsigned int* getIndices() const { return indices.data(); }
-    unsigned int getIndexCount() const { return (unsigned int)indices.size(); }
+    const float* getVertices() const { return geometry.vertices.data(); }
+    unsigned int getIndexSize() const { return (unsigned int)geometry.indices.size() * sizeof(unsigned int); }
+    const unsigned int* getIndices() const { return geometry.indices.data(); }
+    unsigned int getIndexCount() const { return (unsigned int)mesh->indexCount; }  // indices stay empty when the mesh came from the cache
 
     // Draw the cylinder
     void drawCylinderNoTex(Shader& lightingShader, glm::mat4 model) const
     {
         lightingShader.use();
 
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
-        lightingShader.setFloat("material.shininess", this->shininess);
+        lightingShader.setInt("materialIndex", this->materialIndex);
 
         lightingShader.setMat4("model", model);
 
-        glBindVertexArray(cylinderVAO);
+        bindVertexArray(mesh->litVAO);
         glDrawElements(GL_TRIANGLES, this->getIndexCount(), GL_UNSIGNED_INT, (void*)0);
-        glBindVertexArray(0);
     }
 
-private:
-    // Build geometry
-    void buildCoordinatesAndIndices()
+    void queueCylinderNoTex(RenderQueue& queue, Shader& lightingShader, const glm::mat4& model) const
     {
-        float x, z; // Vertex position
-        float nx, nz; // Vertex normal
-        float sectorStep = 2 * PI / sectorCount;
-        float sectorAngle;
-
-        // Generate coordinates and normals
-        for (int i = 0; i <= sectorCount; ++i)
-        {
-            sectorAngle = i * sectorStep;
-
-            x = radius * cosf(sectorAngle);
-            z = radius * sinf(sectorAngle);
-
-            // Bottom circle vertex
-            coordinates.push_back(x);
-            coordinates.push_back(-height / 2.0f);
-            coordinates.push_back(z);
-
-            // Top circle vertex
-            coordinates.push_back(x);
-            coordinates.push_back(height / 2.0f);
-            coordinates.push_back(z);
-
-            // Normals (pointing outwards)
-            nx = cosf(sectorAngle);
-            nz = sinf(sectorAngle);
-            normals.push_back(nx);
-            normals.push_back(0.0f);
-            normals.push_back(nz);
-            normals.push_back(nx);
-            normals.push_back(0.0f);
-            normals.push_back(nz);
-        }
-
-        // Indices for the side surface
-        for (int i = 0; i < sectorCount; ++i)
-        {
-            int k1 = i * 2;     // Bottom vertex index
-            int k2 = k1 + 1;    // Top vertex index
-
-            // Two triangles per sector
-            indices.push_back(k1);
-            indices.push_back(k2);
-            indices.push_back(k1 + 2);
-
-            indices.push_back(k2);
-            indices.push_back(k2 + 2);
-            indices.push_back(k1 + 2);
-        }
-
-        // Indices for the bottom circle
-        int bottomCenterIndex = (int)coordinates.size() / 3 - 2; // Index of the bottom center
-        for (int i = 0; i < sectorCount; ++i)
-        {
-            int k1 = i * 2;     // Bottom vertex index
-            int k2 = (i + 1) * 2; // Next bottom vertex index
-
-            indices.push_back(bottomCenterIndex);
-            indices.push_back(k1);
-            indices.push_back(k2);
-        }
-
-        // Indices for the top circle
-        int topCenterIndex = (int)coordinates.size() / 3 - 1; // Index of the top center
-        for (int i = 0; i < sectorCount; ++i)
-        {
-            int k1 = i * 2 + 1;     // Top vertex index
-            int k2 = (i + 1) * 2 + 1; // Next top vertex index
-
-            indices.push_back(topCenterIndex);
-            indices.push_back(k2);
-            indices.push_back(k1);
-        }
+        queue.addLit(lightingShader, mesh->litVAO, this->getIndexCount(), this->materialIndex, model);
     }
 
-    void buildVertices()
+    // the box of the mesh before any model matrix
+    Bounds localBounds() const
     {
-        for (size_t i = 0; i < coordinates.size(); i += 3)
-        {
-            vertices.push_back(coordinates[i]);
-            vertices.push_back(coordinates[i + 1]);
-            vertices.push_back(coordinates[i + 2]);
+        return mesh->bounds;
+    }
 
-            vertices.push_back(normals[i]);
-            vertices.push_back(normals[i + 1]);
-            vertices.push_back(normals[i + 2]);
-        }
+private:
+    void build(int sectors, int flags)
+    {
+        revolveCylinder(radius, height, sectors, geometry, flags);
     }
 
     // Member variables
-    unsigned int cylinderVAO;
+    SharedMesh* mesh = NULL;
     float radius;
     float height;
     int sectorCount; // Longitude, # of slices
-    vector<float> vertices;
-    vector<float> normals;
-    vector<unsigned int> indices;
-    vector<float> coordinates;
+    RevolvedMesh geometry;
     int verticesStride; // 24 bytes for position and normal
 };
 
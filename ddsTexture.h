@@ -0,0 +1,411 @@
+//
+//  ddsTexture.h
+//  test
+//
+//  Block-compressed textures with their mip chain built ahead of time.
+//
+//      Auditorium --build-textures
+//
+//  decodes every texture the scene file names, box-filters the full mip
+//  chain, compresses each level to BC1 (no alpha) or BC3 (with alpha) and
+//  writes it next to the source as <image>.dds. At run time the TextureLoader
+//  memory-maps that file and uploads the levels as they are; nothing is
+//  decoded and no mipmaps are generated. A .dds whose source has since
+//  changed size or modification time is ignored and the image is loaded the
+//  old way until the textures are built again.
+//
+//  Rows are stored bottom-up, the way the loader flips the images for GL.
+//  BC1 takes half a byte per pixel and BC3 one, against the four a driver
+//  keeps for RGB8 or RGBA8.
+//
+
+#ifndef ddsTexture_h
+#define ddsTexture_h
+
+#include <glad/glad.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "stb_image.h"
+#include "mappedFile.h"
+
+// from EXT_texture_compression_s3tc, which the GL 3.3 headers may leave out
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+#define DDS_MAGIC 0x20534444           // "DDS "
+#define DDS_FOURCC_DXT1 0x31545844     // "DXT1"
+#define DDS_FOURCC_DXT5 0x35545844     // "DXT5"
+#define DDS_SOURCE_TAG 0x54445541      // "AUDT", marks the source stamp in the reserved words
+#define DDS_MAX_LEVELS 16
+
+struct DDSPixelFormat {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t fourCC;
+    uint32_t rgbBitCount;
+    uint32_t rMask, gMask, bMask, aMask;
+};
+
+// the standard 124-byte header; reserved[0..3] carry the tag and the size and time of the source image
+struct DDSHeader {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t linearSize;
+    uint32_t depth;
+    uint32_t mipMapCount;
+    uint32_t reserved[11];
+    DDSPixelFormat format;
+    uint32_t caps, caps2, caps3, caps4;
+    uint32_t reserved2;
+};
+
+static_assert(sizeof(DDSHeader) == 124, "DDSHeader must match the file layout");
+
+// where each level of a mapped .dds lies, relative to the first one
+struct DDSLevels {
+    GLenum format = 0;
+    int width = 0, height = 0;
+    int levels = 0;
+    size_t offset[DDS_MAX_LEVELS];
+    size_t size[DDS_MAX_LEVELS];
+    size_t payloadBytes = 0;
+    const unsigned char* payload = NULL;  // points into the mapping
+};
+
+inline size_t ddsBlockBytes(GLenum format)
+{
+    return format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 8 : 16;
+}
+
+inline size_t ddsLevelSize(GLenum format, int width, int height)
+{
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * ddsBlockBytes(format);
+}
+
+inline std::string ddsPathFor(const std::string& source)
+{
+    return source + ".dds";
+}
+
+// size and modification time of the source; false when it cannot be read
+inline bool ddsSourceStamp(const std::string& source, long long& size, long long& time)
+{
+    struct stat info;
+    if (stat(source.c_str(), &info) != 0)
+        return false;
+    size = (long long)info.st_size;
+    time = (long long)info.st_mtime;
+    return true;
+}
+
+// maps source + ".dds" and checks it was built from the source as it is now
+inline bool openDDS(const std::string& source, MappedFile& file, DDSLevels& levels)
+{
+    long long sourceSize, sourceTime;
+    if (!ddsSourceStamp(source, sourceSize, sourceTime) || !file.open(ddsPathFor(source)))
+        return false;
+    if (file.size() < 4 + sizeof(DDSHeader) || *(const uint32_t*)file.data() != DDS_MAGIC)
+    {
+        file.close();
+        return false;
+    }
+
+    DDSHeader header;
+    memcpy(&header, file.data() + 4, sizeof(header));
+    bool fresh = header.reserved[0] == DDS_SOURCE_TAG && header.reserved[1] == (uint32_t)sourceSize
+        && header.reserved[2] == (uint32_t)sourceTime && header.reserved[3] == (uint32_t)((unsigned long long)sourceTime >> 32);
+    if (header.format.fourCC == DDS_FOURCC_DXT1)
+        levels.format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    else if (header.format.fourCC == DDS_FOURCC_DXT5)
+        levels.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    else
+        fresh = false;
+    if (!fresh || header.mipMapCount == 0 || header.mipMapCount > DDS_MAX_LEVELS)
+    {
+        file.close();
+        return false;
+    }
+
+    levels.width = (int)header.width;
+    levels.height = (int)header.height;
+    levels.levels = (int)header.mipMapCount;
+    levels.payload = file.data() + 4 + sizeof(DDSHeader);
+    levels.payloadBytes = 0;
+    int width = levels.width, height = levels.height;
+    for (int i = 0; i < levels.levels; i++)
+    {
+        levels.offset[i] = levels.payloadBytes;
+        levels.size[i] = ddsLevelSize(levels.format, width, height);
+        levels.payloadBytes += levels.size[i];
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    if (4 + sizeof(DDSHeader) + levels.payloadBytes > file.size())
+    {
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// building: mip chain and BC1/BC3 block compression
+// ---------------------------------------------------------------------------
+
+// the next level of an RGBA8 image, each texel the average of up to four
+inline std::vector<unsigned char> halveRGBA(const std::vector<unsigned char>& image, int width, int height)
+{
+    int w = std::max(1, width / 2), h = std::max(1, height / 2);
+    std::vector<unsigned char> result((size_t)w * h * 4);
+    for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+        {
+            int x0 = std::min(2 * x, width - 1), x1 = std::min(2 * x + 1, width - 1);
+            int y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+            for (int c = 0; c < 4; c++)
+            {
+                int sum = image[((size_t)y0 * width + x0) * 4 + c] + image[((size_t)y0 * width + x1) * 4 + c]
+                    + image[((size_t)y1 * width + x0) * 4 + c] + image[((size_t)y1 * width + x1) * 4 + c];
+                result[((size_t)y * w + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    return result;
+}
+
+inline uint16_t packRGB565(const unsigned char* c)
+{
+    return (uint16_t)(((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3));
+}
+
+inline void unpackRGB565(uint16_t v, int* c)
+{
+    c[0] = ((v >> 11) & 31) * 255 / 31;
+    c[1] = ((v >> 5) & 63) * 255 / 63;
+    c[2] = (v & 31) * 255 / 31;
+}
+
+// the bounding box of the block's colors, inset a little and turned to the diagonal the colors follow
+// (J.M.P. van Waveren, "Real-Time DXT Compression"); every texel then takes the closest of the four palette entries
+inline void compressColorBlock(const unsigned char block[16][4], unsigned char* out)
+{
+    int lo[3] = { 255, 255, 255 }, hi[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; i++)
+        for (int c = 0; c < 3; c++)
+        {
+            lo[c] = std::min(lo[c], (int)block[i][c]);
+            hi[c] = std::max(hi[c], (int)block[i][c]);
+        }
+
+    int center[3], covariance[2] = { 0, 0 };
+    for (int c = 0; c < 3; c++)
+        center[c] = (lo[c] + hi[c]) / 2;
+    for (int i = 0; i < 16; i++)
+    {
+        int b = block[i][2] - center[2];
+        covariance[0] += (block[i][0] - center[0]) * b;
+        covariance[1] += (block[i][1] - center[1]) * b;
+    }
+    for (int c = 0; c < 2; c++)
+        if (covariance[c] < 0)
+            std::swap(lo[c], hi[c]);
+
+    unsigned char ends[2][3];
+    for (int c = 0; c < 3; c++)
+    {
+        int inset = (hi[c] - lo[c]) / 16;
+        ends[0][c] = (unsigned char)std::min(255, std::max(0, hi[c] - inset));
+        ends[1][c] = (unsigned char)std::min(255, std::max(0, lo[c] + inset));
+    }
+
+    uint16_t c0 = packRGB565(ends[0]), c1 = packRGB565(ends[1]);
+    if (c0 < c1)
+        std::swap(c0, c1);  // c0 > c1 selects the four-color mode
+    out[0] = (unsigned char)(c0 & 0xFF);
+    out[1] = (unsigned char)(c0 >> 8);
+    out[2] = (unsigned char)(c1 & 0xFF);
+    out[3] = (unsigned char)(c1 >> 8);
+
+    uint32_t indices = 0;
+    if (c0 != c1)
+    {
+        int palette[4][3];
+        unpackRGB565(c0, palette[0]);
+        unpackRGB565(c1, palette[1]);
+        for (int c = 0; c < 3; c++)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; i++)
+        {
+            int best = 0, bestDistance = 1 << 30;
+            for (int p = 0; p < 4; p++)
+            {
+                int distance = 0;
+                for (int c = 0; c < 3; c++)
+                    distance += (block[i][c] - palette[p][c]) * (block[i][c] - palette[p][c]);
+                if (distance < bestDistance)
+                {
+                    best = p;
+                    bestDistance = distance;
+                }
+            }
+            indices |= (uint32_t)best << (2 * i);
+        }
+    }
+    for (int i = 0; i < 4; i++)
+        out[4 + i] = (unsigned char)(indices >> (8 * i));
+}
+
+// the eight-value alpha block of BC3, its ends the lowest and highest alpha
+inline void compressAlphaBlock(const unsigned char block[16][4], unsigned char* out)
+{
+    int lo = 255, hi = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        lo = std::min(lo, (int)block[i][3]);
+        hi = std::max(hi, (int)block[i][3]);
+    }
+    out[0] = (unsigned char)hi;
+    out[1] = (unsigned char)lo;
+
+    uint64_t indices = 0;
+    if (hi != lo)
+    {
+        int palette[8] = { hi, lo };
+        for (int p = 1; p < 7; p++)
+            palette[p + 1] = ((7 - p) * hi + p * lo) / 7;
+        for (int i = 0; i < 16; i++)
+        {
+            int best = 0, bestDistance = 1 << 30;
+            for (int p = 0; p < 8; p++)
+            {
+                int distance = std::abs(block[i][3] - palette[p]);
+                if (distance < bestDistance)
+                {
+                    best = p;
+                    bestDistance = distance;
+                }
+            }
+            indices |= (uint64_t)best << (3 * i);
+        }
+    }
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = (unsigned char)(indices >> (8 * i));
+}
+
+inline void compressLevel(const std::vector<unsigned char>& image, int width, int height, bool alpha, std::vector<unsigned char>& out)
+{
+    for (int by = 0; by < height; by += 4)
+        for (int bx = 0; bx < width; bx += 4)
+        {
+            // edge blocks repeat the last row and column
+            unsigned char block[16][4];
+            for (int y = 0; y < 4; y++)
+                for (int x = 0; x < 4; x++)
+                    memcpy(block[y * 4 + x], &image[((size_t)std::min(by + y, height - 1) * width + std::min(bx + x, width - 1)) * 4], 4);
+
+            size_t at = out.size();
+            out.resize(at + (alpha ? 16 : 8));
+            if (alpha)
+            {
+                compressAlphaBlock(block, &out[at]);
+                compressColorBlock(block, &out[at + 8]);
+            }
+            else
+                compressColorBlock(block, &out[at]);
+        }
+}
+
+// writes source + ".dds"; false when the source cannot be decoded or the file not written
+inline bool buildDDS(const std::string& source)
+{
+    long long sourceSize, sourceTime;
+    int width, height, components;
+    stbi_set_flip_vertically_on_load(true);
+    unsigned char* pixels = ddsSourceStamp(source, sourceSize, sourceTime) ? stbi_load(source.c_str(), &width, &height, &components, 4) : NULL;
+    if (pixels == NULL)
+    {
+        std::cout << "Texture failed to load at path: " << source << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> image(pixels, pixels + (size_t)width * height * 4);
+    stbi_image_free(pixels);
+
+    bool alpha = components == 4 || components == 2;
+    GLenum format = alpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    std::vector<unsigned char> payload;
+    int levels = 0, w = width, h = height;
+    for (;;)
+    {
+        compressLevel(image, w, h, alpha, payload);
+        levels++;
+        if ((w == 1 && h == 1) || levels == DDS_MAX_LEVELS)
+            break;
+        image = halveRGBA(image, w, h);
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+
+    DDSHeader header;
+    memset(&header, 0, sizeof(header));
+    header.size = sizeof(DDSHeader);
+    header.flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;  // caps, height, width, pixel format, mip count, linear size
+    header.height = (uint32_t)height;
+    header.width = (uint32_t)width;
+    header.linearSize = (uint32_t)ddsLevelSize(format, width, height);
+    header.mipMapCount = (uint32_t)levels;
+    header.reserved[0] = DDS_SOURCE_TAG;
+    header.reserved[1] = (uint32_t)sourceSize;
+    header.reserved[2] = (uint32_t)sourceTime;
+    header.reserved[3] = (uint32_t)((unsigned long long)sourceTime >> 32);
+    header.format.size = sizeof(DDSPixelFormat);
+    header.format.flags = 0x4;  // fourCC
+    header.format.fourCC = alpha ? DDS_FOURCC_DXT5 : DDS_FOURCC_DXT1;
+    header.caps = 0x1000 | 0x400000 | 0x8;  // texture, mipmap, complex
+
+    std::string path = ddsPathFor(source);
+    FILE* file = fopen(path.c_str(), "wb");
+    uint32_t magic = DDS_MAGIC;
+    bool written = file != NULL && fwrite(&magic, 4, 1, file) == 1 && fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(&payload[0], payload.size(), 1, file) == 1;
+    if (file != NULL)
+        written = fclose(file) == 0 && written;
+    if (!written)
+    {
+        std::cout << "Could not write " << path << std::endl;
+        return false;
+    }
+    std::cout << path << ": " << width << "x" << height << " " << (alpha ? "BC3" : "BC1") << ", " << levels << " levels, "
+        << payload.size() << " bytes" << std::endl;
+    return true;
+}
+
+// whether the driver takes the S3TC formats; desktop GL 3.3 drivers all list the extension
+inline bool ddsSupported()
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        const char* name = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (name != NULL && strcmp(name, "GL_EXT_texture_compression_s3tc") == 0)
+            return true;
+    }
+    return false;
+}
+
+#endif /* ddsTexture_h */
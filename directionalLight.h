@@ -12,12 +12,25 @@
 #include <glm/glm.hpp>
 #include "shader.h"
 
+// directionalLight in the std140 LightBlock
+struct DirectionLightStd140 {
+    glm::vec3 direction;
+    float padding0;
+    glm::vec3 ambient;
+    float padding1;
+    glm::vec3 diffuse;
+    float padding2;
+    glm::vec3 specular;
+    float padding3;
+};
+
 class DirectionLight {
 public:
     glm::vec3 direction;
     glm::vec3 ambient;
     glm::vec3 diffuse;
     glm::vec3 specular;
+    bool dirty = true;  // set whenever the light changes; the light block re-uploads it and clears this
 
     DirectionLight(float dirX, float dirY, float dirZ, float ambR, float ambG, float ambB, float diffR, float diffG, float diffB, float specR, float specG, float specB) {
 
@@ -26,51 +39,58 @@ public:
         diffuse = glm::vec3(diffR, diffG, diffB);
         specular = glm::vec3(specR, specG, specB);
     }
-    void setUpDirectionLight(Shader& lightingShader)
+    // writes the light as the shader sees it, with the on/off switches applied
+    void writeStd140(DirectionLightStd140& block) const
     {
-        lightingShader.use();
-
-        lightingShader.setVec3("dirLight.direction", direction);
-        lightingShader.setVec3("dirLight.ambient", ambientOn * ambient);
-        lightingShader.setVec3("dirLight.diffuse", diffuseOn * diffuse);
-        lightingShader.setVec3("dirLight.specular", specularOn * specular);
-
+        block.direction = direction;
+        block.ambient = ambientOn * ambient;
+        block.diffuse = diffuseOn * diffuse;
+        block.specular = specularOn * specular;
+        block.padding0 = block.padding1 = block.padding2 = block.padding3 = 0.0f;
     }
     void turnOff()
     {
         ambientOn = 0.0;
         diffuseOn = 0.0;
         specularOn = 0.0;
+        dirty = true;
     }
     void turnOn()
     {
         ambientOn = 1.0;
         diffuseOn = 1.0;
         specularOn = 1.0;
+        dirty = true;
     }
     void turnAmbientOn()
     {
         ambientOn = 1.0;
+        dirty = true;
     }
     void turnAmbientOff()
     {
         ambientOn = 0.0;
+        dirty = true;
     }
     void turnDiffuseOn()
     {
         diffuseOn = 1.0;
+        dirty = true;
     }
     void turnDiffuseOff()
     {
         diffuseOn = 0.0;
+        dirty = true;
     }
     void turnSpecularOn()
     {
         specularOn = 1.0;
+        dirty = true;
     }
     void turnSpecularOff()
     {
         specularOn = 0.0;
+        dirty = true;
     }
 private:
     float ambientOn = 1.0;
@@ -0,0 +1,447 @@
+//
+//  forest.h
+//  test
+//
+//  The trees of the grounds, thousands of them, drawn without any work per
+//  tree on the CPU. Every tree is the same fractal (see fractal.h), turned,
+//  scaled and tinted by its own SceneTree record; the records are uploaded
+//  once, as they come out of the scene file, to be read per instance. Near
+//  the eye a tree is its branches, thin quads on two crossed planes. Farther
+//  away it is a single quad turned to the eye and cut out by the silhouette
+//  of the same branches, rasterized once at startup.
+//
+//  The trees are sorted into a grid of cells. Per frame only the cells are
+//  culled, and each visible cell joins the branch draw, the impostor draw
+//  or both, depending on how far its nearest and farthest trees can be.
+//  Neighbouring cells lie next to each other in the instance buffer, so
+//  they are drawn together. The vertex shader tests each tree's own distance
+//  and drops it from the draw it does not belong to, so a tree straddling
+//  the switch is always in exactly one of them.
+//
+
+#ifndef forest_h
+#define forest_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "shader.h"
+#include "glResources.h"
+#include "glState.h"
+#include "bounds.h"
+#include "portals.h"
+#include "occlusion.h"
+#include "sceneFile.h"
+#include "fractal.h"
+
+// the fractal every tree is grown from, with a trunk of length 1
+#define FOREST_TREE_DEPTH 7
+#define FOREST_BRANCH_ANGLE 30.0f
+// width of a branch of length 1; thinner branches narrow with the square root of their length
+#define FOREST_TRUNK_WIDTH 0.12f
+// side of a grid cell on the ground
+#define FOREST_CELL_SIZE 8.0f
+// trees farther than this from the eye, along the ground, are drawn as impostors
+#define FOREST_IMPOSTOR_DISTANCE 24.0f
+// texels along each side of the silhouette
+#define FOREST_SILHOUETTE_TEXELS 256
+// coverage a silhouette texel needs to be drawn; fragmentShaderForest.fs tests the same
+#define FOREST_COVERAGE_CUTOFF 0.5f
+// per-instance attributes, after the position
+#define FOREST_PLACEMENT_LOCATION 3
+#define FOREST_LOOK_LOCATION 4
+
+class Forest {
+public:
+    glm::vec3 color;                   // of every tree, before its own tint
+    unsigned int cellsNear = 0;        // cells in the branch draw, of the last draw()
+    unsigned int cellsFar = 0;         // cells in the impostor draw
+    unsigned int drawsIssued = 0;      // instanced draws, one per run of neighbouring cells
+
+    Forest(const SceneTree* records, size_t count, glm::vec3 color = glm::vec3(0.22f, 1.0f, 0.078f)) : color(color)
+    {
+        std::vector<float> segments(fractalTreeSegments(FOREST_TREE_DEPTH) * 6);
+        generateFractalTree(segments.data(), 1.0f, FOREST_BRANCH_ANGLE, FOREST_TREE_DEPTH);
+
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+        buildBranches(segments, vertices, indices);
+        branchIndexCount = (GLsizei)indices.size();
+        bakeSilhouette(segments);
+
+        // the quad the silhouette was drawn into, in the plane facing +z
+        float quad[] = {
+            box.x, box.y, 0.0f,
+            box.z, box.y, 0.0f,
+            box.x, box.w, 0.0f,
+            box.z, box.w, 0.0f
+        };
+        unsigned int quadIndices[] = { 0, 1, 2, 2, 1, 3 };
+
+        genBuffers(1, &instanceVBO);
+        sortIntoCells(records, count);
+        branchVAO = createVAO(vertices.data(), vertices.size() * sizeof(float), indices.data(), indices.size() * sizeof(unsigned int), branchVBO, branchEBO);
+        impostorVAO = createVAO(quad, sizeof(quad), quadIndices, sizeof(quadIndices), impostorVBO, impostorEBO);
+    }
+
+    Forest(const Forest&) = delete;
+    Forest& operator=(const Forest&) = delete;
+
+    ~Forest()
+    {
+        deleteVertexArrays(1, &branchVAO);
+        deleteVertexArrays(1, &impostorVAO);
+        deleteBuffers(1, &branchVBO);
+        deleteBuffers(1, &branchEBO);
+        deleteBuffers(1, &impostorVBO);
+        deleteBuffers(1, &impostorEBO);
+        deleteBuffers(1, &instanceVBO);
+        forgetTexture(silhouette);
+        glDeleteTextures(1, &silhouette);
+    }
+
+    size_t treeCount() const
+    {
+        return trees;
+    }
+
+    size_t cellCount() const
+    {
+        return cells.size();
+    }
+
+    // triangles of one tree drawn with its branches
+    unsigned int branchTriangles() const
+    {
+        return (unsigned int)branchIndexCount / 3;
+    }
+
+    // resolves the uniforms of the forest program once and sets the ones that never change
+    void bindTo(Shader& forestShader)
+    {
+        shader = &forestShader;
+        uniforms.projection = shader->getUniformHandle("projection");
+        uniforms.view = shader->getUniformHandle("view");
+        uniforms.viewPos = shader->getUniformHandle("viewPos");
+        uniforms.color = shader->getUniformHandle("color");
+        uniforms.impostors = shader->getUniformHandle("impostors");
+        shader->use();
+        shader->setFloat(shader->getUniformHandle("impostorDistance"), FOREST_IMPOSTOR_DISTANCE);
+        shader->setVec4(shader->getUniformHandle("silhouetteBox"), box);
+        shader->setInt(shader->getUniformHandle("silhouette"), 0);
+    }
+
+    // once per frame, after the portals are updated and the occluders rasterized for it; needs bindTo()
+    void draw(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& eye, const Frustum& frustum,
+        const CellPortals& portals, OcclusionCuller& occlusion)
+    {
+        cellsNear = cellsFar = drawsIssued = 0;
+        nearRuns.clear();
+        farRuns.clear();
+        if (shader == NULL || cells.empty() || !portals.cellVisible(CELL_EXTERIOR))
+            return;
+
+        for (size_t i = 0; i < cells.size(); i++)
+        {
+            const Cell& cell = cells[i];
+            if (!frustum.visible(cell.bounds) || !portals.visible(CELL_EXTERIOR, cell.bounds) || occlusion.occluded(cell.bounds))
+                continue;
+            // along the ground, as the vertex shader measures it, from the nearest and the farthest corner
+            glm::vec2 eyeGround(eye.x, eye.z);
+            glm::vec2 lo(cell.bounds.min.x, cell.bounds.min.z), hi(cell.bounds.max.x, cell.bounds.max.z);
+            float nearest = glm::length(glm::clamp(eyeGround, lo, hi) - eyeGround);
+            float farthest = glm::length(glm::max(glm::abs(eyeGround - lo), glm::abs(hi - eyeGround)));
+            if (nearest <= FOREST_IMPOSTOR_DISTANCE)
+            {
+                addToRuns(nearRuns, cell);
+                cellsNear++;
+            }
+            if (farthest > FOREST_IMPOSTOR_DISTANCE)
+            {
+                addToRuns(farRuns, cell);
+                cellsFar++;
+            }
+        }
+        if (nearRuns.empty() && farRuns.empty())
+            return;
+
+        shader->use();
+        shader->setMat4(uniforms.projection, projection);
+        shader->setMat4(uniforms.view, view);
+        shader->setVec3(uniforms.viewPos, eye);
+        shader->setVec3(uniforms.color, color);
+
+        shader->setBool(uniforms.impostors, false);
+        drawRuns(branchVAO, branchIndexCount, nearRuns);
+        if (!farRuns.empty())
+        {
+            shader->setBool(uniforms.impostors, true);
+            bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, silhouette);
+            drawRuns(impostorVAO, 6, farRuns);
+        }
+    }
+
+private:
+    struct Cell {
+        Bounds bounds;     // around every tree in it
+        GLint first;       // its trees in the instance buffer
+        GLsizei count;
+    };
+
+    struct Run {
+        GLint first;
+        GLsizei count;
+    };
+
+    // the uniforms draw() sets every frame
+    struct ForestUniforms {
+        UniformHandle projection, view, viewPos, color, impostors;
+    };
+
+    Shader* shader = NULL;
+    ForestUniforms uniforms;
+    std::vector<Cell> cells;
+    std::vector<Run> nearRuns, farRuns;
+    size_t trees = 0;
+    glm::vec4 box;                     // min x y, max x y of the silhouette in the tree's units
+    unsigned int branchVAO = 0, branchVBO = 0, branchEBO = 0;
+    unsigned int impostorVAO = 0, impostorVBO = 0, impostorEBO = 0;
+    unsigned int instanceVBO = 0, silhouette = 0;
+    GLsizei branchIndexCount = 0;
+
+    static float branchHalfWidth(float length)
+    {
+        return 0.5f * FOREST_TRUNK_WIDTH * sqrtf(length);
+    }
+
+    // a quad along every segment in the z = 0 plane, then the same quads turned into the x = 0 plane;
+    // box is left around the first plane
+    void buildBranches(const std::vector<float>& segments, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+    {
+        size_t segmentCount = segments.size() / 6;
+        vertices.reserve(segmentCount * 2 * 4 * 3);
+        indices.reserve(segmentCount * 2 * 6);
+        Bounds outline;
+        for (int plane = 0; plane < 2; plane++)
+        {
+            for (size_t i = 0; i < segmentCount; i++)
+            {
+                glm::vec2 start(segments[i * 6], segments[i * 6 + 1]), end(segments[i * 6 + 3], segments[i * 6 + 4]);
+                float length = glm::length(end - start);
+                glm::vec2 side = glm::vec2(start.y - end.y, end.x - start.x) * (branchHalfWidth(length) / length);
+                glm::vec2 corners[4] = { start - side, start + side, end - side, end + side };
+                unsigned int base = (unsigned int)(vertices.size() / 3);
+                for (int c = 0; c < 4; c++)
+                {
+                    vertices.push_back(plane == 0 ? corners[c].x : 0.0f);
+                    vertices.push_back(corners[c].y);
+                    vertices.push_back(plane == 0 ? 0.0f : corners[c].x);
+                    outline.add(glm::vec3(corners[c], 0.0f));
+                }
+                unsigned int quad[6] = { base, base + 1, base + 2, base + 2, base + 1, base + 3 };
+                indices.insert(indices.end(), quad, quad + 6);
+            }
+        }
+        // square, so the silhouette's texels are square too, centered on the trunk's side to side
+        float side = std::max(outline.max.x - outline.min.x, outline.max.y - outline.min.y);
+        float centerX = (outline.min.x + outline.max.x) * 0.5f;
+        box = glm::vec4(centerX - side * 0.5f, outline.min.y, centerX + side * 0.5f, outline.min.y + side);
+    }
+
+    // how much of each texel the branches cover, from its center's distance to the nearest one; the
+    // smaller levels are averaged down and then scaled so the cutoff keeps as much of each as of the
+    // first, or the far trees would thin out to bare twigs
+    void bakeSilhouette(const std::vector<float>& segments)
+    {
+        int size = FOREST_SILHOUETTE_TEXELS;
+        float texelsPerUnit = size / (box.z - box.x);
+        std::vector<float> coverage((size_t)size * size, 0.0f);
+        for (size_t i = 0; i < segments.size() / 6; i++)
+        {
+            glm::vec2 start = (glm::vec2(segments[i * 6], segments[i * 6 + 1]) - glm::vec2(box.x, box.y)) * texelsPerUnit;
+            glm::vec2 end = (glm::vec2(segments[i * 6 + 3], segments[i * 6 + 4]) - glm::vec2(box.x, box.y)) * texelsPerUnit;
+            float halfWidth = branchHalfWidth(glm::length(end - start) / texelsPerUnit) * texelsPerUnit;
+            glm::vec2 lo = glm::min(start, end) - glm::vec2(halfWidth + 1.0f), hi = glm::max(start, end) + glm::vec2(halfWidth + 1.0f);
+            glm::vec2 along = end - start;
+            float lengthSquared = glm::dot(along, along);
+            for (int y = std::max(0, (int)lo.y); y <= std::min(size - 1, (int)hi.y); y++)
+            {
+                for (int x = std::max(0, (int)lo.x); x <= std::min(size - 1, (int)hi.x); x++)
+                {
+                    glm::vec2 p(x + 0.5f, y + 0.5f);
+                    float f = glm::clamp(glm::dot(p - start, along) / lengthSquared, 0.0f, 1.0f);
+                    float covered = glm::clamp(halfWidth + 0.5f - glm::length(p - (start + along * f)), 0.0f, 1.0f);
+                    float& texel = coverage[(size_t)y * size + x];
+                    texel = std::max(texel, covered);
+                }
+            }
+        }
+
+        float kept = keptAbove(coverage, 1.0f);
+        glGenTextures(1, &silhouette);
+        bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, silhouette);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (int level = 0; ; level++)
+        {
+            // the scale that keeps the same share of texels at or above the cutoff
+            float low = 0.0f, high = 8.0f;
+            for (int step = 0; level > 0 && step < 16; step++)
+            {
+                float middle = (low + high) * 0.5f;
+                if (keptAbove(coverage, middle) < kept)
+                    low = middle;
+                else
+                    high = middle;
+            }
+            float scale = level > 0 ? high : 1.0f;
+            std::vector<unsigned char> texels(coverage.size());
+            for (size_t i = 0; i < coverage.size(); i++)
+                texels[i] = (unsigned char)(std::min(coverage[i] * scale, 1.0f) * 255.0f + 0.5f);
+            glTexImage2D(GL_TEXTURE_2D, level, GL_R8, size, size, 0, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+            if (size == 1)
+                break;
+
+            int half = size / 2;
+            std::vector<float> smaller((size_t)half * half);
+            for (int y = 0; y < half; y++)
+                for (int x = 0; x < half; x++)
+                    smaller[(size_t)y * half + x] = 0.25f * (coverage[(size_t)(2 * y) * size + 2 * x] + coverage[(size_t)(2 * y) * size + 2 * x + 1]
+                        + coverage[(size_t)(2 * y + 1) * size + 2 * x] + coverage[(size_t)(2 * y + 1) * size + 2 * x + 1]);
+            coverage.swap(smaller);
+            size = half;
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    // the share of texels that pass the cutoff once scaled
+    static float keptAbove(const std::vector<float>& coverage, float scale)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < coverage.size(); i++)
+            if (coverage[i] * scale >= FOREST_COVERAGE_CUTOFF)
+                kept++;
+        return (float)kept / (float)coverage.size();
+    }
+
+    // the records in cell order, one cell after the other along x then z, and a box per cell
+    void sortIntoCells(const SceneTree* records, size_t count)
+    {
+        trees = count;
+        if (count == 0)
+            return;
+        glm::vec2 lo(FLT_MAX), hi(-FLT_MAX);
+        for (size_t i = 0; i < count; i++)
+        {
+            lo = glm::min(lo, glm::vec2(records[i].placement.x, records[i].placement.z));
+            hi = glm::max(hi, glm::vec2(records[i].placement.x, records[i].placement.z));
+        }
+        int columns = (int)((hi.x - lo.x) / FOREST_CELL_SIZE) + 1;
+        int rows = (int)((hi.y - lo.y) / FOREST_CELL_SIZE) + 1;
+
+        std::vector<int> cellOf(count);
+        std::vector<GLint> start((size_t)columns * rows + 1, 0);
+        for (size_t i = 0; i < count; i++)
+        {
+            int column = std::min(columns - 1, (int)((records[i].placement.x - lo.x) / FOREST_CELL_SIZE));
+            int row = std::min(rows - 1, (int)((records[i].placement.z - lo.y) / FOREST_CELL_SIZE));
+            cellOf[i] = row * columns + column;
+            start[cellOf[i] + 1]++;
+        }
+        for (size_t c = 1; c < start.size(); c++)
+            start[c] += start[c - 1];
+
+        // a tree's box reaches as far from its trunk as the silhouette, whichever way it is turned
+        float reach = std::max(fabsf(box.x), fabsf(box.z));
+        std::vector<SceneTree> sorted(count);
+        std::vector<GLint> next(start.begin(), start.end() - 1);
+        std::vector<Bounds> boxes((size_t)columns * rows);
+        for (size_t i = 0; i < count; i++)
+        {
+            const SceneTree& tree = records[i];
+            sorted[next[cellOf[i]]++] = tree;
+            glm::vec3 foot(tree.placement);
+            float scale = tree.look.x;
+            boxes[cellOf[i]].add(Bounds(foot + glm::vec3(-reach, box.y, -reach) * scale, foot + glm::vec3(reach, box.w, reach) * scale));
+        }
+        for (size_t c = 0; c < boxes.size(); c++)
+        {
+            if (start[c + 1] == start[c])
+                continue;
+            Cell cell = { boxes[c], start[c], start[c + 1] - start[c] };
+            cells.push_back(cell);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, sorted.size() * sizeof(SceneTree), sorted.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // positions at location 0, the tree records per instance after them
+    unsigned int createVAO(const void* vertices, size_t vertexBytes, const void* indices, size_t indexBytes, unsigned int& VBO, unsigned int& EBO)
+    {
+        unsigned int VAO = 0;
+        genVertexArrays(1, &VAO);
+        bindVertexArray(VAO);
+        genBuffers(1, &VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertices, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        genBuffers(1, &EBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, indices, GL_STATIC_DRAW);
+
+        glEnableVertexAttribArray(FOREST_PLACEMENT_LOCATION);
+        glEnableVertexAttribArray(FOREST_LOOK_LOCATION);
+        glVertexAttribDivisor(FOREST_PLACEMENT_LOCATION, 1);
+        glVertexAttribDivisor(FOREST_LOOK_LOCATION, 1);
+        pointInstancesAt(0);
+        bindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return VAO;
+    }
+
+    // without a base instance in 3.3, a run starts where the bound VAO's instance attributes point
+    void pointInstancesAt(GLint first) const
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        size_t offset = (size_t)first * sizeof(SceneTree);
+        glVertexAttribPointer(FOREST_PLACEMENT_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(SceneTree), (void*)(offset + offsetof(SceneTree, placement)));
+        glVertexAttribPointer(FOREST_LOOK_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(SceneTree), (void*)(offset + offsetof(SceneTree, look)));
+    }
+
+    static void addToRuns(std::vector<Run>& runs, const Cell& cell)
+    {
+        if (!runs.empty() && runs.back().first + runs.back().count == cell.first)
+            runs.back().count += cell.count;
+        else
+        {
+            Run run = { cell.first, cell.count };
+            runs.push_back(run);
+        }
+    }
+
+    void drawRuns(unsigned int VAO, GLsizei indexCount, const std::vector<Run>& runs)
+    {
+        if (runs.empty())
+            return;
+        bindVertexArray(VAO);
+        for (size_t i = 0; i < runs.size(); i++)
+        {
+            pointInstancesAt(runs[i].first);
+            glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, runs[i].count);
+            drawsIssued++;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+};
+
+#endif /* forest_h */
@@ -2,102 +2,133 @@
 #define FRACTAL_TREE_H
 
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <thread>
 #include <vector>
-#include "Shader.h"
 
-class FractalTree {
-public:
-    glm::vec3 branchColor; // Color of the branches
-    float branchWidth;     // Width of the branches
-
-    FractalTree(float branchLength = 1.0f, float branchAngle = 30.0f, int recursionDepth = 10,
-        glm::vec3 color = glm::vec3(0.22f, 1.0f, 0.078f), float width = 5.0f)
-    {
-        this->branchLength = branchLength;
-        this->branchAngle = branchAngle;
-        this->recursionDepth = recursionDepth;
-        this->branchColor = color;
-        this->branchWidth = width;
-
-        buildTree();
-
-        // Generate VAO and VBO for rendering
-        glGenVertexArrays(1, &treeVAO);
-        glBindVertexArray(treeVAO);
-
-        glGenBuffers(1, &treeVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, treeVBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-        // Enable vertex attribute for position
-        glEnableVertexAttribArray(0); // Position
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+// The tree is written without recursion into a buffer sized for exactly 2^depth - 1 segments.
+// Branches go in preorder: a branch, then the whole subtree of its left child, then that of its
+// right one, so the subtree of a branch at level L is the 2^(depth - L) - 1 segments from its own.
+// A branch is as long as its level says and points where its count of left turns minus right
+// turns says, both looked up in tables made once per tree, so no branch rotates anything and the
+// directions carry no error from the levels above. Large trees are cut at a level and the
+// subtrees below it are written by several threads at once, each into its own part of the buffer.
+
+// deepest tree the generator keeps a stack for; 2^24 - 1 segments are already 400 MB of vertices
+#define FRACTAL_MAX_DEPTH 24
+// each branch is this long against its parent
+#define FRACTAL_BRANCH_SCALE 0.7f
+// trees with fewer segments are generated on the calling thread
+#define FRACTAL_PARALLEL_SEGMENTS (1 << 16)
+// at most 2^this subtrees are handed out to the threads
+#define FRACTAL_MAX_CUT_LEVEL 8
+
+// segments of a tree depth levels deep: one trunk, doubling per level
+inline size_t fractalTreeSegments(int depth)
+{
+    return depth > 0 ? ((size_t)1 << depth) - 1 : 0;
+}
+
+// a branch still to be written: where it starts, its level, how many more left turns than right
+// ones lead to it, and its segment's index in the buffer
+struct FractalBranch {
+    glm::vec2 start;
+    int level;
+    int turns;
+    size_t index;
+};
 
-        // Unbind VAO and VBO
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-    }
+struct FractalTables {
+    int depth;
+    float lengths[FRACTAL_MAX_DEPTH];                 // per level
+    glm::vec2 directions[2 * FRACTAL_MAX_DEPTH + 1];  // per turns + depth: straight up, turned that many times
 
-    ~FractalTree() {
-        glDeleteVertexArrays(1, &treeVAO);
-        glDeleteBuffers(1, &treeVBO);
+    FractalTables(float length, float angleDegrees, int depth) : depth(depth)
+    {
+        for (int level = 0; level < depth; level++)
+        {
+            lengths[level] = length;
+            length *= FRACTAL_BRANCH_SCALE;
+        }
+        double angle = angleDegrees * 3.14159265358979323846 / 180.0;
+        for (int turns = -depth; turns <= depth; turns++)
+            directions[turns + depth] = glm::vec2((float)-sin(turns * angle), (float)cos(turns * angle));
     }
 
-    void drawTree(Shader& shader, glm::mat4 model) const {
-        shader.use();
-        shader.setVec3("color", branchColor);
-        shader.setMat4("model", model);
-
-        // Set line width for branches
-        glLineWidth(branchWidth);
-
-        glBindVertexArray(treeVAO);
-        glDrawArrays(GL_LINES, 0, vertices.size() / 3);
-        glBindVertexArray(0);
-
-        // Reset line width to default for other drawings
-        glLineWidth(1.0f);
+    // writes branch and its subtree, 6 floats (two x y z points) per segment; a branch at cutLevel is
+    // left out with its subtree and added to cut instead, for another call to write
+    void fill(float* vertices, FractalBranch branch, int cutLevel, FractalBranch* cut, int* cutCount) const
+    {
+        FractalBranch pending[FRACTAL_MAX_DEPTH];  // right children whose left sibling is being written
+        int top = 0;
+        for (;;)
+        {
+            if (branch.level == cutLevel)
+                cut[(*cutCount)++] = branch;
+            else
+            {
+                glm::vec2 end = branch.start + directions[branch.turns + depth] * lengths[branch.level];
+                float* v = vertices + branch.index * 6;
+                v[0] = branch.start.x;
+                v[1] = branch.start.y;
+                v[2] = 0.0f;
+                v[3] = end.x;
+                v[4] = end.y;
+                v[5] = 0.0f;
+                if (branch.level + 1 < depth)
+                {
+                    FractalBranch right = { end, branch.level + 1, branch.turns - 1, branch.index + ((size_t)1 << (depth - branch.level - 1)) };
+                    FractalBranch left = { end, branch.level + 1, branch.turns + 1, branch.index + 1 };
+                    pending[top++] = right;
+                    branch = left;
+                    continue;
+                }
+            }
+            if (top == 0)
+                return;
+            branch = pending[--top];
+        }
     }
+};
 
-private:
-    unsigned int treeVAO, treeVBO;
-    float branchLength;    // Length of the branches
-    float branchAngle;     // Angle between branches
-    int recursionDepth;    // Maximum depth of recursion
-    std::vector<float> vertices; // Stores the tree's vertices
-
-    void buildTree() {
-        glm::vec3 start(0.0f, 0.0f, 0.0f); // Start at origin
-        glm::vec3 direction(0.0f, branchLength, 0.0f); // Initial upward direction
-        generateBranches(start, direction, recursionDepth);
+// fills vertices, which must hold fractalTreeSegments(depth) * 6 floats, with the tree in the z = 0
+// plane growing up from the origin; threads 0 uses every core once the tree is large enough
+inline void generateFractalTree(float* vertices, float length, float angleDegrees, int depth, int threads = 0)
+{
+    if (depth <= 0)
+        return;
+    FractalTables tables(length, angleDegrees, std::min(depth, FRACTAL_MAX_DEPTH));
+    FractalBranch trunk = { glm::vec2(0.0f), 0, 0, 0 };
+    if (threads <= 0)
+        threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 1 || fractalTreeSegments(tables.depth) < FRACTAL_PARALLEL_SEGMENTS)
+    {
+        tables.fill(vertices, trunk, -1, NULL, NULL);
+        return;
     }
 
-    void generateBranches(const glm::vec3& start, const glm::vec3& direction, int depth) {
-        if (depth == 0) return;
-
-        // Compute the end point of the branch
-        glm::vec3 end = start + direction;
-
-        // Add the branch to the vertices list
-        vertices.push_back(start.x);
-        vertices.push_back(start.y);
-        vertices.push_back(start.z);
-        vertices.push_back(end.x);
-        vertices.push_back(end.y);
-        vertices.push_back(end.z);
-
-        // Compute new branch directions
-        float angleRadians = glm::radians(branchAngle);
-        glm::mat4 rotationLeft = glm::rotate(glm::mat4(1.0f), angleRadians, glm::vec3(0.0f, 0.0f, 1.0f));
-        glm::mat4 rotationRight = glm::rotate(glm::mat4(1.0f), -angleRadians, glm::vec3(0.0f, 0.0f, 1.0f));
-
-        glm::vec3 leftDirection = glm::vec3(rotationLeft * glm::vec4(direction * 0.7f, 0.0f));
-        glm::vec3 rightDirection = glm::vec3(rotationRight * glm::vec4(direction * 0.7f, 0.0f));
-
-        // Recursively generate branches
-        generateBranches(end, leftDirection, depth - 1);
-        generateBranches(end, rightDirection, depth - 1);
-    }
-};
+    // the levels above the cut here, then a few subtrees per thread so they finish together
+    int cutLevel = 1;
+    while ((1 << cutLevel) < threads * 4 && cutLevel < FRACTAL_MAX_CUT_LEVEL && cutLevel + 1 < tables.depth)
+        cutLevel++;
+    FractalBranch subtrees[1 << FRACTAL_MAX_CUT_LEVEL];
+    int subtreeCount = 0;
+    tables.fill(vertices, trunk, cutLevel, subtrees, &subtreeCount);
+
+    threads = std::min(threads, subtreeCount);
+    auto work = [&tables, vertices, &subtrees, subtreeCount, threads](int first) {
+        for (int i = first; i < subtreeCount; i += threads)
+            tables.fill(vertices, subtrees[i], -1, NULL, NULL);
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (int t = 1; t < threads; t++)
+        workers.push_back(std::thread(work, t));
+    work(0);
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+}
 
 #endif // FRACTAL_TREE_H
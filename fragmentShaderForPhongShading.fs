@@ -8,78 +8,90 @@ struct Material {
     float shininess;
 };
 
+// light structs are laid out so every vec3 shares a 16-byte slot with a float (std140),
+// matching PointLightStd140 / SpotLightStd140 / DirectionLightStd140 on the C++ side
 struct DirectionalLight {
     vec3 direction;
     vec3 ambient;
     vec3 diffuse;
     vec3 specular;
-    bool on;
 };
 
 struct PointLight {
     vec3 position;
-    
     float k_c;  // attenuation factors
-    float k_l;  // attenuation factors
-    float k_q;  // attenuation factors
-    
     vec3 ambient;
+    float k_l;  // attenuation factors
     vec3 diffuse;
+    float k_q;  // attenuation factors
     vec3 specular;
+    float radius;  // beyond this the light is culled
 };
 
 struct SpotLight {
     vec3 position;
-    vec3 direction;
-    float inner_circle;
-    float outer_circle;
-    
     float k_c;  // attenuation factors
+    vec3 direction;
     float k_l;  // attenuation factors
-    float k_q;  // attenuation factors
-    
     vec3 ambient;
+    float k_q;  // attenuation factors
     vec3 diffuse;
+    float inner_circle;
     vec3 specular;
+    float outer_circle;
 };
 
 
 
-#define NR_POINT_LIGHTS 64
 #define NR_SPOT_LIGHTS 5
 
 in vec3 FragPos;
 in vec3 Normal;
 
 uniform vec3 viewPos;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform SpotLight spotLights[NR_SPOT_LIGHTS];
-uniform Material material;
 
-uniform DirectionalLight directionalLight;
-uniform bool directionalLightON = true;
+// untextured materials come from one table shared by every draw, see materialTable.h
+uniform samplerBuffer materialData;  // three texels per material: ambient + shininess, diffuse, specular
+uniform int materialIndex;
+
+// shared by every lighting program, see lightBlock.h
+layout (std140) uniform LightBlock {
+    SpotLight spotLights[NR_SPOT_LIGHTS];
+    DirectionalLight directionalLight;
+    ivec4 clusterCount;    // tiles in x, tiles in y, depth slices
+    vec4 clusterDepth;     // near, far, slice scale, slice bias
+    vec4 clusterTileSize;  // tile size in pixels
+};
 
+// point lights are binned on the CPU into tiles x depth slices, see lightClusters.h
+uniform samplerBuffer pointLightData;  // four texels per light, in PointLight order
+uniform usamplerBuffer lightGrid;      // per cluster: first entry in lightIndices, light count
+uniform usamplerBuffer lightIndices;
 
 // function prototypes
 vec3 CalcPointLight(Material material, PointLight light, vec3 N, vec3 fragPos, vec3 V);
 vec3 CalcDirectionalLight(Material material, DirectionalLight light, vec3 N, vec3 V);
 vec3 CalcSpotLight(Material material, SpotLight light, vec3 N, vec3 fragPos, vec3 V);
+PointLight FetchPointLight(int index);
+Material FetchMaterial(int index);
+int ClusterIndex();
 
 void main()
 {
     // properties
+    Material material = FetchMaterial(materialIndex);
     vec3 N = normalize(Normal);
     vec3 V = normalize(viewPos - FragPos);
     
-    vec3 result;
+    vec3 result = vec3(0.0);
     // point lights
-    for(int i = 0; i < NR_POINT_LIGHTS; i++){
-        result += CalcPointLight(material, pointLights[i], N, FragPos, V);
+    uvec2 cluster = texelFetch(lightGrid, ClusterIndex()).rg;
+    for(uint i = 0u; i < cluster.y; i++){
+        int lightIndex = int(texelFetch(lightIndices, int(cluster.x + i)).r);
+        result += CalcPointLight(material, FetchPointLight(lightIndex), N, FragPos, V);
     }
     // directional light
-    if(directionalLightON){
-        result += CalcDirectionalLight(material, directionalLight, N, V);
-    }
+    result += CalcDirectionalLight(material, directionalLight, N, V);
     for(int i = 0; i < NR_SPOT_LIGHTS; i++){
         result += CalcSpotLight(material, spotLights[i], N, FragPos, V);
     }
@@ -100,6 +112,8 @@ vec3 CalcPointLight(Material material, PointLight light, vec3 N, vec3 fragPos, v
     // attenuation
     float d = length(light.position - fragPos);
     float attenuation = 1.0 / (light.k_c + light.k_l * d + light.k_q * (d * d));
+    // fade out over the last tenth of the culling radius so the cut is not visible
+    attenuation *= 1.0 - smoothstep(0.9 * light.radius, light.radius, d);
     
     vec3 ambient = K_A * light.ambient;
     vec3 diffuse = K_D * max(dot(N, L), 0.0) * light.diffuse;
@@ -157,3 +171,47 @@ vec3 CalcSpotLight(Material material, SpotLight light, vec3 N, vec3 fragPos, vec
     
     return (ambient + diffuse + specular);
 }
+
+PointLight FetchPointLight(int index)
+{
+    vec4 t0 = texelFetch(pointLightData, index * 4);
+    vec4 t1 = texelFetch(pointLightData, index * 4 + 1);
+    vec4 t2 = texelFetch(pointLightData, index * 4 + 2);
+    vec4 t3 = texelFetch(pointLightData, index * 4 + 3);
+
+    PointLight light;
+    light.position = t0.xyz;
+    light.k_c = t0.w;
+    light.ambient = t1.xyz;
+    light.k_l = t1.w;
+    light.diffuse = t2.xyz;
+    light.k_q = t2.w;
+    light.specular = t3.xyz;
+    light.radius = t3.w;
+    return light;
+}
+
+Material FetchMaterial(int index)
+{
+    vec4 t0 = texelFetch(materialData, index * 3);
+
+    Material material;
+    material.ambient = t0.xyz;
+    material.shininess = t0.w;
+    material.diffuse = texelFetch(materialData, index * 3 + 1).xyz;
+    material.specular = texelFetch(materialData, index * 3 + 2).xyz;
+    return material;
+}
+
+// cluster of this fragment: screen tile from gl_FragCoord, slice from the linearised depth
+int ClusterIndex()
+{
+    float zNear = clusterDepth.x;
+    float zFar = clusterDepth.y;
+    float ndcDepth = gl_FragCoord.z * 2.0 - 1.0;
+    float viewDepth = 2.0 * zNear * zFar / (zFar + zNear - ndcDepth * (zFar - zNear));
+
+    int slice = clamp(int(floor(log(viewDepth) * clusterDepth.z - clusterDepth.w)), 0, clusterCount.z - 1);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / clusterTileSize.xy), ivec2(0), clusterCount.xy - 1);
+    return (slice * clusterCount.y + tile.y) * clusterCount.x + tile.x;
+}
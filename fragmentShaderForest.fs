@@ -0,0 +1,17 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 TreeColor;
+in vec2 SilhouetteCoords;
+
+uniform sampler2D silhouette;  // how much of each texel the branches cover, see Forest::bakeSilhouette()
+uniform bool impostors;
+
+#define COVERAGE_CUTOFF 0.5    // FOREST_COVERAGE_CUTOFF
+
+void main()
+{
+    if (impostors && texture(silhouette, SilhouetteCoords).r < COVERAGE_CUTOFF)
+        discard;
+    FragColor = vec4(TreeColor, 1.0);
+}
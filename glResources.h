@@ -0,0 +1,59 @@
+//
+//  glResources.h
+//  test
+//
+//  Counted wrappers around glGen*/glDelete* for buffers and vertex arrays.
+//  Every mesh goes through these, so the live counts show whether GPU objects
+//  leak; in a steady scene they must stay the same from frame to frame.
+//
+
+#ifndef glResources_h
+#define glResources_h
+
+#include <glad/glad.h>
+#include "glState.h"
+
+struct GLResourceStats {
+    int buffers = 0;
+    int vertexArrays = 0;
+};
+
+inline GLResourceStats& glResourceStats()
+{
+    static GLResourceStats stats;
+    return stats;
+}
+
+inline void genBuffers(GLsizei n, GLuint* buffers)
+{
+    glGenBuffers(n, buffers);
+    glResourceStats().buffers += n;
+}
+
+// id 0 is silently ignored by GL, so it is not counted either
+inline void deleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    for (GLsizei i = 0; i < n; i++)
+        if (buffers[i] != 0)
+            glResourceStats().buffers--;
+    glDeleteBuffers(n, buffers);
+}
+
+inline void genVertexArrays(GLsizei n, GLuint* arrays)
+{
+    glGenVertexArrays(n, arrays);
+    glResourceStats().vertexArrays += n;
+}
+
+inline void deleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+    for (GLsizei i = 0; i < n; i++)
+        if (arrays[i] != 0)
+        {
+            glResourceStats().vertexArrays--;
+            forgetVertexArray(arrays[i]);
+        }
+    glDeleteVertexArrays(n, arrays);
+}
+
+#endif /* glResources_h */
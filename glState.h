@@ -0,0 +1,204 @@
+//
+//  glState.h
+//  test
+//
+//  A thin cache in front of the GL binding calls. Program, vertex array,
+//  texture unit, texture and line width changes go through these wrappers,
+//  which remember what is current and drop a call that would not change it.
+//  The counters tell how many calls of each kind reached the driver and how
+//  many were filtered; the title bar and the benchmark report read them.
+//
+//  The cache only stays right if every binding goes through it. Code that
+//  has to call GL directly (or a context change) must call invalidateGLState.
+//
+
+#ifndef glState_h
+#define glState_h
+
+#include <glad/glad.h>
+
+enum GLStateCall {
+    STATE_USE_PROGRAM,
+    STATE_BIND_VERTEX_ARRAY,
+    STATE_ACTIVE_TEXTURE,
+    STATE_BIND_TEXTURE,
+    STATE_LINE_WIDTH,
+    STATE_CALL_COUNT
+};
+
+struct GLStateStats {
+    unsigned int issued[STATE_CALL_COUNT] = { 0 };
+    unsigned int filtered[STATE_CALL_COUNT] = { 0 };
+
+    unsigned int totalIssued() const
+    {
+        unsigned int total = 0;
+        for (int i = 0; i < STATE_CALL_COUNT; i++)
+            total += issued[i];
+        return total;
+    }
+
+    unsigned int totalFiltered() const
+    {
+        unsigned int total = 0;
+        for (int i = 0; i < STATE_CALL_COUNT; i++)
+            total += filtered[i];
+        return total;
+    }
+
+    void reset()
+    {
+        for (int i = 0; i < STATE_CALL_COUNT; i++)
+            issued[i] = filtered[i] = 0;
+    }
+};
+
+inline GLStateStats& glStateStats()
+{
+    static GLStateStats stats;
+    return stats;
+}
+
+// units and targets beyond these are passed through unfiltered
+#define STATE_TEXTURE_UNITS 16
+#define STATE_UNKNOWN 0xFFFFFFFFu
+
+struct GLStateCache {
+    GLuint program = STATE_UNKNOWN;
+    GLuint vertexArray = STATE_UNKNOWN;
+    GLenum activeUnit = STATE_UNKNOWN;
+    GLuint textures[STATE_TEXTURE_UNITS][2];  // GL_TEXTURE_2D, GL_TEXTURE_BUFFER per unit
+    float lineWidth = -1.0f;
+
+    GLStateCache()
+    {
+        invalidate();
+    }
+
+    void invalidate()
+    {
+        program = vertexArray = activeUnit = STATE_UNKNOWN;
+        for (int i = 0; i < STATE_TEXTURE_UNITS; i++)
+            textures[i][0] = textures[i][1] = STATE_UNKNOWN;
+        lineWidth = -1.0f;
+    }
+
+    // the cached binding for target on unit, or NULL when it is not tracked
+    GLuint* texture(GLenum unit, GLenum target)
+    {
+        GLuint index = unit - GL_TEXTURE0;
+        if (index >= STATE_TEXTURE_UNITS)
+            return NULL;
+        if (target == GL_TEXTURE_2D)
+            return &textures[index][0];
+        if (target == GL_TEXTURE_BUFFER)
+            return &textures[index][1];
+        return NULL;
+    }
+};
+
+inline GLStateCache& glStateCache()
+{
+    static GLStateCache cache;
+    return cache;
+}
+
+inline void invalidateGLState()
+{
+    glStateCache().invalidate();
+}
+
+inline void useProgram(GLuint program)
+{
+    if (glStateCache().program == program)
+    {
+        glStateStats().filtered[STATE_USE_PROGRAM]++;
+        return;
+    }
+    glUseProgram(program);
+    glStateCache().program = program;
+    glStateStats().issued[STATE_USE_PROGRAM]++;
+}
+
+inline void bindVertexArray(GLuint vertexArray)
+{
+    if (glStateCache().vertexArray == vertexArray)
+    {
+        glStateStats().filtered[STATE_BIND_VERTEX_ARRAY]++;
+        return;
+    }
+    glBindVertexArray(vertexArray);
+    glStateCache().vertexArray = vertexArray;
+    glStateStats().issued[STATE_BIND_VERTEX_ARRAY]++;
+}
+
+inline void activeTexture(GLenum unit)
+{
+    if (glStateCache().activeUnit == unit)
+    {
+        glStateStats().filtered[STATE_ACTIVE_TEXTURE]++;
+        return;
+    }
+    glActiveTexture(unit);
+    glStateCache().activeUnit = unit;
+    glStateStats().issued[STATE_ACTIVE_TEXTURE]++;
+}
+
+// binds to whichever unit is active, like glBindTexture
+inline void bindTexture(GLenum target, GLuint texture)
+{
+    GLStateCache& cache = glStateCache();
+    GLuint* bound = cache.activeUnit == STATE_UNKNOWN ? NULL : cache.texture(cache.activeUnit, target);
+    if (bound != NULL && *bound == texture)
+    {
+        glStateStats().filtered[STATE_BIND_TEXTURE]++;
+        return;
+    }
+    glBindTexture(target, texture);
+    if (bound != NULL)
+        *bound = texture;
+    glStateStats().issued[STATE_BIND_TEXTURE]++;
+}
+
+// binds texture on unit; the active unit is only switched when the binding really changes
+inline void bindTextureUnit(GLenum unit, GLenum target, GLuint texture)
+{
+    GLuint* bound = glStateCache().texture(unit, target);
+    if (bound != NULL && *bound == texture)
+    {
+        glStateStats().filtered[STATE_BIND_TEXTURE]++;
+        return;
+    }
+    activeTexture(unit);
+    bindTexture(target, texture);
+}
+
+inline void lineWidth(float width)
+{
+    if (glStateCache().lineWidth == width)
+    {
+        glStateStats().filtered[STATE_LINE_WIDTH]++;
+        return;
+    }
+    glLineWidth(width);
+    glStateCache().lineWidth = width;
+    glStateStats().issued[STATE_LINE_WIDTH]++;
+}
+
+// GL unbinds a vertex array or texture that is deleted while bound; the cache follows
+inline void forgetVertexArray(GLuint vertexArray)
+{
+    if (glStateCache().vertexArray == vertexArray)
+        glStateCache().vertexArray = 0;
+}
+
+inline void forgetTexture(GLuint texture)
+{
+    GLStateCache& cache = glStateCache();
+    for (int i = 0; i < STATE_TEXTURE_UNITS; i++)
+        for (int j = 0; j < 2; j++)
+            if (cache.textures[i][j] == texture)
+                cache.textures[i][j] = 0;
+}
+
+#endif /* glState_h */
@@ -0,0 +1,168 @@
+//
+//  instancedBatch.h
+//  test
+//
+//  Collects copies of one cached mesh while a frame is being built and draws
+//  them with one glDrawElementsInstanced when flushed. Every copy carries its
+//  own model matrix and color; they are streamed into a per-instance buffer
+//  that is orphaned on each flush, so the driver never waits on the previous
+//  frame's draw. Use InstancedMesh instead for layouts uploaded only once.
+//
+//  A batch may hold several levels of detail of the same shape, one cached
+//  mesh each; every copy is added to the level it is drawn at, and a flush
+//  issues one instanced draw per level that has copies.
+//
+
+#ifndef instancedBatch_h
+#define instancedBatch_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "shader.h"
+#include "meshCache.h"
+#include "instancedMesh.h"
+
+// the per-instance color follows the model matrix
+#define INSTANCE_COLOR_LOCATION 7
+
+struct BatchInstance {
+    glm::mat4 model;
+    glm::vec4 color;
+};
+
+class InstancedBatch {
+public:
+    // shares the buffers of the cached mesh under key; attributeCount picks position[/normal[/texcoord]]
+    InstancedBatch(const std::string& key, int stride = 6, int attributeCount = 2)
+        : InstancedBatch(std::vector<std::string>(1, key), stride, attributeCount)
+    {
+    }
+
+    // one level of detail per key, the finest first
+    InstancedBatch(const std::vector<std::string>& keys, int stride = 6, int attributeCount = 2)
+        : levels(keys.size())
+    {
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            Level& level = levels[i];
+            level.mesh = MeshCache::shared().acquire(keys[i]);
+            if (level.mesh == NULL)
+            {
+                std::cout << "InstancedBatch: mesh \"" << keys[i] << "\" has not been created" << std::endl;
+                continue;
+            }
+
+            genVertexArrays(1, &level.VAO);
+            genBuffers(1, &level.instanceVBO);
+            setUpInstancedVAO(level.VAO, *level.mesh, stride, attributeCount, level.instanceVBO, sizeof(BatchInstance));
+            glVertexAttribPointer(INSTANCE_COLOR_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(BatchInstance), (void*)sizeof(glm::mat4));
+            glEnableVertexAttribArray(INSTANCE_COLOR_LOCATION);
+            glVertexAttribDivisor(INSTANCE_COLOR_LOCATION, 1);
+            bindVertexArray(0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+    }
+
+    InstancedBatch(const InstancedBatch&) = delete;
+    InstancedBatch& operator=(const InstancedBatch&) = delete;
+
+    ~InstancedBatch()
+    {
+        for (size_t i = 0; i < levels.size(); i++)
+        {
+            deleteVertexArrays(1, &levels[i].VAO);
+            deleteBuffers(1, &levels[i].instanceVBO);
+            MeshCache::shared().release(levels[i].mesh);
+        }
+    }
+
+    void add(const glm::mat4& model, const glm::vec4& color = glm::vec4(1.0f))
+    {
+        addAtLevel(model, 0, color);
+    }
+
+    // level indexes the keys the batch was made with
+    void addAtLevel(const glm::mat4& model, int level, const glm::vec4& color = glm::vec4(1.0f))
+    {
+        BatchInstance instance = { model, color };
+        levels[level].instances.push_back(instance);
+    }
+
+    size_t size() const
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < levels.size(); i++)
+            count += levels[i].instances.size();
+        return count;
+    }
+
+    // for the flat color program (vertexShaderInstanced.vs); the color comes from each instance
+    void flushWithColor(Shader& shaderInstanced)
+    {
+        if (size() == 0)
+            return;
+        shaderInstanced.use();
+        flush();
+    }
+
+    // for the textured Phong program (vertexShaderForPhongShadingWithTextureInstanced.vs)
+    void flushWithTexture(Shader& lightingShaderWithTextureInstanced, unsigned int diffuseMap, unsigned int specularMap, float shininess,
+        glm::vec4 textureRange = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f))
+    {
+        if (size() == 0)
+            return;
+        lightingShaderWithTextureInstanced.use();
+
+        lightingShaderWithTextureInstanced.setInt("material.diffuse", 0);
+        lightingShaderWithTextureInstanced.setInt("material.specular", 1);
+        lightingShaderWithTextureInstanced.setFloat("material.shininess", shininess);
+        lightingShaderWithTextureInstanced.setVec4("textureRange", textureRange);
+
+        bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, diffuseMap);
+        bindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D, specularMap);
+
+        flush();
+    }
+
+private:
+    struct Level {
+        SharedMesh* mesh = NULL;
+        unsigned int VAO = 0, instanceVBO = 0;
+        GLsizeiptr capacity = 0;  // bytes allocated for instanceVBO
+        std::vector<BatchInstance> instances;
+    };
+
+    std::vector<Level> levels;
+
+    // uploads the collected instances, draws each level once and starts the next batch
+    void flush()
+    {
+        for (size_t i = 0; i < levels.size(); i++)
+        {
+            Level& level = levels[i];
+            if (level.mesh == NULL || level.instances.empty())
+            {
+                level.instances.clear();
+                continue;
+            }
+
+            GLsizeiptr bytes = level.instances.size() * sizeof(BatchInstance);
+            if (bytes > level.capacity)
+                level.capacity = bytes;
+            glBindBuffer(GL_ARRAY_BUFFER, level.instanceVBO);
+            // orphan the old storage so the upload does not wait for the draw that still reads it
+            glBufferData(GL_ARRAY_BUFFER, level.capacity, NULL, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, &level.instances[0]);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+            bindVertexArray(level.VAO);
+            glDrawElementsInstanced(GL_TRIANGLES, level.mesh->indexCount, GL_UNSIGNED_INT, 0, (GLsizei)level.instances.size());
+            level.instances.clear();
+        }
+    }
+};
+
+#endif /* instancedBatch_h */
@@ -0,0 +1,124 @@
+//
+//  instancedMesh.h
+//  test
+//
+//  Draws many copies of one cached mesh with a single glDrawElementsInstanced.
+//  The model matrix of every copy lives in a per-instance buffer read by the
+//  vertex shader at INSTANCE_MODEL_LOCATION, so a whole layout (e.g. all the
+//  seats of the hall) is uploaded once and costs one draw call per frame.
+//
+
+#ifndef instancedMesh_h
+#define instancedMesh_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "shader.h"
+#include "meshCache.h"
+#include "materialTable.h"
+
+// a mat4 attribute takes four consecutive locations, 3..6, after position, normal and texcoord
+#define INSTANCE_MODEL_LOCATION 3
+
+// binds the mesh buffers and its first attributeCount of position/normal/texcoord to vao, followed by
+// a per-instance model matrix that starts every instanceStride bytes of instanceVBO
+inline void setUpInstancedVAO(unsigned int vao, const SharedMesh& mesh, int stride, int attributeCount, unsigned int instanceVBO, GLsizei instanceStride)
+{
+    static const int sizes[3] = { 3, 3, 2 };
+    bindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+    int offset = 0;
+    for (int i = 0; i < attributeCount; i++)
+    {
+        glVertexAttribPointer(i, sizes[i], GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(offset * sizeof(float)));
+        glEnableVertexAttribArray(i);
+        offset += sizes[i];
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (int column = 0; column < 4; column++)
+    {
+        glVertexAttribPointer(INSTANCE_MODEL_LOCATION + column, 4, GL_FLOAT, GL_FALSE, instanceStride, (void*)(column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(INSTANCE_MODEL_LOCATION + column);
+        glVertexAttribDivisor(INSTANCE_MODEL_LOCATION + column, 1);
+    }
+}
+
+class InstancedMesh {
+public:
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+    float shininess;
+    int materialIndex;  // row in MaterialTable
+
+    // shares the buffers of the cached mesh under key; attributeCount picks position[/normal[/texcoord]]
+    InstancedMesh(const std::string& key, int stride = 6, int attributeCount = 2,
+        glm::vec3 amb = glm::vec3(1.0f), glm::vec3 diff = glm::vec3(1.0f), glm::vec3 spec = glm::vec3(0.5f), float shiny = 32.0f)
+        : ambient(amb), diffuse(diff), specular(spec), shininess(shiny), materialIndex(MaterialTable::shared().add(amb, diff, spec, shiny))
+    {
+        mesh = MeshCache::shared().acquire(key);
+        if (mesh == NULL)
+        {
+            std::cout << "InstancedMesh: mesh \"" << key << "\" has not been created" << std::endl;
+            return;
+        }
+
+        genVertexArrays(1, &VAO);
+        genBuffers(1, &instanceVBO);
+        setUpInstancedVAO(VAO, *mesh, stride, attributeCount, instanceVBO, sizeof(glm::mat4));
+        bindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    InstancedMesh(const InstancedMesh&) = delete;
+    InstancedMesh& operator=(const InstancedMesh&) = delete;
+
+    ~InstancedMesh()
+    {
+        deleteVertexArrays(1, &VAO);
+        deleteBuffers(1, &instanceVBO);
+        MeshCache::shared().release(mesh);
+    }
+
+    // for layouts that do not move; call again only when the layout changes
+    void setTransforms(const std::vector<glm::mat4>& transforms)
+    {
+        instanceCount = (GLsizei)transforms.size();
+        bounds = Bounds();
+        for (size_t i = 0; mesh != NULL && i < transforms.size(); i++)
+            bounds.add(mesh->bounds.transformed(transforms[i]));
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, transforms.size() * sizeof(glm::mat4), transforms.empty() ? NULL : &transforms[0], GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    GLsizei getInstanceCount() const { return instanceCount; }
+
+    // the world-space box around every instance
+    const Bounds& worldBounds() const { return bounds; }
+
+    void drawWithMaterialisticProperty(Shader& lightingShaderInstanced) const
+    {
+        if (mesh == NULL || instanceCount == 0)
+            return;
+        lightingShaderInstanced.use();
+
+        lightingShaderInstanced.setInt("materialIndex", this->materialIndex);
+
+        bindVertexArray(VAO);
+        glDrawElementsInstanced(GL_TRIANGLES, mesh->indexCount, GL_UNSIGNED_INT, 0, instanceCount);
+    }
+
+private:
+    SharedMesh* mesh = NULL;
+    unsigned int VAO = 0, instanceVBO = 0;
+    GLsizei instanceCount = 0;
+    Bounds bounds;
+};
+
+#endif /* instancedMesh_h */
@@ -0,0 +1,201 @@
+//
+//  lightBlock.h
+//  test
+//
+//  One std140 uniform buffer holding the spot and directional lights plus the
+//  cluster grid settings, and one texture buffer holding every point light.
+//  All lighting programs read the same buffers, so the lights are uploaded
+//  once instead of once per program, and only when one of them changes.
+//
+
+#ifndef lightBlock_h
+#define lightBlock_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "shader.h"
+#include "glResources.h"
+#include "pointLight.h"
+#include "SpotLight.h"
+#include "directionalLight.h"
+
+// must match the defines and the LightBlock declaration in the lighting fragment shaders
+#define NR_SPOT_LIGHTS 5
+#define LIGHT_BLOCK_BINDING 0
+// texture units 0 and 1 belong to the material maps
+#define POINT_LIGHT_DATA_UNIT 4
+
+// how the fragment shader finds its cluster, see lightClusters.h
+struct ClusterParamsStd140 {
+    int tilesX, tilesY, slices, padding;
+    float zNear, zFar, sliceScale, sliceBias;
+    float tileWidth, tileHeight, padding1, padding2;
+};
+
+struct LightBlockStd140 {
+    SpotLightStd140 spotLights[NR_SPOT_LIGHTS];
+    DirectionLightStd140 directionalLight;
+    ClusterParamsStd140 cluster;
+};
+
+static_assert(sizeof(PointLightStd140) == 64, "PointLightStd140 must be four RGBA32F texels");
+static_assert(sizeof(SpotLightStd140) == 80, "SpotLightStd140 does not match the std140 layout");
+static_assert(sizeof(DirectionLightStd140) == 64, "DirectionLightStd140 does not match the std140 layout");
+static_assert(sizeof(ClusterParamsStd140) == 48, "ClusterParamsStd140 does not match the std140 layout");
+
+class LightBlock {
+public:
+    unsigned int uploadedBytes = 0;  // bytes sent by the last update(), 0 when nothing changed
+
+    LightBlock() {}
+    ~LightBlock()
+    {
+        release();
+    }
+
+    // needs a current GL context, so call it after glad is loaded
+    void create()
+    {
+        genBuffers(1, &UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(LightBlockStd140), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, UBO);
+
+        genBuffers(1, &pointLightBuffer);
+        glGenTextures(1, &pointLightTexture);
+        glBindBuffer(GL_TEXTURE_BUFFER, pointLightBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, sizeof(PointLightStd140), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        activeTexture(GL_TEXTURE0 + POINT_LIGHT_DATA_UNIT);
+        bindTexture(GL_TEXTURE_BUFFER, pointLightTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, pointLightBuffer);
+        activeTexture(GL_TEXTURE0);
+    }
+
+    // main() calls this before glfwTerminate(); the destructor would run without a context
+    void release()
+    {
+        if (UBO != 0)
+            deleteBuffers(1, &UBO);
+        if (pointLightBuffer != 0)
+            deleteBuffers(1, &pointLightBuffer);
+        if (pointLightTexture != 0)
+        {
+            forgetTexture(pointLightTexture);
+            glDeleteTextures(1, &pointLightTexture);
+        }
+        UBO = pointLightBuffer = pointLightTexture = 0;
+    }
+
+    // GLSL 3.30 has no layout(binding = ...), so each program is pointed at the binding point here
+    void bindTo(Shader& shader)
+    {
+        unsigned int blockIndex = glGetUniformBlockIndex(shader.ID, "LightBlock");
+        if (blockIndex == GL_INVALID_INDEX)
+        {
+            std::cout << "LightBlock is not used by program " << shader.ID << std::endl;
+            return;
+        }
+        glUniformBlockBinding(shader.ID, blockIndex, LIGHT_BLOCK_BINDING);
+        shader.use();
+        shader.setInt("pointLightData", POINT_LIGHT_DATA_UNIT);
+    }
+
+    // the grid only changes on resize, so this is usually a no-op
+    void setClusterParams(const ClusterParamsStd140& params)
+    {
+        if (memcmp(&params, &block.cluster, sizeof(params)) == 0)
+            return;
+        block.cluster = params;
+        markRange(offsetof(LightBlockStd140, cluster), sizeof(ClusterParamsStd140));
+    }
+
+    // re-packs the dirty lights and uploads the smallest range that covers them
+    void update(PointLight* pointLights[], int pointCount, SpotLight* spotLights[], int spotCount, DirectionLight& directionalLight)
+    {
+        uploadedBytes = 0;
+        updatePointLights(pointLights, pointCount);
+
+        for (int i = 0; i < spotCount; i++)
+        {
+            SpotLight& light = *spotLights[i];
+            if (!light.dirty)
+                continue;
+            light.writeStd140(block.spotLights[light.Number]);
+            light.dirty = false;
+            markRange(offsetof(LightBlockStd140, spotLights) + light.Number * sizeof(SpotLightStd140), sizeof(SpotLightStd140));
+        }
+        if (directionalLight.dirty)
+        {
+            directionalLight.writeStd140(block.directionalLight);
+            directionalLight.dirty = false;
+            markRange(offsetof(LightBlockStd140, directionalLight), sizeof(DirectionLightStd140));
+        }
+
+        if (dirtyFirst >= dirtyLast)
+            return;
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, dirtyFirst, dirtyLast - dirtyFirst, reinterpret_cast<const char*>(&block) + dirtyFirst);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        uploadedBytes += (unsigned int)(dirtyLast - dirtyFirst);
+        dirtyFirst = sizeof(LightBlockStd140);
+        dirtyLast = 0;
+    }
+
+private:
+    unsigned int UBO = 0;
+    unsigned int pointLightBuffer = 0, pointLightTexture = 0;
+    size_t pointLightCapacity = 1;  // lights the texture buffer currently has room for
+    LightBlockStd140 block = {};  // CPU copies, so a partial upload never has to read a buffer back
+    std::vector<PointLightStd140> pointLightData;
+    size_t dirtyFirst = sizeof(LightBlockStd140), dirtyLast = 0;
+
+    void markRange(size_t offset, size_t size)
+    {
+        if (offset < dirtyFirst)
+            dirtyFirst = offset;
+        if (offset + size > dirtyLast)
+            dirtyLast = offset + size;
+    }
+
+    // point lights are indexed by Number, so the buffer grows to the highest number seen
+    void updatePointLights(PointLight* pointLights[], int pointCount)
+    {
+        size_t first = (size_t)-1, last = 0;
+        for (int i = 0; i < pointCount; i++)
+        {
+            PointLight& light = *pointLights[i];
+            if (!light.dirty)
+                continue;
+            if ((size_t)light.Number >= pointLightData.size())
+                pointLightData.resize(light.Number + 1);
+            light.writeStd140(pointLightData[light.Number]);
+            light.dirty = false;
+            if ((size_t)light.Number < first)
+                first = light.Number;
+            if ((size_t)light.Number + 1 > last)
+                last = light.Number + 1;
+        }
+        if (first >= last)
+            return;
+
+        glBindBuffer(GL_TEXTURE_BUFFER, pointLightBuffer);
+        if (pointLightData.size() > pointLightCapacity)
+        {
+            pointLightCapacity = pointLightData.size();
+            first = 0;
+            last = pointLightCapacity;
+            glBufferData(GL_TEXTURE_BUFFER, pointLightCapacity * sizeof(PointLightStd140), NULL, GL_DYNAMIC_DRAW);
+        }
+        glBufferSubData(GL_TEXTURE_BUFFER, first * sizeof(PointLightStd140), (last - first) * sizeof(PointLightStd140), &pointLightData[first]);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        uploadedBytes += (unsigned int)((last - first) * sizeof(PointLightStd140));
+    }
+};
+
+#endif /* lightBlock_h */
@@ -0,0 +1,239 @@
+//
+//  lightClusters.h
+//  test
+//
+//  Clustered forward shading for the point lights. The view frustum is cut
+//  into screen tiles and logarithmic depth slices; every frame each lit point
+//  light is binned into the clusters its range sphere touches, and the
+//  fragment shader only walks the light list of its own cluster.
+//
+
+#ifndef lightClusters_h
+#define lightClusters_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "shader.h"
+#include "glResources.h"
+#include "pointLight.h"
+#include "lightBlock.h"
+
+#define LIGHT_GRID_UNIT 5
+#define LIGHT_INDEX_UNIT 6
+
+class LightClusters {
+public:
+    int tilesX, tilesY, slices;
+
+    // statistics of the last build()
+    unsigned int activeLights = 0;        // lights that were lit and in front of the camera
+    unsigned int lightReferences = 0;     // entries in the index list
+    unsigned int maxLightsPerCluster = 0;
+
+    LightClusters(int tilesX = 16, int tilesY = 12, int slices = 16) : tilesX(tilesX), tilesY(tilesY), slices(slices)
+    {
+        clusterCounts.resize(tilesX * tilesY * slices);
+        grid.resize(clusterCounts.size() * 2);
+    }
+    ~LightClusters()
+    {
+        release();
+    }
+
+    // needs a current GL context, so call it after glad is loaded
+    void create()
+    {
+        genBuffers(1, &gridBuffer);
+        genBuffers(1, &indexBuffer);
+        glGenTextures(1, &gridTexture);
+        glGenTextures(1, &indexTexture);
+
+        glBindBuffer(GL_TEXTURE_BUFFER, gridBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, grid.size() * sizeof(unsigned int), NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, indexCapacity * sizeof(unsigned short), NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        activeTexture(GL_TEXTURE0 + LIGHT_GRID_UNIT);
+        bindTexture(GL_TEXTURE_BUFFER, gridTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, gridBuffer);
+        activeTexture(GL_TEXTURE0 + LIGHT_INDEX_UNIT);
+        bindTexture(GL_TEXTURE_BUFFER, indexTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, indexBuffer);
+        activeTexture(GL_TEXTURE0);
+    }
+
+    // the grid and index buffers go before glfwTerminate(), which runs ahead of this destructor
+    void release()
+    {
+        if (gridBuffer != 0)
+            deleteBuffers(1, &gridBuffer);
+        if (indexBuffer != 0)
+            deleteBuffers(1, &indexBuffer);
+        if (gridTexture != 0)
+        {
+            forgetTexture(gridTexture);
+            glDeleteTextures(1, &gridTexture);
+        }
+        if (indexTexture != 0)
+        {
+            forgetTexture(indexTexture);
+            glDeleteTextures(1, &indexTexture);
+        }
+        gridBuffer = indexBuffer = gridTexture = indexTexture = 0;
+    }
+
+    void bindTo(Shader& shader)
+    {
+        shader.use();
+        shader.setInt("lightGrid", LIGHT_GRID_UNIT);
+        shader.setInt("lightIndices", LIGHT_INDEX_UNIT);
+    }
+
+    // grid settings for the LightBlock; slices are spaced logarithmically between near and far
+    ClusterParamsStd140 params(int framebufferWidth, int framebufferHeight, float zNear, float zFar) const
+    {
+        ClusterParamsStd140 p = {};
+        p.tilesX = tilesX;
+        p.tilesY = tilesY;
+        p.slices = slices;
+        p.zNear = zNear;
+        p.zFar = zFar;
+        p.sliceScale = slices / log(zFar / zNear);
+        p.sliceBias = slices * log(zNear) / log(zFar / zNear);
+        p.tileWidth = (float)framebufferWidth / tilesX;
+        p.tileHeight = (float)framebufferHeight / tilesY;
+        return p;
+    }
+
+    // bins every lit light into the clusters its range sphere overlaps and uploads the result
+    void build(PointLight* pointLights[], int pointCount, const glm::mat4& view, const glm::mat4& projection, float zNear, float zFar)
+    {
+        float sliceScale = slices / log(zFar / zNear);
+        float sliceBias = slices * log(zNear) / log(zFar / zNear);
+
+        // pass 1: the cluster range of every light, and how many lights land in each cluster
+        lightRanges.clear();
+        std::fill(clusterCounts.begin(), clusterCounts.end(), 0u);
+        for (int i = 0; i < pointCount; i++)
+        {
+            const PointLight& light = *pointLights[i];
+            float radius = light.effectiveRadius();
+            if (radius <= 0.0f)
+                continue;
+
+            glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+            float depthMin = -center.z - radius, depthMax = -center.z + radius;
+            if (depthMax < zNear || depthMin > zFar)
+                continue;
+            depthMin = std::max(depthMin, zNear);
+            depthMax = std::min(depthMax, zFar);
+
+            // screen rectangle of the sphere's view-space box, clipped to the near plane so every corner projects
+            float minX = 1.0f, minY = 1.0f, maxX = -1.0f, maxY = -1.0f;
+            for (int corner = 0; corner < 8; corner++)
+            {
+                glm::vec4 p(center.x + ((corner & 1) ? radius : -radius),
+                            center.y + ((corner & 2) ? radius : -radius),
+                            (corner & 4) ? -depthMin : -depthMax, 1.0f);
+                glm::vec4 clip = projection * p;
+                float x = clip.x / clip.w, y = clip.y / clip.w;
+                minX = std::min(minX, x); maxX = std::max(maxX, x);
+                minY = std::min(minY, y); maxY = std::max(maxY, y);
+            }
+            if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+                continue;
+
+            LightRange range;
+            range.index = (unsigned short)light.Number;
+            range.x0 = tileOf(minX, tilesX);
+            range.x1 = tileOf(maxX, tilesX);
+            range.y0 = tileOf(minY, tilesY);
+            range.y1 = tileOf(maxY, tilesY);
+            range.z0 = sliceOf(depthMin, sliceScale, sliceBias);
+            range.z1 = sliceOf(depthMax, sliceScale, sliceBias);
+            lightRanges.push_back(range);
+
+            for (int z = range.z0; z <= range.z1; z++)
+                for (int y = range.y0; y <= range.y1; y++)
+                    for (int x = range.x0; x <= range.x1; x++)
+                        clusterCounts[clusterIndex(x, y, z)]++;
+        }
+
+        // pass 2: offsets by prefix sum, then scatter the light indices
+        unsigned int offset = 0;
+        maxLightsPerCluster = 0;
+        for (size_t c = 0; c < clusterCounts.size(); c++)
+        {
+            grid[c * 2] = offset;
+            grid[c * 2 + 1] = 0;
+            offset += clusterCounts[c];
+            maxLightsPerCluster = std::max(maxLightsPerCluster, clusterCounts[c]);
+        }
+        indices.resize(offset > 0 ? offset : 1);
+        for (size_t i = 0; i < lightRanges.size(); i++)
+        {
+            const LightRange& range = lightRanges[i];
+            for (int z = range.z0; z <= range.z1; z++)
+                for (int y = range.y0; y <= range.y1; y++)
+                    for (int x = range.x0; x <= range.x1; x++)
+                    {
+                        int c = clusterIndex(x, y, z);
+                        indices[grid[c * 2] + grid[c * 2 + 1]++] = range.index;
+                    }
+        }
+        activeLights = (unsigned int)lightRanges.size();
+        lightReferences = offset;
+
+        upload();
+    }
+
+private:
+    struct LightRange {
+        unsigned short index;
+        int x0, x1, y0, y1, z0, z1;
+    };
+
+    unsigned int gridBuffer = 0, indexBuffer = 0, gridTexture = 0, indexTexture = 0;
+    size_t indexCapacity = 1024;  // entries the index buffer currently has room for
+    std::vector<LightRange> lightRanges;
+    std::vector<unsigned int> clusterCounts;
+    std::vector<unsigned int> grid;      // (first index, count) per cluster
+    std::vector<unsigned short> indices;
+
+    int clusterIndex(int x, int y, int z) const
+    {
+        return (z * tilesY + y) * tilesX + x;
+    }
+
+    static int tileOf(float ndc, int tiles)
+    {
+        int tile = (int)floor((ndc * 0.5f + 0.5f) * tiles);
+        return tile < 0 ? 0 : (tile >= tiles ? tiles - 1 : tile);
+    }
+
+    // same formula as the fragment shader
+    int sliceOf(float depth, float sliceScale, float sliceBias) const
+    {
+        int slice = (int)floor(log(depth) * sliceScale - sliceBias);
+        return slice < 0 ? 0 : (slice >= slices ? slices - 1 : slice);
+    }
+
+    // both buffers are re-specified every frame so the driver can hand back fresh storage
+    void upload()
+    {
+        glBindBuffer(GL_TEXTURE_BUFFER, gridBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, grid.size() * sizeof(unsigned int), grid.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+        if (indices.size() > indexCapacity)
+            indexCapacity = indices.size() * 2;
+        glBufferData(GL_TEXTURE_BUFFER, indexCapacity * sizeof(unsigned short), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, indices.size() * sizeof(unsigned short), indices.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+};
+
+#endif /* lightClusters_h */
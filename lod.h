@@ -0,0 +1,149 @@
+//
+//  lod.h
+//  test
+//
+//  Levels of detail for the parametric meshes. Each generator builds its
+//  mesh LOD_LEVELS times at load time, every level at a fraction of the
+//  previous density, and a draw picks the level from how many pixels the
+//  node's bounding sphere covers this frame. Every placed node keeps its own
+//  LodState, and a level only changes once the size has moved well past the
+//  threshold between the two, so a node sitting at the boundary does not
+//  flicker between them.
+//
+
+#ifndef lod_h
+#define lod_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+#include "bounds.h"
+#include "glResources.h"
+
+#define LOD_LEVELS 3
+// how far past a threshold (as a fraction of it) the size must move before the level changes
+#define LOD_HYSTERESIS 0.2f
+
+// the pixel size below which level i gives way to level i + 1
+static const float LOD_PIXELS[LOD_LEVELS - 1] = { 160.0f, 48.0f };
+
+// the segment count of level: full at 0, halved per level, never below minimum (nor above full)
+inline int lodSegments(int full, int level, int minimum)
+{
+    return std::min(full, std::max(minimum, full >> level));
+}
+
+// meshes cut to a tolerance: each level allows this many times the error of the one before,
+// which for a curve is about half as many segments
+#define LOD_TOLERANCE_STEP 4.0f
+
+inline float lodTolerance(float tolerance, int level)
+{
+    for (int i = 0; i < level; i++)
+        tolerance *= LOD_TOLERANCE_STEP;
+    return tolerance;
+}
+
+// one node's current level; -1 until its first draw
+struct LodState {
+    int level = -1;
+};
+
+// one level of a mesh its class uploads itself; stride is in floats, 6 without texture coordinates
+struct LodLevel {
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    GLsizei indexCount = 0;
+
+    void upload(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, int stride)
+    {
+        genVertexArrays(1, &VAO);
+        bindVertexArray(VAO);
+        genBuffers(1, &VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        genBuffers(1, &EBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        indexCount = (GLsizei)indices.size();
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(3 * sizeof(float)));
+        if (stride >= 8)
+        {
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(6 * sizeof(float)));
+        }
+        bindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    void release()
+    {
+        deleteVertexArrays(1, &VAO);
+        deleteBuffers(1, &VBO);
+        deleteBuffers(1, &EBO);
+        VAO = VBO = EBO = 0;
+        indexCount = 0;
+    }
+};
+
+class LodSelector {
+public:
+    unsigned int selected[LOD_LEVELS] = { 0 };  // draws per level since the last setView()
+
+    static LodSelector& shared()
+    {
+        static LodSelector selector;
+        return selector;
+    }
+
+    // once per frame, before anything is queued
+    void setView(const glm::vec3& eye, const glm::mat4& projection, int viewportHeight)
+    {
+        this->eye = eye;
+        pixelsPerUnit = projection[1][1] * 0.5f * (float)viewportHeight;
+        std::fill(selected, selected + LOD_LEVELS, 0u);
+    }
+
+    // the diameter in pixels of the sphere around a world box, at its distance from the eye
+    float projectedSize(const Bounds& world) const
+    {
+        float diameter = glm::length(world.max - world.min);
+        float distance = glm::length(world.center() - eye);
+        if (distance <= diameter * 0.5f)
+            return FLT_MAX;
+        return diameter / distance * pixelsPerUnit;
+    }
+
+    // the level for a node with this world box; state carries the node's level between frames
+    int select(const Bounds& world, LodState& state)
+    {
+        float pixels = projectedSize(world);
+        if (state.level < 0)
+        {
+            state.level = 0;
+            while (state.level < LOD_LEVELS - 1 && pixels < LOD_PIXELS[state.level])
+                state.level++;
+        }
+        while (state.level < LOD_LEVELS - 1 && pixels < LOD_PIXELS[state.level] * (1.0f - LOD_HYSTERESIS))
+            state.level++;
+        while (state.level > 0 && pixels > LOD_PIXELS[state.level - 1] * (1.0f + LOD_HYSTERESIS))
+            state.level--;
+        selected[state.level]++;
+        return state.level;
+    }
+
+private:
+    glm::vec3 eye = glm::vec3(0.0f);
+    float pixelsPerUnit = 0.0f;
+
+    LodSelector() {}
+    LodSelector(const LodSelector&) = delete;
+    LodSelector& operator=(const LodSelector&) = delete;
+};
+
+#endif /* lod_h */
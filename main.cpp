@@ -17,8 +17,29 @@
 #include "fractal.h"
 #include "cylinder.h"
 #include "BezierCurve.h"
-
+#include "directionalLight.h"
+#include "lightBlock.h"
+#include "lightClusters.h"
+#include "glResources.h"
+#include "sceneRegistry.h"
+#include "meshCache.h"
+#include "instancedMesh.h"
+#include "instancedBatch.h"
+#include "bakedScene.h"
+#include "renderQueue.h"
+#include "materialTable.h"
+#include "sceneFile.h"
+#include "benchmark.h"
+#include "textureLoader.h"
+#include "lod.h"
+#include "tessellatedSurface.h"
+#include "forest.h"
+
+#include <algorithm>
 #include <iostream>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
 
 using namespace std;
 
@@ -27,22 +48,23 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
-void drawCube(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model, float r, float g, float b, float shininess);
-void axis(unsigned int& cubeVAO, Shader& lightingShader);
 void bed(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 alTogether);
-void floor(unsigned int& cubeVAO, Shader& lightingShader);
-void frontWall(unsigned int& cubeVAO, Shader& lightingShader);
-void triangleStage(unsigned int& triangleVAO, Shader& lightingShader);
-void chair_center(unsigned int& cubeVAO, Shader& lightingShader);
-void chair_left(unsigned int& cubeVAO, Shader& lightingShader, glm::vec3 position);
-void drawRowOfChairs(unsigned int& cubeVAO, Shader& lightingShader);
+void frontWall(BakedScene& scene, RenderQueue& queue, const SharedMesh& cube, Shader& lightingShader);
+void triangleStage(BakedScene& scene, RenderQueue& queue, const SharedMesh& wedge, Shader& lightingShader);
+void queueCube(RenderQueue& queue, const SharedMesh& mesh, Shader& lightingShader, const glm::mat4& model, float r, float g, float b, float shininess);
+void bakeCube(BakedScene& scene, RenderQueue& queue, const SharedMesh& mesh, Shader& lightingShader, glm::mat4 model, float r, float g, float b, float shininess);
+void chair_center(std::vector<glm::mat4>& seats, glm::vec3 position);
+void chair_left(std::vector<glm::mat4>& seats, glm::vec3 position);
+void chair_right(std::vector<glm::mat4>& seats, glm::vec3 position);
+void layoutRowsOfChairs(std::vector<glm::mat4>& seats, const SceneFile& sceneFile);
 void rightWall(unsigned int& cubeVAO, Shader& lightingShader);
-void ambienton_off(Shader& lightingShader);
-void diffuse_on_off(Shader& lightingShader);
-void specular_on_off(Shader& lightingShader);
-void drawCar(Shader& lightingShader, unsigned int& cubeVAO, unsigned int& triangleVAO);
-void drawDoors(Shader& lightingShaderWithTexture, Door& door, glm::mat4 identityMatrix);
-unsigned int loadTexture(char const* path, GLenum textureWrappingModeS, GLenum textureWrappingModeT, GLenum textureFilteringModeMin, GLenum textureFilteringModeMax);
+void ambienton_off();
+void diffuse_on_off();
+void specular_on_off();
+void drawCar(RenderQueue& queue, Shader& lightingShader, const SharedMesh& cube, const SharedMesh& wedge, CylinderNoTex& wheel);
+bool buildTextures(const char* scenePath);
+void drawDoors(RenderQueue& queue, Shader& lightingShaderWithTexture, Door& door, glm::mat4 identityMatrix);
+void doorPortals(CellPortals& portals);
 
 
 
@@ -82,11 +104,16 @@ glm::mat4 myProjection(float left, float right, float bottom, float top, float n
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
+int framebufferWidth = SCR_WIDTH;
+int framebufferHeight = SCR_HEIGHT;
 
 // Time management
 double lastKeyPressTime = 0.0;
 const double keyPressDelay = 0.2; // delay in seconds
 
+// how far, in world units, a curved surface may stray from the true one at its largest placement
+const float curvedSurfaceTolerance = 0.1f;
+
 // modelling transform
 float rotationAngle = 0.0f;
 float rotateAngle_X = 0.0;
@@ -114,928 +141,23 @@ glm::vec3 V = glm::vec3(0.0f, 1.0f, 0.0f);
 BasicCamera basic_camera(eyeX, eyeY, eyeZ, lookAtX, lookAtY, lookAtZ, V);
 
 
-// positions of the point lights
-glm::vec3 pointLightPositions[] = {
-    
-    ///4 street lamp front
-
-    glm::vec3(-30.5f, 4.0f, 14.5f),
-    glm::vec3(-30.5f, 4.0f, -15.5f),
-    glm::vec3(-48.5f, 4.0f, 14.5f),
-    glm::vec3(-48.5f,  4.0f, -15.5f),
-
-
-    //// center inside lights
-    glm::vec3(-7.5, 10.7, 0.0),
-    glm::vec3(-7.5, 10.7, 5.0),
-    glm::vec3(-7.5, 10.7, -5.0),
-
-
-    glm::vec3(-9.8, 10.5, 0.0),
-    glm::vec3(-9.8, 10.5, 5.0),
-    glm::vec3(-9.8, 10.5, -5.0),
-
-    glm::vec3(-11.9, 10.3, 0.0),
-    glm::vec3(-11.9, 10.3, 5.0),
-    glm::vec3(-11.9, 10.3, -5.0),
-
-    glm::vec3(-14.0, 10.1, 0.0),
-    glm::vec3(-14.0, 10.1, 5.0),
-    glm::vec3(-14.0, 10.1, -5.0),
-
-    glm::vec3(-16.1, 9.9, 0.0),
-    glm::vec3(-16.1, 9.9, 5.0),
-    glm::vec3(-16.1, 9.9, -5.0),
-
-    glm::vec3(-18.2, 9.7, 0.0),
-    glm::vec3(-18.2, 9.7, 5.0),
-    glm::vec3(-18.2, 9.7, -5.0),
-
-
-    // right inside lights
-    glm::vec3(-7.2, 10.7, -8.5),
-    glm::vec3(-5.2, 10.7, -13.5),
-    glm::vec3(-3.2, 10.7, -18.5),
-
-
-    glm::vec3(-9.6, 10.5, -8.5),
-    glm::vec3(-7.9, 10.5, -13.5),
-    glm::vec3(-5.9, 10.5, -18.5),
-
-    glm::vec3(-12.0, 10.3, -8.5),
-    glm::vec3(-10.6, 10.3, -13.5),
-    glm::vec3(-8.6, 10.3, -18.5),
-
-    glm::vec3(-14.0, 10.1, -8.5),
-    glm::vec3(-13.0, 10.1, -13.5),
-    glm::vec3(-11.5, 10.1, -18.5),
-
-    glm::vec3(-16.5, 9.9, -8.5),
-    glm::vec3(-15.5, 9.9, -13.5),
-    glm::vec3(-14.3, 9.9, -18.5),
-
-    glm::vec3(-19.0, 9.7, -8.5),
-    glm::vec3(-18.2, 9.7, -13.5),
-    glm::vec3(-17.0, 9.7, -18.5),
-
-
-    // left inside lights
-    glm::vec3(-7.2, 10.7, 8.5),
-    glm::vec3(-5.2, 10.7, 13.5),
-    glm::vec3(-3.2, 10.7, 18.5),
-
-
-    glm::vec3(-9.6, 10.5, 8.5),
-    glm::vec3(-7.9, 10.5, 13.5),
-    glm::vec3(-5.9, 10.5, 18.5),
-
-    glm::vec3(-12.0, 10.3, 8.5),
-    glm::vec3(-10.6, 10.3, 13.5),
-    glm::vec3(-8.6, 10.3, 18.5),
-
-    glm::vec3(-14.0, 10.1, 8.5),
-    glm::vec3(-13.0, 10.1, 13.5),
-    glm::vec3(-11.5, 10.1, 18.5),
-
-    glm::vec3(-16.5, 9.9, 8.5),
-    glm::vec3(-15.5, 9.9, 13.5),
-    glm::vec3(-14.3, 9.9, 18.5),
-
-    glm::vec3(-19.0, 9.7, 8.5),
-    glm::vec3(-18.2, 9.7, 13.5),
-    glm::vec3(-17.0, 9.7, 18.5),
-
-
-    // left outside lamps
-    glm::vec3(-40.5f, 4.0f, 45.0f),
-    glm::vec3(-22.5f, 4.0f, 45.0f),
-    glm::vec3(-4.5f, 4.0f, 45.0f),
-    glm::vec3(13.5f, 4.0f, 45.0f),
-
-    glm::vec3(-4.5f, 4.0f, 28.0f),
-    glm::vec3(15.0f, 4.0f, 28.0f),
-
-
-    
-
-    //right outside lamps
-  /*  glm::vec3(-30.5f, 4.0f, -30.5f),
-    glm::vec3(-48.5f,  4.0f, -30.5f),*/
-
-
-    
-};
-
-
-
-PointLight pointlight1(
-
-    pointLightPositions[0].x, pointLightPositions[0].y, pointLightPositions[0].z,  // position
-    0.5f, 0.5f, 0.5f,     // ambient
-    0.8f, 0.8f, 0.8f,     // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    1       // light number
-);
-PointLight pointlight2(
-
-    pointLightPositions[1].x, pointLightPositions[1].y, pointLightPositions[1].z,  // position
-    0.5f, 0.5f, 0.5f,     // ambient
-    0.8f, 0.8f, 0.8f,     // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    2       // light number
-);
-PointLight pointlight3(
-
-    pointLightPositions[2].x, pointLightPositions[2].y, pointLightPositions[2].z,  // position
-    0.5f, 0.5f, 0.5f,     // ambient
-    0.8f, 0.8f, 0.8f,     // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    3       // light number
-);
-PointLight pointlight4(
-
-    pointLightPositions[3].x, pointLightPositions[3].y, pointLightPositions[3].z,  // position
-    0.5f, 0.5f, 0.5f,     // ambient
-    0.8f, 0.8f, 0.8f,     // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    4       // light number
-);
-
-
-PointLight pointlight5(
-    pointLightPositions[4].x, pointLightPositions[4].y, pointLightPositions[4].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    5       // light number
-);
-
-PointLight pointlight6(
-    pointLightPositions[5].x, pointLightPositions[5].y, pointLightPositions[5].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    6       // light number
-);
-
-PointLight pointlight7(
-    pointLightPositions[6].x, pointLightPositions[6].y, pointLightPositions[6].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    7       // light number
-);
-
-PointLight pointlight8(
-    pointLightPositions[7].x, pointLightPositions[7].y, pointLightPositions[7].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    8       // light number
-);
-
-PointLight pointlight9(
-    pointLightPositions[8].x, pointLightPositions[8].y, pointLightPositions[8].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    9       // light number
-);
-
-PointLight pointlight10(
-    pointLightPositions[9].x, pointLightPositions[9].y, pointLightPositions[9].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    10       // light number
-);
-
-PointLight pointlight11(
-    pointLightPositions[10].x, pointLightPositions[10].y, pointLightPositions[10].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    11       // light number
-);
-
-PointLight pointlight12(
-    pointLightPositions[11].x, pointLightPositions[11].y, pointLightPositions[11].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    12       // light number
-);
-
-PointLight pointlight13(
-    pointLightPositions[12].x, pointLightPositions[12].y, pointLightPositions[12].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    13       // light number
-);
-
-PointLight pointlight14(
-    pointLightPositions[13].x, pointLightPositions[13].y, pointLightPositions[13].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    14       // light number
-);
-
-PointLight pointlight15(
-    pointLightPositions[14].x, pointLightPositions[14].y, pointLightPositions[14].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    15       // light number
-);
-
-PointLight pointlight16(
-    pointLightPositions[15].x, pointLightPositions[15].y, pointLightPositions[15].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    16       // light number
-);
-
-PointLight pointlight17(
-    pointLightPositions[16].x, pointLightPositions[16].y, pointLightPositions[16].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    17       // light number
-);
-
-PointLight pointlight18(
-    pointLightPositions[17].x, pointLightPositions[17].y, pointLightPositions[17].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    18       // light number
-);
-
-PointLight pointlight19(
-    pointLightPositions[18].x, pointLightPositions[18].y, pointLightPositions[18].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    19       // light number
-);
-
-PointLight pointlight20(
-    pointLightPositions[19].x, pointLightPositions[19].y, pointLightPositions[19].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    20       // light number
-);
-
-PointLight pointlight21(
-    pointLightPositions[20].x, pointLightPositions[20].y, pointLightPositions[20].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    21       // light number
-);
-
-PointLight pointlight22(
-    pointLightPositions[21].x, pointLightPositions[21].y, pointLightPositions[21].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    22       // light number
-);
-
-PointLight pointlight23(
-    pointLightPositions[22].x, pointLightPositions[22].y, pointLightPositions[22].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    23       // light number
-);
-
-PointLight pointlight24(
-    pointLightPositions[23].x, pointLightPositions[23].y, pointLightPositions[23].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    24       // light number
-);
-
-PointLight pointlight25(
-    pointLightPositions[24].x, pointLightPositions[24].y, pointLightPositions[24].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    25       // light number
-);
-
-PointLight pointlight26(
-    pointLightPositions[25].x, pointLightPositions[25].y, pointLightPositions[25].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    26       // light number
-);
-
-PointLight pointlight27(
-    pointLightPositions[26].x, pointLightPositions[26].y, pointLightPositions[26].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    27       // light number
-);
-
-PointLight pointlight28(
-    pointLightPositions[27].x, pointLightPositions[27].y, pointLightPositions[27].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    28       // light number
-);
-
-PointLight pointlight29(
-    pointLightPositions[28].x, pointLightPositions[28].y, pointLightPositions[28].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    29       // light number
-);
-
-PointLight pointlight30(
-
-    pointLightPositions[29].x, pointLightPositions[29].y, pointLightPositions[29].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    30       // light number
-);
-
-PointLight pointlight31(
-
-    pointLightPositions[30].x, pointLightPositions[30].y, pointLightPositions[30].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    31       // light number
-);
-
-PointLight pointlight32(
-
-    pointLightPositions[31].x, pointLightPositions[31].y, pointLightPositions[31].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    32       // light number
-);
-
-PointLight pointlight33(
-
-    pointLightPositions[32].x, pointLightPositions[32].y, pointLightPositions[32].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    33       // light number
-);
-
-PointLight pointlight34(
-
-    pointLightPositions[33].x, pointLightPositions[33].y, pointLightPositions[33].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    34       // light number
-);
-
-PointLight pointlight35(
-
-    pointLightPositions[34].x, pointLightPositions[34].y, pointLightPositions[34].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    35       // light number
-);
-
-PointLight pointlight36(
-
-    pointLightPositions[35].x, pointLightPositions[35].y, pointLightPositions[35].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    36       // light number
-);
-
-PointLight pointlight37(
-
-    pointLightPositions[36].x, pointLightPositions[36].y, pointLightPositions[36].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    37       // light number
-);
-
-PointLight pointlight38(
-
-    pointLightPositions[37].x, pointLightPositions[37].y, pointLightPositions[37].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    38       // light number
-);
-
-PointLight pointlight39(
-
-    pointLightPositions[38].x, pointLightPositions[38].y, pointLightPositions[38].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    39      // light number
-);
-
-PointLight pointlight40(
-
-    pointLightPositions[39].x, pointLightPositions[39].y, pointLightPositions[39].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    40       // light number
-);
-
-PointLight pointlight41(
-    pointLightPositions[40].x, pointLightPositions[40].y, pointLightPositions[40].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    41       // light number
-);
-
-PointLight pointlight42(
-    pointLightPositions[41].x, pointLightPositions[41].y, pointLightPositions[41].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    42       // light number
-);
-
-PointLight pointlight43(
-    pointLightPositions[42].x, pointLightPositions[42].y, pointLightPositions[42].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    43       // light number
-);
-
-PointLight pointlight44(
-    pointLightPositions[43].x, pointLightPositions[43].y, pointLightPositions[43].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    44       // light number
-);
-
-PointLight pointlight45(
-    pointLightPositions[44].x, pointLightPositions[44].y, pointLightPositions[44].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    45       // light number
-);
-
-PointLight pointlight46(
-    pointLightPositions[45].x, pointLightPositions[45].y, pointLightPositions[45].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    46       // light number
-);
-
-PointLight pointlight47(
-    pointLightPositions[46].x, pointLightPositions[46].y, pointLightPositions[46].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    47       // light number
-);
-
-PointLight pointlight48(
-    pointLightPositions[47].x, pointLightPositions[47].y, pointLightPositions[47].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    48       // light number
-);
-
-PointLight pointlight49(
-    pointLightPositions[48].x, pointLightPositions[48].y, pointLightPositions[48].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    49       // light number
-);
-
-PointLight pointlight50(
-    pointLightPositions[49].x, pointLightPositions[49].y, pointLightPositions[49].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    50       // light number
-);
-
-PointLight pointlight51(
-    pointLightPositions[50].x, pointLightPositions[50].y, pointLightPositions[50].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    51       // light number
-);
+// the point and spot lights are read from the scene file (see sceneFile.h) before the first frame
+std::vector<PointLight> pointLightList;
+std::vector<PointLight*> pointLights;  // in LightBlock order
+int numLights = 0;
 
-PointLight pointlight52(
-    pointLightPositions[51].x, pointLightPositions[51].y, pointLightPositions[51].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    52       // light number
-);
-
-PointLight pointlight53(
-    pointLightPositions[52].x, pointLightPositions[52].y, pointLightPositions[52].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    53       // light number
-);
-
-PointLight pointlight54(
-    pointLightPositions[53].x, pointLightPositions[53].y, pointLightPositions[53].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    54       // light number
-);
-
-PointLight pointlight55(
-    pointLightPositions[54].x, pointLightPositions[54].y, pointLightPositions[54].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    55       // light number
-);
-
-PointLight pointlight56(
-    pointLightPositions[55].x, pointLightPositions[55].y, pointLightPositions[55].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    56       // light number
-);
-
-PointLight pointlight57(
-    pointLightPositions[56].x, pointLightPositions[56].y, pointLightPositions[56].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    57       // light number
-);
-
-PointLight pointlight58(
-    pointLightPositions[57].x, pointLightPositions[57].y, pointLightPositions[57].z,  // position
-    0.05f, 0.05f, 0.05f,     // ambient
-    0.2f, 0.2f, 0.2f,     // diffuse
-    0.2f, 0.2f, 0.2f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    58       // light number
-);
-
-
-/// left outside lamps
-
-PointLight pointlight59(
-    pointLightPositions[58].x, pointLightPositions[58].y, pointLightPositions[58].z,  // position
-    0.5f, 0.5f, 0.5f,     // ambient
-    0.8f, 0.8f, 0.8f,     // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    59       // light number
-);
-
-PointLight pointlight60(
-    pointLightPositions[59].x, pointLightPositions[59].y, pointLightPositions[59].z,  // position
-    0.5f, 0.5f, 0.5f,     // ambient
-    0.8f, 0.8f, 0.8f,     // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    60       // light number
-);
-
-PointLight pointlight61(
-    pointLightPositions[60].x, pointLightPositions[60].y, pointLightPositions[60].z,  // position
-    0.5f, 0.5f, 0.5f,     // ambient
-    0.8f, 0.8f, 0.8f,     // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    61       // light number
-);
+std::vector<SpotLight> spotLightList;
+std::vector<SpotLight*> spotLights;
+int numSpotLights = 0;
 
-PointLight pointlight62(
-    pointLightPositions[61].x, pointLightPositions[61].y, pointLightPositions[61].z,  // position
-    0.5f, 0.5f, 0.5f,     // ambient
-    0.8f, 0.8f, 0.8f,     // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    62       // light number
-);
-
-PointLight pointlight63(
-    pointLightPositions[62].x, pointLightPositions[62].y, pointLightPositions[62].z,  // position
-    0.5f, 0.5f, 0.5f,     // ambient
-    0.8f, 0.8f, 0.8f,     // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    63       // light number
-);
 
-PointLight pointlight64(
-    pointLightPositions[63].x, pointLightPositions[63].y, pointLightPositions[63].z,  // position
-    0.5f, 0.5f, 0.5f,     // ambient
+DirectionLight directionalLight(
+    0.0f, -1.0f, 0.0f,    // direction
+    0.2f, 0.2f, 0.2f,     // ambient
     0.8f, 0.8f, 0.8f,     // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    64       // light number
-);
-
-
-
-
-glm::vec3 spotPositions[] = {
-    glm::vec3(5.0f, 3.0f, 0.5f),
-    glm::vec3(8.5f, 3.0f, 11.8f),
-    glm::vec3(8.5f, 3.0f, -11.8f),
-
-    glm::vec3(15.0f, 10.0f, 2.0f),
-    glm::vec3(15.0f, 10.0f, -2.0f),
-
-};
-
-SpotLight spotlight1(
-    spotPositions[0].x, spotPositions[0].y, spotPositions[0].z,  // position
-    1.0f, 1.0f, 1.0f,     // ambient
-    1.0f, 1.0f, 1.0f,      // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    1,       // light number
-    glm::cos(glm::radians(35.5f)),
-    glm::cos(glm::radians(40.0f)),
-    0, -1, 0
-);
-
-SpotLight spotlight2(
-    spotPositions[1].x, spotPositions[1].y, spotPositions[1].z,  // position
-    1.0f, 1.0f, 1.0f,     // ambient
-    1.0f, 1.0f, 1.0f,      // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    2,       // light number
-    glm::cos(glm::radians(20.5f)),
-    glm::cos(glm::radians(25.5f)),
-    0.5, 1, 0
+    1.0f, 1.0f, 1.0f      // specular
 );
 
-SpotLight spotlight3(
-    spotPositions[2].x, spotPositions[2].y, spotPositions[2].z,  // position
-    1.0f, 1.0f, 1.0f,     // ambient
-    1.0f, 1.0f, 1.0f,      // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    3,       // light number
-    glm::cos(glm::radians(20.5f)),
-    glm::cos(glm::radians(25.5f)),
-    0.5, 1, 0
-);
-
-SpotLight spotlight4(
-    spotPositions[3].x, spotPositions[3].y, spotPositions[3].z,  // position
-    1.0f, 1.0f, 1.0f,     // ambient
-    1.0f, 1.0f, 1.0f,      // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    4,       // light number
-    glm::cos(glm::radians(20.5f)),
-    glm::cos(glm::radians(25.0f)),
-    0, -1, 0
-);
-
-SpotLight spotlight5(
-    spotPositions[4].x, spotPositions[4].y, spotPositions[4].z,  // position
-    1.0f, 1.0f, 1.0f,     // ambient
-    1.0f, 1.0f, 1.0f,      // diffuse
-    1.0f, 1.0f, 1.0f,        // specular
-    1.0f,   //k_c
-    0.09f,  //k_l
-    0.032f, //k_q
-    5,       // light number
-    glm::cos(glm::radians(20.5f)),
-    glm::cos(glm::radians(25.0f)),
-    0, -1, 0
-);
-
-
-
-
-
-
 
 // light settings
 bool pointLightOn = true;
@@ -1054,8 +176,59 @@ bool isRotating = false;
 float deltaTime = 0.0f;    // time between current frame and last frame
 float lastFrame = 0.0f;
 
-int main()
+// the profile of the roof, also what --microbenchmark times the Bezier evaluator on
+GLfloat roof_points[] = {
+   0.0,0.0,1.0,
+0.25,0.25,1.0,
+0.5,0.5,1.0,
+0.75,0.25,1.0,
+1.0,0.0,1.0,
+1.25,-0.25,1.0,
+1.50,-0.50,1.0,
+1.75,-0.25,1.0,
+2.0,0.0,1.0,
+2.25,0.25,1.0,
+2.50,0.50,1.0,
+2.75,0.25,1.0,
+3.0,0.0,1.0,
+3.25,-0.25,1.0,
+3.50,-0.50,1.0,
+3.75,-0.25,1.0,
+4.0,0.0,1.0,
+3.75,-0.25,1.0,
+3.5,-0.50,1.0,
+3.25,-0.75,1.0,
+3.0,-0.50,1.0,
+2.75,-0.25,1.0,
+2.5,0.0,1.0,
+2.25,0.25,1.0,
+2.0,0.0,1.0,
+1.75,-0.25,1.0,
+1.5,-0.50,1.0,
+1.25,-0.75,1.0,
+1.0,-0.50,1.0,
+0.75,-0.25,1.0,
+0.5,0.0,1.0,
+0.25,0.25,1.0,
+0.0,0.0,1.0,
+-0.25,-0.25,1.0
+};
+const int roof_degree = (int)(sizeof(roof_points) / sizeof(roof_points[0]) / 3) - 1;
+
+int main(int argc, char** argv)
 {
+    // --build-textures writes the block-compressed copies of the scene's textures and exits (see ddsTexture.h)
+    if (argc == 2 && strcmp(argv[1], "--build-textures") == 0)
+        return buildTextures("auditorium.scene") ? 0 : -1;
+
+    // --microbenchmark [<file.json>] times the geometry generators on the CPU and exits (see benchmark.h)
+    if ((argc == 2 || argc == 3) && strcmp(argv[1], "--microbenchmark") == 0)
+        return GeneratorBenchmark().run(roof_points, roof_degree, argc == 3 ? argv[2] : NULL) ? 0 : -1;
+
+    // --benchmark renders offscreen along a fixed camera path and prints frame statistics (see benchmark.h)
+    FrameBenchmark benchmark;
+    if (!benchmark.parseArguments(argc, argv))
+        return -1;
 
     float fov = glm::radians(45.0f);               // Field of view in radians
     float aspect = 16.0f / 9.0f;                  // Aspect ratio (e.g., 1920x1080 screen)
@@ -1071,9 +244,9 @@ int main()
 
     // glfw: initialize and configure
     // ------------------------------
+    benchmark.hintPlatform();
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    benchmark.hintWindow();
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
 #ifdef __APPLE__
@@ -1082,7 +255,21 @@ int main()
 
     // glfw window creation
     // --------------------
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "CSE 4208: Computer Graphics Laboratory", NULL, NULL);
+    // 4.0 lets the GPU cut the curved surfaces (see tessellatedSurface.h); everything else needs 3.3
+    const char* windowTitle = "CSE 4208: Computer Graphics Laboratory";
+    GLFWwindow* window = NULL;
+    if (benchmark.tessellationEnabled())
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, windowTitle, NULL, NULL);
+    }
+    if (window == NULL)
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, windowTitle, NULL, NULL);
+    }
     if (window == NULL)
     {
         std::cout << "Failed to create GLFW window" << std::endl;
@@ -1091,6 +278,7 @@ int main()
     }
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
     glfwSetKeyCallback(window, key_callback);
     //glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
@@ -1106,7 +294,19 @@ int main()
         return -1;
     }
 
-    // configure global opengl state
+    // headless runs draw into a framebuffer of the window's size instead of the window
+    if (benchmark.active())
+    {
+        if (!benchmark.createTarget(SCR_WIDTH, SCR_HEIGHT))
+        {
+            glfwTerminate();
+            return -1;
+        }
+        framebufferWidth = SCR_WIDTH;
+        framebufferHeight = SCR_HEIGHT;
+    }
+
+    // configure global opengl state
     // -----------------------------
     glEnable(GL_DEPTH_TEST);
 
@@ -1116,133 +316,181 @@ int main()
     Shader lightingShaderWithTexture("vertexShaderForPhongShadingWithTexture.vs", "fragmentShaderForPhongShadingWithTexture.fs");
     //Shader lightingShader("vertexShaderForGouraudShading.vs", "fragmentShaderForGouraudShading.fs");
     Shader ourShader("vertexShader.vs", "fragmentShader.fs");
+    // same lighting as lightingShader with the model matrix taken per instance
+    Shader lightingShaderInstanced("vertexShaderForPhongShadingInstanced.vs", "fragmentShaderForPhongShading.fs");
+    Shader lightingShaderWithTextureInstanced("vertexShaderForPhongShadingWithTextureInstanced.vs", "fragmentShaderForPhongShadingWithTexture.fs");
+    Shader ourShaderInstanced("vertexShaderInstanced.vs", "fragmentShaderInstanced.fs");
+    // the trees of the grounds, branches near the eye and impostors farther away (see forest.h)
+    Shader forestShader("vertexShaderForest.vs", "fragmentShaderForest.fs");
+    // the textured lighting for surfaces the GPU cuts from their control points; without a 4.0
+    // context it stays disabled and they keep their CPU meshes
+    if (benchmark.tessellationEnabled())
+        TessellationPath::shared().enable("vertexShaderForTessellatedSurface.vs", "tessControlShaderForTessellatedSurface.tcs",
+            "tessEvaluationShaderForTessellatedSurface.tes", "fragmentShaderForPhongShadingWithTexture.fs");
+    Shader* tessellatedSurfaceShader = TessellationPath::shared().shader();
+
+    // one light buffer for all lighting programs
+    LightBlock lightBlock;
+    lightBlock.create();
+    lightBlock.bindTo(lightingShader);
+    lightBlock.bindTo(lightingShaderWithTexture);
+    lightBlock.bindTo(lightingShaderInstanced);
+    lightBlock.bindTo(lightingShaderWithTextureInstanced);
+    if (tessellatedSurfaceShader != NULL)
+        lightBlock.bindTo(*tessellatedSurfaceShader);
+    LightClusters lightClusters;
+    lightClusters.create();
+    lightClusters.bindTo(lightingShader);
+    lightClusters.bindTo(lightingShaderWithTexture);
+    lightClusters.bindTo(lightingShaderInstanced);
+    lightClusters.bindTo(lightingShaderWithTextureInstanced);
+    if (tessellatedSurfaceShader != NULL)
+        lightClusters.bindTo(*tessellatedSurfaceShader);
+    MaterialTable::shared().create();
+    MaterialTable::shared().bindTo(lightingShader);
+    MaterialTable::shared().bindTo(lightingShaderInstanced);
+
+    // the layout of the hall: textures, materials, lights, seats and static objects
+    SceneFile sceneFile;
+    if (!sceneFile.load("auditorium.scene"))
+    {
+        glfwTerminate();
+        return -1;
+    }
 
-
-    GLfloat roof_points[] = {
-   0.0,0.0,1.0,
-0.25,0.25,1.0,
-0.5,0.5,1.0,
-0.75,0.25,1.0,
-1.0,0.0,1.0,
-1.25,-0.25,1.0,
-1.50,-0.50,1.0,
-1.75,-0.25,1.0,
-2.0,0.0,1.0,
-2.25,0.25,1.0,
-2.50,0.50,1.0,
-2.75,0.25,1.0,
-3.0,0.0,1.0,
-3.25,-0.25,1.0,
-3.50,-0.50,1.0,
-3.75,-0.25,1.0,
-4.0,0.0,1.0,
-3.75,-0.25,1.0,
-3.5,-0.50,1.0,
-3.25,-0.75,1.0,
-3.0,-0.50,1.0,
-2.75,-0.25,1.0,
-2.5,0.0,1.0,
-2.25,0.25,1.0,
-2.0,0.0,1.0,
-1.75,-0.25,1.0,
-1.5,-0.50,1.0,
-1.25,-0.75,1.0,
-1.0,-0.50,1.0,
-0.75,-0.25,1.0,
-0.5,0.0,1.0,
-0.25,0.25,1.0,
-0.0,0.0,1.0,
--0.25,-0.25,1.0
-    };
+    // the lights are numbered in file order; the vectors are filled before any pointer into them is taken
+    pointLightList.reserve(sceneFile.pointLightCount());
+    for (size_t i = 0; i < sceneFile.pointLightCount(); i++)
+    {
+        const ScenePointLight& light = sceneFile.pointLights()[i];
+        pointLightList.push_back(PointLight(light.position.x, light.position.y, light.position.z,
+            light.ambient.x, light.ambient.y, light.ambient.z, light.diffuse.x, light.diffuse.y, light.diffuse.z,
+            light.specular.x, light.specular.y, light.specular.z, light.k_c, light.k_l, light.k_q, (int)i + 1));
+    }
+    for (size_t i = 0; i < pointLightList.size(); i++)
+        pointLights.push_back(&pointLightList[i]);
+    numLights = (int)pointLights.size();
+
+    if (sceneFile.spotLightCount() > NR_SPOT_LIGHTS)
+        std::cout << "The light block holds " << NR_SPOT_LIGHTS << " spot lights; the others in the scene file are ignored" << std::endl;
+    for (size_t i = 0; i < sceneFile.spotLightCount() && i < NR_SPOT_LIGHTS; i++)
+    {
+        const SceneSpotLight& light = sceneFile.spotLights()[i];
+        spotLightList.push_back(SpotLight(light.position.x, light.position.y, light.position.z,
+            light.ambient.x, light.ambient.y, light.ambient.z, light.diffuse.x, light.diffuse.y, light.diffuse.z,
+            light.specular.x, light.specular.y, light.specular.z, light.k_c, light.k_l, light.k_q, (int)i + 1,
+            light.innerCutOff, light.outerCutOff, light.direction.x, light.direction.y, light.direction.z));
+    }
+    for (size_t i = 0; i < spotLightList.size(); i++)
+        spotLights.push_back(&spotLightList[i]);
+    numSpotLights = (int)spotLights.size();
 
 
-    GLfloat sculp_points[] = {
-        -0.3, -1.8, 1.0,
-        -0.8, -1.6, 1.0,
-        -0.9, -1.2, 1.0,
-        -0.8, -0.8, 1.0,
-        -0.7, -0.4, 1.0,
-        -0.2, -0.2, 1.0,
-        0.0, -0.1, 1.0,
-        0.2, 0.0, 1.0,
-        0.7, 0.2, 1.0,
-        0.8, 0.6, 1.0,
-        0.9, 1.0, 1.0,
-        0.8, 1.4, 1.0,
-        0.3, 1.8, 1.0
-    };
 
     
 
 
-  /*  string diffuseMapPath = "container2.png";
-    string specularMapPath = "container2_specular.png";*/
-    string laughEmoPath = "world_map.png";
-    string bitfestPath = "bitfest.jpg";
-    string floor_tiles_path = "Images/floor_tiles_2.jpg";
-    string brick_wall_path = "Images/Bricks_curve_wall.jpg";
-    string tree_pot_path = "Images/tree_pot.jpg";
-    string grass_path = "Images/grass.jpg";
-    string wall_texture_path = "Images/wall_texture.jpg";
-    string stage_texture_path = "Images/stage_texture.jpg";
-    string curtain_texture_path = "Images/curtain_texture.jpg";
-    string roof_texture_path = "Images/roof_texture.jpg";
-    string inside_wall_texture_path = "Images/inside_wall_texture.jpg";
-    string door_texture_path = "Images/door_mirror.png";
-    string door_mirror_texture_path = "Images/door_mirror.png";
-    string car_way_texture_path = "Images/car_way.jpg";
-
-    /*unsigned int diffMap = loadTexture(diffuseMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int specMap = loadTexture(specularMapPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);*/
-    unsigned int laughEmoji = loadTexture(laughEmoPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int bitfest = loadTexture(bitfestPath.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int floor_tiles = loadTexture(floor_tiles_path.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int brick_curve_wall = loadTexture(brick_wall_path.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int tree_pot = loadTexture(tree_pot_path.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int grass = loadTexture(grass_path.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int wall_texture = loadTexture(wall_texture_path.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int stage_texture = loadTexture(stage_texture_path.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int roof_texture = loadTexture(roof_texture_path.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int curtain_texture = loadTexture(curtain_texture_path.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int inside_wall_texture = loadTexture(inside_wall_texture_path.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int door_texture = loadTexture(door_texture_path.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int door_mirror_texture = loadTexture(door_mirror_texture_path.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    unsigned int car_way_texture = loadTexture(car_way_texture_path.c_str(), GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-    //unsigned int laughEmojiv2 = loadTexture(laughEmoPath.c_str(), GL_REPEAT, GL_MIRRORED_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
-
-    Cube cube = Cube(bitfest, bitfest, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-    Cube floor_tiles_cube = Cube(floor_tiles, floor_tiles, 32.0f, 0.0f, 0.0f, 5.0f, 5.0f);
-    Cube stage_design = Cube(stage_texture, stage_texture, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-    Cube curtain_design = Cube(curtain_texture, curtain_texture, 10.0f, 0.0f, 0.0f, 1.0f, 10.0f);
-    Cube2 floor_tiles_steps = Cube2(floor_tiles, floor_tiles, 32.0f, 0.0f, 0.0f, 20.0f, 20.0f);
-    Cube2 wall_tex = Cube2(wall_texture, wall_texture, 32.0f, 0.0f, 0.0f, 10.0f, 10.0f);
-    Cube side_wall = Cube(wall_texture, wall_texture, 32.0f, 0.0f, 0.0f, 10.0f, 10.0f);
-    RightWall right_side_wall = RightWall(inside_wall_texture, inside_wall_texture, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-    RightWall front_side_wall = RightWall(inside_wall_texture, inside_wall_texture, 32.0f, 0.0f, 0.0f, 2.0f, 1.0f);
+    // the textures named by the scene file; the ones below are also used by meshes built here.
+    // They are decoded in the background and show a grey placeholder until they arrive
+    TextureLoader textureLoader(benchmark.textureLoaderThreads());
+    std::unordered_map<std::string, unsigned int> textures;
+    for (size_t i = 0; i < sceneFile.textureCount(); i++)
+    {
+        const SceneTexture& texture = sceneFile.textures()[i];
+        textures[texture.name] = textureLoader.request(texture.path, GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    }
+    unsigned int laughEmoji = textures["laughEmoji"];
+    unsigned int brick_curve_wall = textures["brick_curve_wall"];
+    unsigned int tree_pot = textures["tree_pot"];
+    unsigned int grass = textures["grass"];
+    unsigned int wall_texture = textures["wall_texture"];
+    unsigned int curtain_texture = textures["curtain_texture"];
+    unsigned int door_texture = textures["door_texture"];
+
+    // every mesh lives in the registry until the window closes
+    SceneRegistry scene;
+
+    // the baked scene records its draws here; they are issued sorted by state once per frame
+    RenderQueue renderQueue;
+
+    // the materials the scene file places by name; each one becomes a drawable of the same name,
+    // with the box of its mesh for culling and its triangles as an occluder
+    std::unordered_map<std::string, BakedDrawable> drawables;
+    for (size_t i = 0; i < sceneFile.materialCount(); i++)
+    {
+        const SceneMaterial& material = sceneFile.materials()[i];
+        if (textures.count(material.texture) == 0)
+            std::cout << "Scene material \"" << material.name << "\" uses unknown texture " << material.texture << std::endl;
+        unsigned int map = textures[material.texture];
+        float shininess = material.shininess;
+        glm::vec4 range = material.textureRange;
+        std::string kind = material.kind;
+        if (kind == "Cube")
+        {
+            Cube* mesh = &scene.add<Cube>(material.name, map, map, shininess, range.x, range.y, range.z, range.w);
+            drawables[material.name] = { [mesh, &renderQueue, &lightingShaderWithTexture](const glm::mat4& m) { mesh->queueCubeWithTexture(renderQueue, lightingShaderWithTexture, m); }, mesh->localBounds(), mesh->occluder() };
+        }
+        else if (kind == "Cube2")
+        {
+            Cube2* mesh = &scene.add<Cube2>(material.name, map, map, shininess, range.x, range.y, range.z, range.w);
+            drawables[material.name] = { [mesh, &renderQueue, &lightingShaderWithTexture](const glm::mat4& m) { mesh->queueCubeWithTexture(renderQueue, lightingShaderWithTexture, m); }, mesh->localBounds(), mesh->occluder() };
+        }
+        else if (kind == "RightWall")
+        {
+            RightWall* mesh = &scene.add<RightWall>(material.name, map, map, shininess, range.x, range.y, range.z, range.w);
+            drawables[material.name] = { [mesh, &renderQueue, &lightingShaderWithTexture](const glm::mat4& m) { mesh->queueRightWallWithTexture(renderQueue, lightingShaderWithTexture, m); }, mesh->localBounds(), mesh->occluder() };
+        }
+        else if (kind == "Roof")
+        {
+            Roof* mesh = &scene.add<Roof>(material.name, map, map, shininess, range.x, range.y, range.z, range.w);
+            drawables[material.name] = { [mesh, &renderQueue, &lightingShaderWithTexture](const glm::mat4& m) { mesh->queueRoofWithTexture(renderQueue, lightingShaderWithTexture, m); }, mesh->localBounds(), mesh->occluder() };
+        }
+        else if (kind == "Angular_roof")
+        {
+            Angular_roof* mesh = &scene.add<Angular_roof>(material.name, map, map, shininess, range.x, range.y, range.z, range.w);
+            drawables[material.name] = { [mesh, &renderQueue, &lightingShaderWithTexture](const glm::mat4& m) { mesh->queueCubeWithTexture(renderQueue, lightingShaderWithTexture, m); }, mesh->localBounds(), mesh->occluder() };
+        }
+        else
+            std::cout << "Scene material \"" << material.name << "\" has unknown kind " << kind << std::endl;
+    }
+
+    Cube& curtain_design = scene.add<Cube>("curtain_design", curtain_texture, curtain_texture, 10.0f, 0.0f, 0.0f, 1.0f, 10.0f);
 
     
 
 
     
 
-    Roof center_roof = Roof(roof_texture, roof_texture, 32.0f, 0.0f, 0.0f, 1.0f, 10.0f);
-    Angular_roof right_roof = Angular_roof(roof_texture, roof_texture, 32.0f, 0.0f, 0.0f, 1.0f, 10.0f);
-    Angular_roof left_roof = Angular_roof(roof_texture, roof_texture, 32.0f, 0.0f, 0.0f, 1.0f, 10.0f);
 
-    CubicCurvedWallTex curve_wall_right = CubicCurvedWallTex();
-    CubicCurvedWallTex curve_wall_left = CubicCurvedWallTex();
+    CubicCurvedWallTex& curve_wall_right = scene.add<CubicCurvedWallTex>("curve_wall_right");
+
+    Forest& forest = scene.add<Forest>("forest", sceneFile.trees(), sceneFile.treeCount());
+    forest.bindTo(forestShader);
+    std::cout << "Forest: " << forest.treeCount() << " trees in " << forest.cellCount() << " cells, " << forest.branchTriangles()
+        << " triangles per tree up to " << FOREST_IMPOSTOR_DISTANCE << " units away, impostors beyond" << std::endl;
 
-    FractalTree tree = FractalTree();
+    SphereTex& spheretex = scene.add<SphereTex>("spheretex");
 
-    SphereTex spheretex = SphereTex();
+    Cylinder& treepot = scene.add<Cylinder>("treepot");
 
-    Cylinder treepot = Cylinder();
+    Cylinder& treepot_grass = scene.add<Cylinder>("treepot_grass", 0.8f);
 
-    Cylinder treepot_grass = Cylinder(0.8f);
+    BezierCurve& roof_design = scene.add<BezierCurve>("roof_design", roof_points, 34 * 3, wall_texture);
+
+    // the curved surfaces are cut only as finely as the largest copy the scene file places needs
+    roof_design.setTolerance(curvedSurfaceTolerance / sceneFile.largestScale("roof_design"));
+    curve_wall_right.setTolerance(curvedSurfaceTolerance / sceneFile.largestScale("curve_wall_right"));
+    if (TessellationPath::shared().enabled())
+        std::cout << "Curved surfaces: cut on the GPU from " << TessellationPath::shared().uploadedBytes << " bytes of control points" << std::endl;
+    else
+        std::cout << "Curved surfaces: cut on the CPU, " << roof_design.getTriangleCount() << " triangles in the roof" << std::endl;
 
-    BezierCurve roof_design = BezierCurve(roof_points, 34 * 3, wall_texture);
 
-    BezierSculpt sculpure_design = BezierSculpt(sculp_points, 13 * 3, laughEmoji);
+    // meshes the render loop used to rebuild every frame
+    Door& door = scene.add<Door>("door", door_texture, door_texture, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    Cylinder& street_lamp_base = scene.add<Cylinder>("street_lamp_base", 0.4, 1.0);
+    Cylinder& street_lamp_stand = scene.add<Cylinder>("street_lamp_stand", 0.1, 5.5);
+    CylinderNoTex& wheel = scene.add<CylinderNoTex>("wheel");
 
     
 
@@ -1341,1292 +589,281 @@ int main()
         1.0f, 0.0f, 1.0f, 0.0f, -1.0f, 0.0f,     // 4 - 3
         0.0f, 0.0f, 1.0f, 0.0f, -1.0f, 0.0f,
 
-        //diagonal
-        0.0f, 0.0f, 1.0f, -1.0f, 0.0f, -1.0f,     // 4 - 2
-        0.0f, 1.0f, 1.0f, -1.0f, 0.0f, -1.0f,     // |   |     diagonal / from top
-        1.0f, 0.0f, 0.0f, -1.0f, 0.0f, -1.0f,     // 3 - 1
-        1.0f, 1.0f, 0.0f, -1.0f, 0.0f, -1.0f,
-
-    };
-
-    unsigned int triangle_3d_indices[] = {
-        0,1,2,
-        1,2,3,
-
-        4,5,6,
-        5,6,7,
-
-        8,9,11,
-
-        12,14,15,
-
-
-        16,17,18,
-        17,18,19
-    };
-
-
-
-    unsigned int cubeVAO, cubeVBO, cubeEBO;
-    glGenVertexArrays(1, &cubeVAO);
-    glGenBuffers(1, &cubeVBO);
-    glGenBuffers(1, &cubeEBO);
-
-    glBindVertexArray(cubeVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cube_vertices), cube_vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // vertex normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-    // second, configure the light's VAO (VBO stays the same; the vertices are the same for the light object which is also a 3D cube)
-    unsigned int lightCubeVAO;
-    glGenVertexArrays(1, &lightCubeVAO);
-    glBindVertexArray(lightCubeVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-
-
-    unsigned int triangleVAO, triangleVBO, triangleEBO;
-    glGenVertexArrays(1, &triangleVAO);
-    glGenBuffers(1, &triangleVBO);
-    glGenBuffers(1, &triangleEBO);
-
-    glBindVertexArray(triangleVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, triangleVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(triangle_3d_vertices), triangle_3d_vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, triangleEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(triangle_3d_indices), triangle_3d_indices, GL_STATIC_DRAW);
-
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // vertex normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-    // second, configure the light's VAO (VBO stays the same; the vertices are the same for the light object which is also a 3D cube)
-    unsigned int lightTriangleVAO;
-    glGenVertexArrays(1, &lightTriangleVAO);
-    glBindVertexArray(lightTriangleVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, triangleVBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, triangleEBO);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    /*Cone cone = Cone();*/
-
-    //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-
-
-
-    //ourShader.use();
-    //lightingShader.use();
-
-    // render loop
-    // -----------
-    while (!glfwWindowShouldClose(window))
-    {
-        // per-frame time logic
-        // --------------------
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-
-        // input
-        // -----
-        processInput(window);
-
-        // render
-        // ------
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        glm::mat4 projection = myProjection(left, right, bottom, top, near, far);
-
-        glm::mat4 view = camera.GetViewMatrix();
-
-        // be sure to activate shader when setting uniforms/drawing objects
-        lightingShader.use();
-        lightingShader.setVec3("viewPos", camera.Position);
-        lightingShader.setMat4("projection", projection);
-        lightingShader.setMat4("view", view);
-
-        // pass projection matrix to shader (note that in this case it could change every frame)
-        
-        //glm::mat4 projection = glm::ortho(-2.0f, +2.0f, -1.5f, +1.5f, 0.1f, 100.0f);
-       
-
-        // camera/view transformation
-        
-        //glm::mat4 view = basic_camera.createViewMatrix();
-        
-
-
-        // point light 1
-        pointlight1.setUpPointLight(lightingShader);
-        // point light 2
-        pointlight2.setUpPointLight(lightingShader);
-        // point light 3
-        pointlight3.setUpPointLight(lightingShader);
-        //// point light 4
-        pointlight4.setUpPointLight(lightingShader);
-        pointlight5.setUpPointLight(lightingShader);
-        pointlight6.setUpPointLight(lightingShader);
-        pointlight7.setUpPointLight(lightingShader);
-        pointlight8.setUpPointLight(lightingShader);
-        pointlight9.setUpPointLight(lightingShader);
-        pointlight10.setUpPointLight(lightingShader);
-        pointlight11.setUpPointLight(lightingShader);
-        pointlight12.setUpPointLight(lightingShader);
-        pointlight13.setUpPointLight(lightingShader);
-        pointlight14.setUpPointLight(lightingShader);
-        pointlight15.setUpPointLight(lightingShader);
-        pointlight16.setUpPointLight(lightingShader);
-        pointlight17.setUpPointLight(lightingShader);
-        pointlight18.setUpPointLight(lightingShader);
-        pointlight19.setUpPointLight(lightingShader);
-        pointlight20.setUpPointLight(lightingShader);
-        pointlight21.setUpPointLight(lightingShader);
-        pointlight22.setUpPointLight(lightingShader);
-        pointlight23.setUpPointLight(lightingShader);
-        pointlight24.setUpPointLight(lightingShader);
-        pointlight25.setUpPointLight(lightingShader);
-        pointlight26.setUpPointLight(lightingShader);
-        pointlight27.setUpPointLight(lightingShader);
-        pointlight28.setUpPointLight(lightingShader);
-        pointlight29.setUpPointLight(lightingShader);
-        pointlight30.setUpPointLight(lightingShader);
-        pointlight31.setUpPointLight(lightingShader);
-        pointlight32.setUpPointLight(lightingShader);
-        pointlight33.setUpPointLight(lightingShader);
-        pointlight34.setUpPointLight(lightingShader);
-        pointlight35.setUpPointLight(lightingShader);
-        pointlight36.setUpPointLight(lightingShader);
-        pointlight37.setUpPointLight(lightingShader);
-        pointlight38.setUpPointLight(lightingShader);
-        pointlight39.setUpPointLight(lightingShader);
-        pointlight40.setUpPointLight(lightingShader);
-        pointlight41.setUpPointLight(lightingShader);
-        pointlight42.setUpPointLight(lightingShader);
-        pointlight43.setUpPointLight(lightingShader);
-        pointlight44.setUpPointLight(lightingShader);
-        pointlight45.setUpPointLight(lightingShader);
-        pointlight46.setUpPointLight(lightingShader);
-        pointlight47.setUpPointLight(lightingShader);
-        pointlight48.setUpPointLight(lightingShader);
-        pointlight49.setUpPointLight(lightingShader);
-        pointlight50.setUpPointLight(lightingShader);
-        pointlight51.setUpPointLight(lightingShader);
-        pointlight52.setUpPointLight(lightingShader);
-        pointlight53.setUpPointLight(lightingShader);
-        pointlight54.setUpPointLight(lightingShader);
-        pointlight55.setUpPointLight(lightingShader);
-        pointlight56.setUpPointLight(lightingShader);
-        pointlight57.setUpPointLight(lightingShader);
-        pointlight58.setUpPointLight(lightingShader);
-        pointlight59.setUpPointLight(lightingShader);
-        pointlight60.setUpPointLight(lightingShader);
-        pointlight61.setUpPointLight(lightingShader);
-        pointlight62.setUpPointLight(lightingShader);
-        pointlight63.setUpPointLight(lightingShader);
-        pointlight64.setUpPointLight(lightingShader);
-
-
-
-        spotlight1.setUpspotLight(lightingShader);
-        spotlight2.setUpspotLight(lightingShader);
-        spotlight3.setUpspotLight(lightingShader);
-        spotlight4.setUpspotLight(lightingShader);
-        spotlight5.setUpspotLight(lightingShader);
-
-        lightingShader.setVec3("directionalLight.direction", 0.0f, -1.0f, 0.0f);
-        lightingShader.setVec3("directionalLight.ambient", .2f, .2f, .2f);
-        lightingShader.setVec3("directionalLight.diffuse", .8f, .8f, .8f);
-        lightingShader.setVec3("directionalLight.specular", 1.0f, 1.0f, 1.0f);       
-
-        lightingShader.setBool("directionalLightON", directionalLightOn);
-        
-       
-
-        // Modelling Transformation
-        glm::mat4 identityMatrix = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-        glm::mat4 translateMatrix, rotation, rotateXMatrix, rotateYMatrix, rotateZMatrix, scaleMatrix, model;
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(translate_X, translate_Y, translate_Z));
-        rotateXMatrix = glm::rotate(identityMatrix, glm::radians(rotateAngle_X), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotateYMatrix = glm::rotate(identityMatrix, glm::radians(rotateAngle_Y), glm::vec3(0.0f, 1.0f, 0.0f));
-        rotateZMatrix = glm::rotate(identityMatrix, glm::radians(rotateAngle_Z), glm::vec3(0.0f, 0.0f, 1.0f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(scale_X, scale_Y, scale_Z));
-        model = translateMatrix * rotateXMatrix * rotateYMatrix * rotateZMatrix * scaleMatrix;
-        lightingShader.setMat4("model", model);
-
-
-        lightingShaderWithTexture.use();
-        lightingShaderWithTexture.setVec3("viewPos", camera.Position);
-        lightingShaderWithTexture.setMat4("projection", projection);
-        lightingShaderWithTexture.setMat4("view", view);
-        //// point light 1
-        pointlight1.setUpPointLight(lightingShaderWithTexture);
-        //// point light 2
-        pointlight2.setUpPointLight(lightingShaderWithTexture);
-        //// point light 3
-        pointlight3.setUpPointLight(lightingShaderWithTexture);
-        ////// point light 4
-        pointlight4.setUpPointLight(lightingShaderWithTexture);
-        pointlight5.setUpPointLight(lightingShaderWithTexture);
-        pointlight6.setUpPointLight(lightingShaderWithTexture);
-        pointlight7.setUpPointLight(lightingShaderWithTexture);
-        pointlight8.setUpPointLight(lightingShaderWithTexture);
-        pointlight9.setUpPointLight(lightingShaderWithTexture);
-        pointlight10.setUpPointLight(lightingShaderWithTexture);
-        pointlight11.setUpPointLight(lightingShaderWithTexture);
-        pointlight12.setUpPointLight(lightingShaderWithTexture);
-        pointlight13.setUpPointLight(lightingShaderWithTexture);
-        pointlight14.setUpPointLight(lightingShaderWithTexture);
-        pointlight15.setUpPointLight(lightingShaderWithTexture);
-        pointlight16.setUpPointLight(lightingShaderWithTexture);
-        pointlight17.setUpPointLight(lightingShaderWithTexture);
-        pointlight18.setUpPointLight(lightingShaderWithTexture);
-        pointlight19.setUpPointLight(lightingShaderWithTexture);
-        pointlight20.setUpPointLight(lightingShaderWithTexture);
-        pointlight21.setUpPointLight(lightingShaderWithTexture);
-        pointlight22.setUpPointLight(lightingShaderWithTexture);
-        pointlight23.setUpPointLight(lightingShaderWithTexture);
-        pointlight24.setUpPointLight(lightingShaderWithTexture);
-        pointlight25.setUpPointLight(lightingShaderWithTexture);
-        pointlight26.setUpPointLight(lightingShaderWithTexture);
-        pointlight27.setUpPointLight(lightingShaderWithTexture);
-        pointlight28.setUpPointLight(lightingShaderWithTexture);
-        pointlight29.setUpPointLight(lightingShaderWithTexture);
-        pointlight30.setUpPointLight(lightingShaderWithTexture);
-        pointlight31.setUpPointLight(lightingShaderWithTexture);
-        pointlight32.setUpPointLight(lightingShaderWithTexture);
-        pointlight33.setUpPointLight(lightingShaderWithTexture);
-        pointlight34.setUpPointLight(lightingShaderWithTexture);
-        pointlight35.setUpPointLight(lightingShaderWithTexture);
-        pointlight36.setUpPointLight(lightingShaderWithTexture);
-        pointlight37.setUpPointLight(lightingShaderWithTexture);
-        pointlight38.setUpPointLight(lightingShaderWithTexture);
-        pointlight39.setUpPointLight(lightingShaderWithTexture);
-        pointlight40.setUpPointLight(lightingShaderWithTexture);
-        pointlight41.setUpPointLight(lightingShaderWithTexture);
-        pointlight42.setUpPointLight(lightingShaderWithTexture);
-        pointlight43.setUpPointLight(lightingShaderWithTexture);
-        pointlight44.setUpPointLight(lightingShaderWithTexture);
-        pointlight45.setUpPointLight(lightingShaderWithTexture);
-        pointlight46.setUpPointLight(lightingShaderWithTexture);
-        pointlight47.setUpPointLight(lightingShaderWithTexture);
-        pointlight48.setUpPointLight(lightingShaderWithTexture);
-        pointlight49.setUpPointLight(lightingShaderWithTexture);
-        pointlight50.setUpPointLight(lightingShaderWithTexture);
-        pointlight51.setUpPointLight(lightingShaderWithTexture);
-        pointlight52.setUpPointLight(lightingShaderWithTexture);
-        pointlight53.setUpPointLight(lightingShaderWithTexture);
-        pointlight54.setUpPointLight(lightingShaderWithTexture);
-        pointlight55.setUpPointLight(lightingShaderWithTexture);
-        pointlight56.setUpPointLight(lightingShaderWithTexture);
-        pointlight57.setUpPointLight(lightingShaderWithTexture);
-        pointlight58.setUpPointLight(lightingShaderWithTexture);
-        pointlight59.setUpPointLight(lightingShaderWithTexture);
-        pointlight60.setUpPointLight(lightingShaderWithTexture);
-        pointlight61.setUpPointLight(lightingShaderWithTexture);
-        pointlight62.setUpPointLight(lightingShaderWithTexture);
-        pointlight63.setUpPointLight(lightingShaderWithTexture);
-        pointlight64.setUpPointLight(lightingShaderWithTexture);
-
-
-
-        spotlight1.setUpspotLight(lightingShaderWithTexture);
-        spotlight2.setUpspotLight(lightingShaderWithTexture);
-        spotlight3.setUpspotLight(lightingShaderWithTexture);
-        spotlight4.setUpspotLight(lightingShaderWithTexture);
-        spotlight5.setUpspotLight(lightingShaderWithTexture);
-
-
-        lightingShaderWithTexture.setVec3("directionalLight.direction", 0.0f, -1.0f, 0.0f);
-        lightingShaderWithTexture.setVec3("directionalLight.ambient", .2f, .2f, .2f);
-        lightingShaderWithTexture.setVec3("directionalLight.diffuse", .8f, .8f, .8f);
-        lightingShaderWithTexture.setVec3("directionalLight.specular", 1.0f, 1.0f, 1.0f);
-
-        lightingShaderWithTexture.setBool("directionLightOn", directionalLightOn);
-
-       
-
-
-
-
-        ///............................... Object drawing....................................////
-
-        ///......................stage design................./////
-
-        glm::mat4 modelMatrixForContainer2 = glm::mat4(1.0f);
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.5f, -12.0f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(6.0f, 11.0f, 4.0f));
-        model = translateMatrix * scaleMatrix;
-        stage_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.5f, 12.0f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(6.0f, 11.0f, 4.0f));
-        model = translateMatrix * scaleMatrix;
-        stage_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 10.0f, 0.0f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(6.0f, 28.0f, 2.0f));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        stage_design.drawCubeWithTexture(lightingShaderWithTexture, model); 
-
-
-        ///......................stage curtain draw......................./////
-
-        // front right curtain
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(10.0f, 4.8f, -9.7f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(10.0f, 4.8f, -9.2f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(-45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(10.0f, 4.8f, -8.7f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-       
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(10.0f, 4.8f, -8.2f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(-45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(10.0f, 4.8f, -7.7f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(10.0f, 4.8f, -7.2f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(-45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-
-
-        //front left curtain
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(10.0f, 4.8f, 9.7f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(10.0f, 4.8f, 9.2f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(-45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(10.0f, 4.8f, 8.7f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(10.0f, 4.8f, 8.2f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(-45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(10.0f, 4.8f, 7.7f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(10.0f, 4.8f, 7.2f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(-45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-
-
-        // back right curtain
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.8f, -9.4f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.8f, -8.9f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(-45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.8f, -8.4f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.8f, -7.9f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(-45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.8f, -7.4f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.8f, -6.9f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(-45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-
-        // back left curtain
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.8f, 9.4f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.8f, 8.9f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(-45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.8f, 8.4f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.8f, 7.9f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(-45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.8f, 7.4f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(12.0f, 4.8f, 6.9f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.01f, 8.5f, 0.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(-45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        curtain_design.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-
-
-
-        glm::mat4 translate = glm::mat4(1.0f);
-        //glm::mat4 translate2 = glm::mat4(1.0f);
-        glm::mat4 scale = glm::mat4(1.0f);
-
-
-
-        /// sphere draw
-
-        if (isRotating) {
-            rotationAngle += 1.0f;  // Adjust this value to control rotation speed
-            if (rotationAngle >= 360.0f) {
-                rotationAngle -= 360.0f;  // Reset to prevent overflow
-            }
-        }
-
-
-
-        glm::mat4 modelMatrixForContainer = glm::mat4(1.0f);
-        modelMatrixForContainer = glm::translate(modelMatrixForContainer, glm::vec3(6.0f, 1.4f, 3.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(rotationAngle), glm::vec3(0.0f, 1.0f, 0.0f));
-        modelMatrixForContainer = modelMatrixForContainer * rotation;
-        spheretex.drawSphere(lightingShaderWithTexture,laughEmoji ,modelMatrixForContainer);
-
-        ///roof design
-
-        modelMatrixForContainer = glm::mat4(1.0f);
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-4.0f, 16.0f, 0.0f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(9.0f, 15.0f, 9.0f));
-        modelMatrixForContainer = translateMatrix * scaleMatrix;
-        roof_design.drawBezierCurve(lightingShaderWithTexture, modelMatrixForContainer);
-
-
-        ///roof drawing and light placement
-
-        //Center 1st step
-        scale = glm::scale(identityMatrix, glm::vec3(16.6, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-14.7, 11.0, 0.0));
-        model = translate * scale;
-        center_roof.drawRoofWithTexture(lightingShaderWithTexture, model);
-
-
-
-        //center 2nd step
-        scale = glm::scale(identityMatrix, glm::vec3(14.4, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-15.8, 10.8, 0.0));
-        model = translate * scale;
-        center_roof.drawRoofWithTexture(lightingShaderWithTexture, model);
-
-        //center 3rd step
-        scale = glm::scale(identityMatrix, glm::vec3(12.2, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-16.9, 10.6, 0.0));
-        model = translate * scale;
-        center_roof.drawRoofWithTexture(lightingShaderWithTexture, model);
-
-        //center 4th step
-        scale = glm::scale(identityMatrix, glm::vec3(10.0, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-18.0, 10.4, 0.0));
-        model = translate * scale;
-        center_roof.drawRoofWithTexture(lightingShaderWithTexture, model);
-
-        //center 5th step
-        scale = glm::scale(identityMatrix, glm::vec3(7.8, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-19.1, 10.2, 0.0));
-        model = translate * scale;
-        center_roof.drawRoofWithTexture(lightingShaderWithTexture, model);
-
-        //center 6th step
-        scale = glm::scale(identityMatrix, glm::vec3(5.6, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-20.2, 10.0, 0.0));
-        model = translate * scale;
-        center_roof.drawRoofWithTexture(lightingShaderWithTexture, model);
-
-
-
-
-        //right angular 1st step
-        scale = glm::scale(identityMatrix, glm::vec3(22.13, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-11.94, 11.0, -13.75));
-        /*rotation = glm::rotate(identityMatrix, glm::radians(30.0f), glm::vec3(0.0f, 1.0f, 0.0f));*/
-        model = translate * scale;
-        right_roof.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //right angular 2nd step
-        scale = glm::scale(identityMatrix, glm::vec3(19.2, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-13.40, 10.8, -13.75));
-
-        model = translate * scale;
-        right_roof.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //right angular 3rd step
-        scale = glm::scale(identityMatrix, glm::vec3(16.27, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-14.87, 10.6, -13.75));
-
-        model = translate * scale;
-        right_roof.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //right angular 4th step
-        scale = glm::scale(identityMatrix, glm::vec3(13.34, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-16.34, 10.4, -13.75));
-
-        model = translate * scale;
-        right_roof.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //right angular 5th step
-        scale = glm::scale(identityMatrix, glm::vec3(10.41, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-17.805, 10.2, -13.75));
-
-        model = translate * scale;
-        right_roof.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //right angular 6th step
-        scale = glm::scale(identityMatrix, glm::vec3(7.48, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-19.27, 10.0, -13.75));
-
-        model = translate * scale;
-        right_roof.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-
-
-        //left angular 1st step
-        scale = glm::scale(identityMatrix, glm::vec3(22.13, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-11.92, 11.0, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        left_roof.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //left angular 2nd step
-        scale = glm::scale(identityMatrix, glm::vec3(19.2, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-13.39, 10.8, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        left_roof.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //left angular 3rd step
-        scale = glm::scale(identityMatrix, glm::vec3(16.27, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-14.86, 10.6, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        left_roof.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //left angular 4th step
-        scale = glm::scale(identityMatrix, glm::vec3(13.34, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-16.33, 10.4, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        left_roof.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //left angular 5th step
-        scale = glm::scale(identityMatrix, glm::vec3(10.41, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-17.80, 10.2, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        left_roof.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //left angular 6th step
-        scale = glm::scale(identityMatrix, glm::vec3(7.48, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-19.27, 10.0, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        left_roof.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-
-
-
-        // right curved wall
-        
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-18.0f, 3.0f, -10.0f));
-        rotation = glm::rotate(identityMatrix, glm::radians(150.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(1.2f, 0.8f, 1.8f));
-        modelMatrixForContainer = translateMatrix * rotation * scaleMatrix;
-        curve_wall_right.drawCubicCurvedWall(lightingShaderWithTexture,brick_curve_wall, modelMatrixForContainer);
-
-
-        // left curved wall
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-10.0f, 3.0f, 13.0f));
-        rotation = glm::rotate(identityMatrix, glm::radians(100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        rotateXMatrix = glm::rotate(rotation, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(1.45f, 0.8f, 1.8f));
-        modelMatrixForContainer = translateMatrix * rotateXMatrix * scaleMatrix;
-        curve_wall_right.drawCubicCurvedWall(lightingShaderWithTexture, brick_curve_wall, modelMatrixForContainer);
-
-
-
-       
-
-
-
-        //right wall straight outside 1st
-        scale = glm::scale(identityMatrix, glm::vec3(10.0, 0.3, 6.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-8.0, 2.2, -24.5));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotateXMatrix = glm::rotate(rotation, glm::radians(-10.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = translate * rotateXMatrix * scale;
-        wall_tex.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //right wall straight outside 2nd
-        scale = glm::scale(identityMatrix, glm::vec3(10.0, 0.3, 4.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-4.0, 1.2, -23.0));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotateXMatrix = glm::rotate(rotation, glm::radians(-5.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = translate * rotateXMatrix * scale;
-        wall_tex.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-        //left wall straight outside 1st
-        scale = glm::scale(identityMatrix, glm::vec3(10.0, 0.3, 6.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-8.0, 2.2, 24.5));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotateXMatrix = glm::rotate(rotation, glm::radians(10.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = translate * rotateXMatrix * scale;
-        wall_tex.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //left wall straight outside 2nd
-        scale = glm::scale(identityMatrix, glm::vec3(10.0, 0.3, 4.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-4.0, 1.2, 23));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotateXMatrix = glm::rotate(rotation, glm::radians(5.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = translate * rotateXMatrix * scale;
-        wall_tex.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-        ///**********Doors**********/////
-
-        Door door = Door(door_texture, door_texture, 32.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-        drawDoors(lightingShaderWithTexture, door, identityMatrix);
-
-
-        /*/// left door1
-        scale = glm::scale(identityMatrix, glm::vec3(4.0, 4.8, 0.2));
-        translate = glm::translate(identityMatrix, glm::vec3(3.0, 1.6, 19.9));
-        model = translate * scale;
-
-        door.drawDoorWithTexture(lightingShaderWithTexture, model);
-
-        ///left door2
-        scale = glm::scale(identityMatrix, glm::vec3(4.0, 4.8, 0.2));
-        translate = glm::translate(identityMatrix, glm::vec3(7.0, 1.6, 19.9));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translate * rotation * scale;
-
-        door.drawDoorWithTexture(lightingShaderWithTexture, model);
-
-
-        /// right door1
-        scale = glm::scale(identityMatrix, glm::vec3(4.0, 4.8, 0.2));
-        translate = glm::translate(identityMatrix, glm::vec3(3.0, 1.6, -19.9));
-        model = translate * scale;
-
-        door.drawDoorWithTexture(lightingShaderWithTexture, model);
-
-        ///right door2
-        scale = glm::scale(identityMatrix, glm::vec3(4.0, 4.8, 0.2));
-        translate = glm::translate(identityMatrix, glm::vec3(7.0, 1.6, 19.9));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translate * rotation * scale;
-
-        door.drawDoorWithTexture(lightingShaderWithTexture, model);*/
-
-        
-
-        ////......side walls....../////
-
-        ///right
-        scale = glm::scale(identityMatrix, glm::vec3(24.0, 0.2, 12.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-11.0, 5.0, -20.0));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * rotation * scale;
-        side_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //texture
-        scale = glm::scale(identityMatrix, glm::vec3(24.0, 0.2, 12.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-11.0, 5.0, -19.9));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * rotation * scale;
-        right_side_wall.drawRightWallWithTexture(lightingShaderWithTexture, model);
-
-        scale = glm::scale(identityMatrix, glm::vec3(8.0, 0.2, 7.0));
-        translate = glm::translate(identityMatrix, glm::vec3(5.0, 7.5, -20.0));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * rotation * scale;
-        side_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        scale = glm::scale(identityMatrix, glm::vec3(6.5, 0.2, 12.0));
-        translate = glm::translate(identityMatrix, glm::vec3(12.2, 5.0, -20.0));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * rotation * scale;
-        side_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-
-        ///left
-        scale = glm::scale(identityMatrix, glm::vec3(24.0, 0.2, 12.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-11.0, 5.0, 20.0));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * rotation * scale;
-        side_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //texture
-        scale = glm::scale(identityMatrix, glm::vec3(24.0, 0.2, 12.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-11.0, 5.0, 19.9));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotation = glm::rotate(rotation, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * rotation * scale;
-        right_side_wall.drawRightWallWithTexture(lightingShaderWithTexture, model);
-
-
-        scale = glm::scale(identityMatrix, glm::vec3(8.0, 0.2, 7.0));
-        translate = glm::translate(identityMatrix, glm::vec3(5.0, 7.5, 20.0));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * rotation * scale;
-        side_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        scale = glm::scale(identityMatrix, glm::vec3(6.5, 0.2, 12.0));
-        translate = glm::translate(identityMatrix, glm::vec3(12.2, 5.0, 20.0));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * rotation * scale;
-        side_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-        ///front
-
-        scale = glm::scale(identityMatrix, glm::vec3(40.2, 0.2, 12.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-23.0, 5.0, 0.0));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotation = glm::rotate(rotation, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = translate * rotation * scale;
-        side_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //texture
-        scale = glm::scale(identityMatrix, glm::vec3(40.2, 0.2, 5.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-22.9, 8.0, 0.0));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotation = glm::rotate(rotation, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        rotation = glm::rotate(rotation, glm::radians(180.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = translate * rotation * scale;
-        front_side_wall.drawRightWallWithTexture(lightingShaderWithTexture, model);
-
-
-        /// back
-
-        scale = glm::scale(identityMatrix, glm::vec3(40.2, 0.2, 12.0));
-        translate = glm::translate(identityMatrix, glm::vec3(15.5, 5.0, 0.0));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotation = glm::rotate(rotation, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = translate * rotation * scale;
-        side_wall.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        ////*******outside floor*************/////
-
-        Cube floor_outside = Cube(floor_tiles, floor_tiles, 32.0f, 0.0f, 0.0f, 5.0f, 5.0f);
-
-
-
-        scale = glm::scale(identityMatrix, glm::vec3(100.0, 0.2, 100.0));
-        translate = glm::translate(identityMatrix, glm::vec3(0.0, -1.4, 0.0));
-
-        model = translate * scale;
-
-        floor_outside.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        ///*****car way******////
-
-        Cube car_way = Cube(car_way_texture, car_way_texture, 32.0f, 0.0f, 0.0f, 5.0f, 5.0f);
-
-
-
-        scale = glm::scale(identityMatrix, glm::vec3(10.0, 0.2, 80.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-40.0, -1.2, 0.0));
-
-        model = translate * scale;
-
-        car_way.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-        scale = glm::scale(identityMatrix, glm::vec3(10.0, 0.2, 70.0));
-        translate = glm::translate(identityMatrix, glm::vec3(0.0, -1.2, 35.0));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        
-
-        model = translate * rotation * scale;
-
-        car_way.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-        
-        /// ..... 1st floor........//////
-
-        ///bitfest
-        
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(5.2f, 0.7f, 0.4f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.2f, 0.8f, -1.8f));
-        model = translateMatrix * scaleMatrix;
-        cube.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //Entire floor
-        scale = glm::scale(identityMatrix, glm::vec3(37.0, 0.2, 40.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-3.0, -0.9, 0.0));
-        model = translate * scale;
-        floor_tiles_cube.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-        //Center 1st step
-        scale = glm::scale(identityMatrix, glm::vec3(16.6, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-14.7, -0.7, 0.0));
-        model = translate * scale;
-        floor_tiles_cube.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //center 2nd step
-        scale = glm::scale(identityMatrix, glm::vec3(14.4, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-15.8, -0.5, 0.0));
-        model = translate * scale;
-        floor_tiles_cube.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //center 3rd step
-        scale = glm::scale(identityMatrix, glm::vec3(12.2, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-16.9, -0.3, 0.0));
-        model = translate * scale;
-        floor_tiles_cube.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //center 4th step
-        scale = glm::scale(identityMatrix, glm::vec3(10.0, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-18.0, -0.1, 0.0));
-        model = translate * scale;
-        floor_tiles_cube.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //center 5th step
-        scale = glm::scale(identityMatrix, glm::vec3(7.8, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-19.1, 0.1, 0.0));
-        model = translate * scale;
-        floor_tiles_cube.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //center 6th step
-        scale = glm::scale(identityMatrix, glm::vec3(5.6, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-20.2, 0.3, 0.0));
-        model = translate * scale;
-        floor_tiles_cube.drawCubeWithTexture(lightingShaderWithTexture, model);
-        
-
-
-
-        //right angular 1st step
-        scale = glm::scale(identityMatrix, glm::vec3(22.13, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-11.94, -0.7, -13.75));
-        /*rotation = glm::rotate(identityMatrix, glm::radians(30.0f), glm::vec3(0.0f, 1.0f, 0.0f));*/
-        model = translate * scale;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //right angular 2nd step
-        scale = glm::scale(identityMatrix, glm::vec3(19.2, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-13.40, -0.5, -13.75));
-        
-        model = translate * scale ;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //right angular 3rd step
-        scale = glm::scale(identityMatrix, glm::vec3(16.27, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-14.87, -0.3, -13.75));
-        
-        model = translate * scale;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //right angular 4th step
-        scale = glm::scale(identityMatrix, glm::vec3(13.34, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-16.34, -0.1, -13.75));
-        
-        model = translate * scale;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //right angular 5th step
-        scale = glm::scale(identityMatrix, glm::vec3(10.41, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-17.805, 0.1, -13.75));
-        
-        model = translate * scale;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //right angular 6th step
-        scale = glm::scale(identityMatrix, glm::vec3(7.48, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-19.27, 0.3, -13.75));
-        
-        model = translate * scale;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-
-
-        //left angular 1st step
-        scale = glm::scale(identityMatrix, glm::vec3(22.13, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-11.92, -0.7, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //left angular 2nd step
-        scale = glm::scale(identityMatrix, glm::vec3(19.2, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-13.39, -0.5, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //left angular 3rd step
-        scale = glm::scale(identityMatrix, glm::vec3(16.27, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-14.86, -0.3, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //left angular 4th step
-        scale = glm::scale(identityMatrix, glm::vec3(13.34, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-16.33, -0.1, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //left angular 5th step
-        scale = glm::scale(identityMatrix, glm::vec3(10.41, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-17.80, 0.1, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //left angular 6th step
-        scale = glm::scale(identityMatrix, glm::vec3(7.48, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-19.27, 0.3, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-        ////...........2nd floor..........//////
-
-        //center 4th step
-        scale = glm::scale(identityMatrix, glm::vec3(10.0, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-18.0, 5.0, 0.0));
-        model = translate * scale;
-        floor_tiles_cube.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //center 5th step
-        scale = glm::scale(identityMatrix, glm::vec3(7.8, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-19.1, 5.1, 0.0));
-        model = translate * scale;
-        floor_tiles_cube.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //center 6th step
-        scale = glm::scale(identityMatrix, glm::vec3(5.6, 0.2, 15.0));
-        translate = glm::translate(identityMatrix, glm::vec3(-20.2, 5.3, 0.0));
-        model = translate * scale;
-        floor_tiles_cube.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-        //right angular 4th step
-        scale = glm::scale(identityMatrix, glm::vec3(13.34, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-16.34, 5.0, -13.75));
-
-        model = translate * scale;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //right angular 5th step
-        scale = glm::scale(identityMatrix, glm::vec3(10.41, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-17.805, 5.1, -13.75));
-
-        model = translate * scale;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //right angular 6th step
-        scale = glm::scale(identityMatrix, glm::vec3(7.48, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-19.27, 5.3, -13.75));
-
-        model = translate * scale;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-
-
-        //left angular 4th step
-        scale = glm::scale(identityMatrix, glm::vec3(13.34, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-16.33, 5.0, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //left angular 5th step
-        scale = glm::scale(identityMatrix, glm::vec3(10.41, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-17.80, 5.1, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-        //left angular 6th step
-        scale = glm::scale(identityMatrix, glm::vec3(7.48, 0.2, 12.5));
-        translate = glm::translate(identityMatrix, glm::vec3(-19.27, 5.3, 13.75));
-        rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = translate * scale * rotation;
-        floor_tiles_steps.drawCubeWithTexture(lightingShaderWithTexture, model);
-
-
-        ////.............Outside auditorium...................///////////////
-        /// tree draw left
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-30.0f, 1.0f, 20.0f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(1.0f, 1.0f, 1.8f));
-        model = translateMatrix * scaleMatrix;
-        tree.drawTree(lightingShader, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-30.0f, 1.0f, 20.0f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(1.0f, 1.0f, 1.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        tree.drawTree(lightingShader, model);
-
-
-        ///treepot draw left
-
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-30.0f, 0.0f, 20.0f));
-
-        treepot.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
-
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-30.0f, 0.1f, 20.0f));
-
-        treepot_grass.drawCylinder(lightingShaderWithTexture, grass, modelMatrixForContainer);
-
-
-        /// tree draw right
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-30.0f, 1.0f, -20.0f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(1.0f, 1.0f, 1.8f));
-        model = translateMatrix * scaleMatrix;
-        tree.drawTree(lightingShader, model);
-
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(-30.0f, 1.0f, -20.0f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(1.0f, 1.0f, 1.8f));
-        rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = translateMatrix * rotation * scaleMatrix;
-        tree.drawTree(lightingShader, model);
+        //diagonal
+        0.0f, 0.0f, 1.0f, -1.0f, 0.0f, -1.0f,     // 4 - 2
+        0.0f, 1.0f, 1.0f, -1.0f, 0.0f, -1.0f,     // |   |     diagonal / from top
+        1.0f, 0.0f, 0.0f, -1.0f, 0.0f, -1.0f,     // 3 - 1
+        1.0f, 1.0f, 0.0f, -1.0f, 0.0f, -1.0f,
 
+    };
 
-        ///treepot draw right
+    unsigned int triangle_3d_indices[] = {
+        0,1,2,
+        1,2,3,
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-30.0f, 0.0f, -20.0f));
+        4,5,6,
+        5,6,7,
 
-        treepot.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+        8,9,11,
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-30.0f, 0.1f, -20.0f));
+        12,14,15,
 
-        treepot_grass.drawCylinder(lightingShaderWithTexture, grass, modelMatrixForContainer);
 
+        16,17,18,
+        17,18,19
+    };
 
 
-        /// *********Street lamp*******************////
 
-        ///left lamp1 front
+    // the corner anchored box and wedge the furniture helpers draw with go through the mesh cache as well;
+    // the lit VAOs carry position and normal
+    SharedMesh* cornerCube = MeshCache::shared().create(MeshCache::key("CornerCube"), cube_vertices, sizeof(cube_vertices), 6, cube_indices, sizeof(cube_indices));
+
+    SharedMesh* wedge = MeshCache::shared().create(MeshCache::key("Wedge"), triangle_3d_vertices, sizeof(triangle_3d_vertices), 6, triangle_3d_indices, sizeof(triangle_3d_indices));
+
+    // the seat layout never changes, so every chair of the hall is uploaded once and drawn with one call
+    std::vector<glm::mat4> seatTransforms;
+    layoutRowsOfChairs(seatTransforms, sceneFile);
+    glm::vec3 seatColor = glm::vec3(0.112f, 0.167f, 0.231f);
+    InstancedMesh& seats = scene.add<InstancedMesh>("seats", MeshCache::key("CornerCube"), 6, 2, seatColor, seatColor, glm::vec3(0.5f), 32.0f);
+    seats.setTransforms(seatTransforms);
+
+    // repeated objects that are collected every frame and drawn with one call per mesh and material
+    InstancedBatch& curtains = scene.add<InstancedBatch>("curtains", curtain_design.meshKey(), 8, 3);
+    InstancedBatch& street_lamp_bases = scene.add<InstancedBatch>("street_lamp_bases", street_lamp_base.meshKeys(), 8, 3);
+    InstancedBatch& street_lamp_stands = scene.add<InstancedBatch>("street_lamp_stands", street_lamp_stand.meshKeys(), 8, 3);
+    InstancedBatch& lamp_markers = scene.add<InstancedBatch>("lamp_markers", cornerCube->key, 6, 1);
+
+    // the meshes built above that the scene file may place by name; every baked copy of a
+    // draw carries its own LodState, so each placed node keeps its own level (see lod.h)
+    drawables["roof_design"] = { [&, lod = LodState()](const glm::mat4& m) mutable { roof_design.queueBezierCurve(renderQueue, lightingShaderWithTexture, m, lod); },
+        roof_design.localBounds() };
+    drawables["curve_wall_right"] = { [&, lod = LodState()](const glm::mat4& m) mutable { curve_wall_right.queueCubicCurvedWall(renderQueue, lightingShaderWithTexture, brick_curve_wall, m, lod); },
+        curve_wall_right.localBounds(), curve_wall_right.occluder() };
+    drawables["treepot"] = { [&, lod = LodState()](const glm::mat4& m) mutable { treepot.queueCylinder(renderQueue, lightingShaderWithTexture, tree_pot, m, lod); },
+        treepot.localBounds() };
+    drawables["treepot_grass"] = { [&, lod = LodState()](const glm::mat4& m) mutable { treepot_grass.queueCylinder(renderQueue, lightingShaderWithTexture, grass, m, lod); },
+        treepot_grass.localBounds() };
+    drawables["curtains"] = { [&](const glm::mat4& m) { curtains.add(m); }, curtain_design.localBounds() };
+    drawables["street_lamp_bases"] = { [&, lod = LodState()](const glm::mat4& m) mutable { street_lamp_bases.addAtLevel(m, street_lamp_base.selectLevel(m, lod)); },
+        street_lamp_base.localBounds() };
+    drawables["street_lamp_stands"] = { [&, lod = LodState()](const glm::mat4& m) mutable { street_lamp_stands.addAtLevel(m, street_lamp_stand.selectLevel(m, lod)); },
+        street_lamp_stand.localBounds() };
+
+    // the hall is one cell and the street the other; they see each other through the open doors (see portals.h)
+    CellPortals portals;
+    portals.setInterior(Bounds(glm::vec3(-23.0f, -1.0f, -20.0f), glm::vec3(15.5f, 12.0f, 20.0f)));
+    doorPortals(portals);
+
+    // walls, roofs and floors rasterized on the CPU to skip what they hide (see occlusion.h)
+    OcclusionCuller occlusion;
+
+    // everything that does not move is baked here, once; the render loop only draws it (see bakedScene.h)
+    BakedScene bakedScene;
+    {
+        glm::mat4 identityMatrix = glm::mat4(1.0f);
+        glm::mat4 model;
+
+        // dynamic: the sphere turns with rotationAngle
+        bakedScene.addDynamic([&, lod = LodState()]() mutable {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(6.0f, 1.4f, 3.8f));
+            model = glm::rotate(model, glm::radians(rotationAngle), glm::vec3(0.0f, 1.0f, 0.0f));
+            spheretex.queueSphere(renderQueue, lightingShaderWithTexture, laughEmoji, model, lod);
+        }, CELL_INTERIOR);
+
+        // the static layout of the hall comes from the scene file
+        for (size_t i = 0; i < sceneFile.objectCount(); i++)
+        {
+            const SceneObject& object = sceneFile.objects()[i];
+            std::unordered_map<std::string, BakedDrawable>::const_iterator drawable = drawables.find(object.drawable);
+            if (drawable == drawables.end())
+            {
+                std::cout << "Scene object uses unknown drawable \"" << object.drawable << "\"" << std::endl;
+                continue;
+            }
+            bakedScene.bake(object.model, drawable->second.bounds, drawable->second.draw, drawable->second.occluder);
+        }
 
-        Cylinder street_lamp_base = Cylinder(0.4,1.0);
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-30.0f, -1.0f, 15.0f));
-        street_lamp_base.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+        // dynamic: the doors follow leftDoor1Open and the other door flags
+        bakedScene.addDynamic([&]() { drawDoors(renderQueue, lightingShaderWithTexture, door, glm::mat4(1.0f)); });
 
-        Cylinder street_lamp_stand = Cylinder(0.1, 5.5);
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-30.0f, 1.5f, 15.0f));
-        street_lamp_stand.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+        // dynamic: the car follows carPosition and carRotation
+        bakedScene.addDynamic([&]() { drawCar(renderQueue, lightingShader, *cornerCube, *wedge, wheel); }, CELL_EXTERIOR);
 
-        ///left lamp2 front
-      
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-48.0f, -1.0f, 15.0f));
-        street_lamp_base.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+        frontWall(bakedScene, renderQueue, *cornerCube, lightingShader);
+        triangleStage(bakedScene, renderQueue, *wedge, lightingShader);
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-48.0f, 1.5f, 15.0f));
-        street_lamp_stand.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+        // lamp markers, sized and shaded per light in the scene file
+        for (size_t i = 0; i < sceneFile.pointLightCount(); i++)
+        {
+            const ScenePointLight& light = sceneFile.pointLights()[i];
+            glm::vec4 color = glm::vec4(glm::vec3(light.markerBrightness), 1.0f);
+            model = glm::translate(identityMatrix, light.position);
+            model = glm::scale(model, glm::vec3(light.markerSize));
+            bakedScene.bake(model, cornerCube->bounds, [&lamp_markers, color](const glm::mat4& m) { lamp_markers.add(m, color); });
+        }
+    }
 
-        ///******** outside left lamps ***********//
-        //lamp1
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-40.0f, -1.0f, 45.5f));
-        street_lamp_base.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+    /*Cone cone = Cone();*/
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-40.0f, 1.5f, 45.5f));
-        street_lamp_stand.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+    //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
-        //lamp2
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-22.0f, -1.0f, 45.5f));
-        street_lamp_base.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-22.0f, 1.5f, 45.5f));
-        street_lamp_stand.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
 
-        //lamp3
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-4.0f, -1.0f, 45.5f));
-        street_lamp_base.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+    //ourShader.use();
+    //lightingShader.use();
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-4.0f, 1.5f, 45.5f));
-        street_lamp_stand.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+    // per-second uniform statistics for the title bar
+    float statsTimer = 0.0f;
+    unsigned int statsFrames = 0, statsDriverLookups = 0, statsNameLookups = 0, statsUploads = 0, statsLightBytes = 0, statsClusterLights = 0;
+    unsigned int statsStateIssued = 0, statsStateFiltered = 0, statsVisibleNodes = 0, statsNodesTested = 0;
+    unsigned int statsPortalCulled = 0, statsPortalsInView = 0, statsOccluders = 0, statsOcclusionTested = 0, statsOcclusionCulled = 0;
+    unsigned int statsLodDraws[LOD_LEVELS] = { 0 };
+    double statsRasterMilliseconds = 0.0;
 
-        //lamp4
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(14.0f, -1.0f, 45.5f));
-        street_lamp_base.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+    // measured frames must all see the same textures, so the benchmark waits for them
+    if (benchmark.active())
+    {
+        textureLoader.finish();
+        benchmark.recordTextureStartup((unsigned int)sceneFile.textureCount(), textureLoader.compressed, textureLoader.textureBytes,
+            textureLoader.blockedMilliseconds, textureLoader.residentMilliseconds);
+        benchmark.recordCurvedSurfaces(TessellationPath::shared().enabled(), TessellationPath::shared().uploadedBytes);
+        benchmark.recordForest((unsigned int)forest.treeCount(), (unsigned int)forest.cellCount(), forest.branchTriangles());
+    }
+    bool texturesReported = false;
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(14.0f, 1.5f, 45.5f));
-        street_lamp_stand.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
 
+        // input
+        // -----
+        if (benchmark.active())
+        {
+            if (benchmark.finished())
+                break;
+            benchmark.beginFrame(camera);
+            deltaTime = benchmark.frameTime();
+        }
+        else
+            processInput(window);
 
-        //lamp5
+        // decoded images replace their placeholders a few per frame
+        textureLoader.update();
+        if (!texturesReported && textureLoader.pending() == 0)
+        {
+            std::cout << "Textures: " << textureLoader.loaded << " loaded (" << textureLoader.compressed << " compressed), " << textureLoader.failed
+                << " failed, " << textureLoader.textureBytes / 1024 << " KB on the GPU; main thread blocked " << textureLoader.blockedMilliseconds
+                << " ms, all resident after " << textureLoader.residentMilliseconds << " ms" << std::endl;
+            texturesReported = true;
+        }
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-4.0f, -1.0f, 28.5f));
-        street_lamp_base.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+        // render
+        // ------
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-4.0f, 1.5f, 28.5f));
-        street_lamp_stand.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+        glm::mat4 projection = myProjection(left, right, bottom, top, near, far);
 
-        //lamp6
+        glm::mat4 view = camera.GetViewMatrix();
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(15.5f, -1.0f, 28.5f));
-        street_lamp_base.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+        // the occluders are rasterized on the worker while lights and shaders are set up below
+        if (benchmark.occlusionEnabled())
+            bakedScene.beginOcclusion(occlusion, projection * view, camera.Position);
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(15.5f, 1.5f, 28.5f));
-        street_lamp_stand.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+        // be sure to activate shader when setting uniforms/drawing objects
+        lightingShader.use();
+        lightingShader.setVec3("viewPos", camera.Position);
+        lightingShader.setMat4("projection", projection);
+        lightingShader.setMat4("view", view);
 
+        // pass projection matrix to shader (note that in this case it could change every frame)
+        
+        //glm::mat4 projection = glm::ortho(-2.0f, +2.0f, -1.5f, +1.5f, 0.1f, 100.0f);
+       
 
-        ///right lamp1 front
+        // camera/view transformation
+        
+        //glm::mat4 view = basic_camera.createViewMatrix();
+        
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-30.0f, -1.0f, -15.0f));
-        street_lamp_base.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-30.0f, 1.5f, -15.0f));
-        street_lamp_stand.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+        // lights live in the shared LightBlock; only the ones that changed are re-sent
+        lightBlock.setClusterParams(lightClusters.params(framebufferWidth, framebufferHeight, near, far));
+        lightBlock.update(pointLights.data(), numLights, spotLights.data(), numSpotLights, directionalLight);
+        lightClusters.build(pointLights.data(), numLights, view, projection, near, far);
+        MaterialTable::shared().update();
+        
+       
 
-        ///right lamp2 front
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-48.0f, -1.0f, -15.0f));
-        street_lamp_base.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
+        // Modelling Transformation
+        glm::mat4 identityMatrix = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
+        glm::mat4 translateMatrix, rotation, rotateXMatrix, rotateYMatrix, rotateZMatrix, scaleMatrix, model;
+        translateMatrix = glm::translate(identityMatrix, glm::vec3(translate_X, translate_Y, translate_Z));
+        rotateXMatrix = glm::rotate(identityMatrix, glm::radians(rotateAngle_X), glm::vec3(1.0f, 0.0f, 0.0f));
+        rotateYMatrix = glm::rotate(identityMatrix, glm::radians(rotateAngle_Y), glm::vec3(0.0f, 1.0f, 0.0f));
+        rotateZMatrix = glm::rotate(identityMatrix, glm::radians(rotateAngle_Z), glm::vec3(0.0f, 0.0f, 1.0f));
+        scaleMatrix = glm::scale(identityMatrix, glm::vec3(scale_X, scale_Y, scale_Z));
+        model = translateMatrix * rotateXMatrix * rotateYMatrix * rotateZMatrix * scaleMatrix;
+        lightingShader.setMat4("model", model);
 
-        modelMatrixForContainer = glm::translate(identityMatrix, glm::vec3(-48.0f, 1.5f, -15.0f));
-        street_lamp_stand.drawCylinder(lightingShaderWithTexture, tree_pot, modelMatrixForContainer);
 
+        lightingShaderWithTexture.use();
+        lightingShaderWithTexture.setVec3("viewPos", camera.Position);
+        lightingShaderWithTexture.setMat4("projection", projection);
+        lightingShaderWithTexture.setMat4("view", view);
 
+        lightingShaderInstanced.use();
+        lightingShaderInstanced.setVec3("viewPos", camera.Position);
+        lightingShaderInstanced.setMat4("projection", projection);
+        lightingShaderInstanced.setMat4("view", view);
 
-        
+        lightingShaderWithTextureInstanced.use();
+        lightingShaderWithTextureInstanced.setVec3("viewPos", camera.Position);
+        lightingShaderWithTextureInstanced.setMat4("projection", projection);
+        lightingShaderWithTextureInstanced.setMat4("view", view);
 
+        if (tessellatedSurfaceShader != NULL)
+        {
+            tessellatedSurfaceShader->use();
+            tessellatedSurfaceShader->setVec3("viewPos", camera.Position);
+            tessellatedSurfaceShader->setMat4("projection", projection);
+            tessellatedSurfaceShader->setMat4("view", view);
+            TessellationPath::shared().setView(projection, framebufferHeight);
+        }
 
+       
 
-        /// Sculpture draw
 
-        
 
-        /*translateMatrix = glm::translate(identityMatrix, glm::vec3(-10.0f, 2.0f, 40.0f));
-        rotation = glm::rotate(identityMatrix, glm::radians(rotationAngle), glm::vec3(0.0f, 1.0f, 0.0f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(2.0f, 1.0f, 2.0f));
-        model = translateMatrix * rotation * scaleMatrix;
 
-        sculpure_design.drawBezierSculpt(lightingShaderWithTexture, model);*/
+        ///............................... Object drawing....................................////
 
+        /// sphere rotation
+        if (isRotating) {
+            rotationAngle += 1.0f;  // Adjust this value to control rotation speed
+            if (rotationAngle >= 360.0f) {
+                rotationAngle -= 360.0f;  // Reset to prevent overflow
+            }
+        }
 
-        ///******************* draw car****************////
+        // static nodes in view with the transforms baked before the loop, then the few dynamic ones
+        Frustum frustum(projection * view);
+        portals.update(camera.Position, frustum);
+        LodSelector::shared().setView(camera.Position, projection, framebufferHeight);
+        bakedScene.draw(frustum, portals, occlusion);
+        renderQueue.submit(view, far);
 
-        drawCar(lightingShader, cubeVAO, triangleVAO);
-        
+        curtains.flushWithTexture(lightingShaderWithTextureInstanced, curtain_design.diffuseMap, curtain_design.specularMap, curtain_design.shininess,
+            glm::vec4(curtain_design.TXmin, curtain_design.TYmin, curtain_design.TXmax, curtain_design.TYmax));
+        street_lamp_bases.flushWithTexture(lightingShaderWithTextureInstanced, tree_pot, tree_pot, street_lamp_base.shininess);
+        street_lamp_stands.flushWithTexture(lightingShaderWithTextureInstanced, tree_pot, tree_pot, street_lamp_stand.shininess);
 
 
         //glBindVertexArray(cubeVAO);
@@ -2634,69 +871,82 @@ int main()
         //glDrawArrays(GL_TRIANGLES, 0, 36);
 
         //bed(cubeVAO, lightingShader, model);
-        //draw floor
-        floor(cubeVAO, lightingShader);
-        //axis(cubeVAO, lightingShader);
-        frontWall(cubeVAO, lightingShader);
-        triangleStage(triangleVAO, lightingShader);
         /*rightWall(cubeVAO, lightingShader);*/
 
-        drawRowOfChairs(cubeVAO, lightingShader);
-
-        // also draw the lamp object(s)
-        ourShader.use();
-        ourShader.setMat4("projection", projection);
-        ourShader.setMat4("view", view);
-
-        // we now draw as many light bulbs as we have point lights.
-        glBindVertexArray(lightCubeVAO);
-        for (unsigned int i = 0; i < 64; i++)
-        {
-            if (i == 0 || i==1 || i==2 || i==3 || i==58 || i==59 || i==60 || i==61 ||i == 62 || i == 63) {
-                model = glm::mat4(1.0f);
-                model = glm::translate(model, pointLightPositions[i]);
-                model = glm::scale(model, glm::vec3(1.0f)); // Make it a smaller cube
-                ourShader.setMat4("model", model);
-                ourShader.setVec3("color", glm::vec3(1.0f, 1.0f, 1.0f));
-            }
-            else {
+        if (frustum.visible(seats.worldBounds()) && portals.visible(CELL_INTERIOR, seats.worldBounds()) && !occlusion.occluded(seats.worldBounds()))
+            seats.drawWithMaterialisticProperty(lightingShaderInstanced);
 
+        // also draw the lamp object(s); the baked scene has queued them above
+        ourShaderInstanced.use();
+        ourShaderInstanced.setMat4("projection", projection);
+        ourShaderInstanced.setMat4("view", view);
+        lamp_markers.flushWithColor(ourShaderInstanced);
 
-                model = glm::mat4(1.0f);
-                model = glm::translate(model, pointLightPositions[i]);
-                model = glm::scale(model, glm::vec3(0.2f)); // Make it a smaller cube
-                ourShader.setMat4("model", model);
-                ourShader.setVec3("color", glm::vec3(0.8f, 0.8f, 0.8f));
-            }
-            
-            /*cone.drawCone(lightingShader, model);*/
-            glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
+        forest.draw(projection, view, camera.Position, frustum, portals, occlusion);
 
         if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS)
         {
-            ambienton_off(lightingShader);
+            ambienton_off();
         }
         if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS)
         {
-            diffuse_on_off(lightingShader);
+            diffuse_on_off();
         }
         if (glfwGetKey(window, GLFW_KEY_6) == GLFW_PRESS)
         {
-            specular_on_off(lightingShader);
+            specular_on_off();
         }
 
 
-        //toras....
+        if (benchmark.active())
+        {
+            benchmark.recordVisibility((unsigned int)bakedScene.visibleCount(), (unsigned int)bakedScene.staticCount(), occlusion.boxesOccluded);
+            benchmark.endFrame();
+        }
 
-        /*glm::mat4 model = glm::mat4(1.0f);*/
-        model = glm::translate(model, glm::vec3(-10.0f, -8.19f, -0.2f)); // Adjust position
-        model = glm::rotate(model, glm::radians(45.0f), glm::vec3(1.0f, 0.0f, 0.0f)); // 90 degrees about X-axis
-        model = glm::rotate(model, glm::radians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f)); // 45 degrees about Z-axis
-        model = glm::rotate(model, glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f)); // 45 degrees about Z-axis
-        /*torus.drawTorus(lightingShader, model);*/
 
+        // uniform traffic: averaged over a second and shown in the title bar
+        // ------------------------------------------------------------------
+        statsFrames++;
+        statsDriverLookups += uniformStats().driverLookups;
+        statsNameLookups += uniformStats().nameLookups;
+        statsUploads += uniformStats().uploads;
+        statsLightBytes += lightBlock.uploadedBytes;
+        statsClusterLights += lightClusters.lightReferences;
+        statsStateIssued += glStateStats().totalIssued();
+        statsStateFiltered += glStateStats().totalFiltered();
+        statsVisibleNodes += (unsigned int)bakedScene.visibleCount();
+        statsNodesTested += bakedScene.nodesTested();
+        statsPortalCulled += bakedScene.portalCulled;
+        statsPortalsInView += portals.portalsInView;
+        statsOccluders += occlusion.occludersDrawn;
+        statsOcclusionTested += occlusion.boxesTested;
+        statsOcclusionCulled += occlusion.boxesOccluded;
+        for (int level = 0; level < LOD_LEVELS; level++)
+            statsLodDraws[level] += LodSelector::shared().selected[level];
+        statsRasterMilliseconds += occlusion.rasterMilliseconds;
+        uniformStats().reset();
+        glStateStats().reset();
+        if (currentFrame - statsTimer >= 1.0f)
+        {
+            char title[1024];
+            snprintf(title, sizeof(title), "%s | uniform lookups/frame: %u driver, %u by name, %u uploads | light bytes/frame: %u | lights per cluster: %.2f avg, %u max | live GL buffers: %d, vertex arrays: %d | shared meshes: %u for %u instances | baked nodes: %u static, %u dynamic | queue: %u packets, %u material changes, %u materials in table | GL state calls/frame: %u issued, %u filtered | culling: %u of %u static nodes visible, %u boxes tested | portals: %u of %u open in view, %u nodes behind walls | occlusion: %u occluders in %.2f ms, %u of %u boxes hidden | lod: %u/%u/%u draws per level",
+                windowTitle, statsDriverLookups / statsFrames, statsNameLookups / statsFrames, statsUploads / statsFrames, statsLightBytes / statsFrames,
+                (float)statsClusterLights / statsFrames / (lightClusters.tilesX * lightClusters.tilesY * lightClusters.slices), lightClusters.maxLightsPerCluster,
+                glResourceStats().buffers, glResourceStats().vertexArrays, (unsigned int)MeshCache::shared().size(), MeshCache::shared().uploads + MeshCache::shared().hits,
+                (unsigned int)bakedScene.staticCount(), (unsigned int)bakedScene.dynamicCount(),
+                renderQueue.packetCount, renderQueue.materialChanges, (unsigned int)MaterialTable::shared().size(), statsStateIssued / statsFrames, statsStateFiltered / statsFrames,
+                statsVisibleNodes / statsFrames, (unsigned int)bakedScene.staticCount(), statsNodesTested / statsFrames,
+                statsPortalsInView / statsFrames, (unsigned int)portals.portalCount(), statsPortalCulled / statsFrames,
+                statsOccluders / statsFrames, statsRasterMilliseconds / statsFrames, statsOcclusionCulled / statsFrames, statsOcclusionTested / statsFrames,
+                statsLodDraws[0] / statsFrames, statsLodDraws[1] / statsFrames, statsLodDraws[2] / statsFrames);
+            glfwSetWindowTitle(window, title);
+            statsTimer = currentFrame;
+            statsFrames = statsDriverLookups = statsNameLookups = statsUploads = statsLightBytes = statsClusterLights = statsStateIssued = statsStateFiltered = 0;
+            statsVisibleNodes = statsNodesTested = statsPortalCulled = statsPortalsInView = statsOccluders = statsOcclusionTested = statsOcclusionCulled = 0;
+            statsRasterMilliseconds = 0.0;
+            std::fill(statsLodDraws, statsLodDraws + LOD_LEVELS, 0u);
+        }
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -2706,97 +956,39 @@ int main()
 
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &cubeVAO);
-    glDeleteVertexArrays(1, &lightCubeVAO);
-    glDeleteBuffers(1, &cubeVBO);
-    glDeleteBuffers(1, &cubeEBO);
+    MeshCache::shared().release(cornerCube);
+    MeshCache::shared().release(wedge);
 
-    glDeleteVertexArrays(1, &triangleVAO);
-    glDeleteVertexArrays(1, &lightTriangleVAO);
-    glDeleteBuffers(1, &triangleVBO);
-    glDeleteBuffers(1, &triangleEBO);
+    scene.clear();
+    MaterialTable::shared().release();
+    lightBlock.release();
+    lightClusters.release();
+    textureLoader.release();
+
+    bool reported = !benchmark.active() || benchmark.writeReport();
+    benchmark.releaseTarget();
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
     glfwTerminate();
-    return 0;
+    return reported ? 0 : -1;
 }
 
-void drawCube(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model = glm::mat4(1.0f), float r = 1.0f, float g = 1.0f, float b = 1.0f, float shininess = 32.0f)
+// records a lit draw of mesh (the cube or the wedge) in queue, with as many indices as the mesh has
+void queueCube(RenderQueue& queue, const SharedMesh& mesh, Shader& lightingShader, const glm::mat4& model, float r, float g, float b, float shininess)
 {
-    lightingShader.use();
-
-    lightingShader.setVec3("material.ambient", glm::vec3(r, g, b));
-    lightingShader.setVec3("material.diffuse", glm::vec3(r, g, b));
-    lightingShader.setVec3("material.specular", glm::vec3(0.5f, 0.5f, 0.5f));
-    lightingShader.setFloat("material.shininess", shininess);
-
-    lightingShader.setMat4("model", model);
-
-    glBindVertexArray(cubeVAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    queue.addLit(lightingShader, mesh.litVAO, mesh.indexCount, MaterialTable::shared().add(glm::vec3(r, g, b), glm::vec3(r, g, b), glm::vec3(0.5f, 0.5f, 0.5f), shininess), model);
 }
 
-void drawTriangle(unsigned int& triangleVAO, Shader& lightingShader, glm::mat4 model = glm::mat4(1.0f), float r = 1.0f, float g = 1.0f, float b = 1.0f, float shininess = 32.0f)
+// bakes a cube or wedge whose model matrix never changes; its material is looked up once, here
+void bakeCube(BakedScene& scene, RenderQueue& queue, const SharedMesh& mesh, Shader& lightingShader, glm::mat4 model, float r, float g, float b, float shininess)
 {
-    lightingShader.use();
-
-    lightingShader.setVec3("material.ambient", glm::vec3(r, g, b));
-    lightingShader.setVec3("material.diffuse", glm::vec3(r, g, b));
-    lightingShader.setVec3("material.specular", glm::vec3(0.5f, 0.5f, 0.5f));
-    lightingShader.setFloat("material.shininess", shininess);
-
-    lightingShader.setMat4("model", model);
-
-    glBindVertexArray(triangleVAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    int materialIndex = MaterialTable::shared().add(glm::vec3(r, g, b), glm::vec3(r, g, b), glm::vec3(0.5f, 0.5f, 0.5f), shininess);
+    scene.bake(model, mesh.bounds, [&queue, &mesh, &lightingShader, materialIndex](const glm::mat4& m) { queue.addLit(lightingShader, mesh.litVAO, mesh.indexCount, materialIndex, m); });
 }
 
-void floor(unsigned int& cubeVAO, Shader& lightingShader)
-{
-    lightingShader.use();
-    //base
-    glm::mat4 identityMatrix = glm::mat4(1.0f);
-    glm::mat4 translate = glm::mat4(1.0f);
-    //glm::mat4 translate2 = glm::mat4(1.0f);
-    glm::mat4 scale = glm::mat4(1.0f);
-    
-    //scale = glm::scale(identityMatrix, glm::vec3(100.0, 0.2, 100.0));
-    //translate = glm::translate(identityMatrix, glm::vec3(-50.0, -1.5, -50.0));
-    //
-    //
-    //glm::mat4 model = translate * scale;
-    //drawCube(cubeVAO, lightingShader, model, 0.8, 0.8, 0.8, 100.0);
-
-    /*scale = glm::scale(identityMatrix, glm::vec3(-16.6, 0.2, 15.0));
-    translate = glm::translate(identityMatrix, glm::vec3(-6.4, -0.8, -7.0));
-    model = translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 1.0, 1.0, 1.0, 32.0);
-
-    scale = glm::scale(identityMatrix, glm::vec3(-14.4, 0.2, 15.0));
-    translate = glm::translate(identityMatrix, glm::vec3(-8.6, -0.6, -7.0));
-    model = translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 1.0, 1.0, 1.0, 32.0);
-
-    scale = glm::scale(identityMatrix, glm::vec3(-12.2, 0.2, 15.0));
-    translate = glm::translate(identityMatrix, glm::vec3(-10.8, -0.4, -7.0));
-    model = translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 1.0, 1.0, 1.0, 32.0);*/
-
-    /*scale = glm::scale(identityMatrix, glm::vec3(0.1, 2.0, 0.1));
-    translate = glm::translate(identityMatrix, glm::vec3(-5.0, -0.8, -5.0));
-    model = translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 0.1, 0.1, 0.1, 32.0);*/
-
-    //wall
-    /*scale = glm::scale(identityMatrix, glm::vec3(-5.0, 5.0, 0.1));
-    translate = glm::translate(identityMatrix, glm::vec3(4.9, -0.8, 2.0));
-    model = translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 0.5, 0.5, 0.5, 32.0);*/
-}
-void frontWall(unsigned int& cubeVAO, Shader& lightingShader)
+void frontWall(BakedScene& scene, RenderQueue& queue, const SharedMesh& cube, Shader& lightingShader)
 {
-    lightingShader.use();
     //base
     glm::mat4 identityMatrix = glm::mat4(1.0f);
     glm::mat4 translate = glm::mat4(1.0f);
@@ -2808,19 +1000,19 @@ void frontWall(unsigned int& cubeVAO, Shader& lightingShader)
     scale = glm::scale(identityMatrix, glm::vec3(0.1, 10.0, 22.0));
     translate = glm::translate(identityMatrix, glm::vec3(15.0, 0.0, -11.0));
     model = translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 0.5, 0.5, 0.5, 32.0);
+    bakeCube(scene, queue, cube, lightingShader, model, 0.5, 0.5, 0.5, 32.0);
     
     //dais
     scale = glm::scale(identityMatrix, glm::vec3(1.0, 1.8, 1.0));
     translate = glm::translate(identityMatrix, glm::vec3(5.0, 0.0, -3.0));
     model = translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
+    bakeCube(scene, queue, cube, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
 
     //stage
     scale = glm::scale(identityMatrix, glm::vec3(12.0, 1.2, 10.0));
     translate = glm::translate(identityMatrix, glm::vec3(3.0, -0.8, -5.0));
     model = translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
+    bakeCube(scene, queue, cube, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
 
 
     ///*******car*********////
@@ -2857,8 +1049,7 @@ void frontWall(unsigned int& cubeVAO, Shader& lightingShader)
 
 }
 
-void triangleStage(unsigned int& triangleVAO, Shader& lightingShader) {
-    lightingShader.use();
+void triangleStage(BakedScene& scene, RenderQueue& queue, const SharedMesh& wedge, Shader& lightingShader) {
     //base
     glm::mat4 identityMatrix = glm::mat4(1.0f);
     glm::mat4 translate = glm::mat4(1.0f);
@@ -2869,13 +1060,13 @@ void triangleStage(unsigned int& triangleVAO, Shader& lightingShader) {
     scale = glm::scale(identityMatrix, glm::vec3(12.0, 1.2, 7.0));
     translate = glm::translate(identityMatrix, glm::vec3(3.0, -0.8, -12.0));
     model = translate * scale;
-    drawCube(triangleVAO, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
+    bakeCube(scene, queue, wedge, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
 
     scale = glm::scale(identityMatrix, glm::vec3(12.0, 1.2, 7.0));
     translate = glm::translate(identityMatrix, glm::vec3(3.0, -0.8, 12.0));
     rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     model = translate * scale * rotation;
-    drawCube(triangleVAO, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
+    bakeCube(scene, queue, wedge, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
 
 
     ///*******car********////
@@ -2894,9 +1085,8 @@ void triangleStage(unsigned int& triangleVAO, Shader& lightingShader) {
 
 }
 
-void chair_center(unsigned int& cubeVAO, Shader& lightingShader, glm::vec3 position) {
-    lightingShader.use();
-
+// appends the transforms of the seat and back support of one chair
+void chair_center(std::vector<glm::mat4>& seats, glm::vec3 position) {
     // Identity matrix
     glm::mat4 identityMatrix = glm::mat4(1.0f);
     glm::mat4 translate;
@@ -2908,19 +1098,17 @@ void chair_center(unsigned int& cubeVAO, Shader& lightingShader, glm::vec3 posit
     scale = glm::scale(identityMatrix, glm::vec3(-1.0, 0.4, 1.0));
     translate = glm::translate(identityMatrix, position + glm::vec3(-5.0, -0.8, -5.0)); // Adjust position for the base
     model = translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
+    seats.push_back(model);
 
     // Chair back support
     scale = glm::scale(identityMatrix, glm::vec3(-0.4, 1.0, 1.0));
     translate = glm::translate(identityMatrix, position + glm::vec3(-6.0, -0.8, -5.0)); // Adjust position for the back support
     rotation = glm::rotate(identityMatrix, glm::radians(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     model = translate * scale * rotation;
-    drawCube(cubeVAO, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
+    seats.push_back(model);
 }
 
-void chair_left(unsigned int& cubeVAO, Shader& lightingShader, glm::vec3 position) {
-    lightingShader.use();
-
+void chair_left(std::vector<glm::mat4>& seats, glm::vec3 position) {
     // Identity matrix
     glm::mat4 identityMatrix = glm::mat4(1.0f);
     glm::mat4 translate;
@@ -2933,19 +1121,17 @@ void chair_left(unsigned int& cubeVAO, Shader& lightingShader, glm::vec3 positio
     translate = glm::translate(identityMatrix, position + glm::vec3(-5.7, -0.8, 8.5)); // Adjust position for the base
     rotation = glm::rotate(identityMatrix, glm::radians(25.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     model = translate * rotation * scale ;
-    drawCube(cubeVAO, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
+    seats.push_back(model);
 
     // Chair back support
     scale = glm::scale(identityMatrix, glm::vec3(0.4, 1.0, 1.0));
     translate = glm::translate(identityMatrix, position + glm::vec3(-5.9, -0.8, 8.6)); // Adjust position for the back support
     rotation = glm::rotate(identityMatrix, glm::radians(25.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     model = translate * rotation * scale ;
-    drawCube(cubeVAO, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
+    seats.push_back(model);
 }
 
-void chair_right(unsigned int& cubeVAO, Shader& lightingShader, glm::vec3 position) {
-    lightingShader.use();
-
+void chair_right(std::vector<glm::mat4>& seats, glm::vec3 position) {
     // Identity matrix
     glm::mat4 identityMatrix = glm::mat4(1.0f);
     glm::mat4 translate;
@@ -2958,301 +1144,42 @@ void chair_right(unsigned int& cubeVAO, Shader& lightingShader, glm::vec3 positi
     translate = glm::translate(identityMatrix, position + glm::vec3(-5.7, -0.8, -9.3)); // Adjust position for the base
     rotation = glm::rotate(identityMatrix, glm::radians(-25.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     model = translate * rotation * scale;
-    drawCube(cubeVAO, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
+    seats.push_back(model);
 
     // Chair back support
     scale = glm::scale(identityMatrix, glm::vec3(0.4, 1.0, 1.0));
     translate = glm::translate(identityMatrix, position + glm::vec3(-5.9, -0.8, -9.4)); // Adjust position for the back support
     rotation = glm::rotate(identityMatrix, glm::radians(-25.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     model = translate * rotation * scale;
-    drawCube(cubeVAO, lightingShader, model, 0.112, 0.167, 0.231, 32.0);
+    seats.push_back(model);
 }
 
 
-void drawRowOfChairs(unsigned int& cubeVAO, Shader& lightingShader) {
-    float angleDegrees = 66.0f;
-    float angleRadians = glm::radians(angleDegrees);
-    float spacing = 1.5f; // Distance between chairs along the angled line
-
-
-/////////..................1st floor........................./////////
-
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(angleRadians),
-            0.0f,
-            i * spacing * sin(angleRadians)); // Adjust z based on sin of the angle
-        chair_left(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(68.5f)) - 2.25f,
-            0.2f,
-            i * spacing * sin(glm::radians(68.5f))); // Adjust z based on sin of the angle
-        chair_left(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(72.0f)) - 4.5f,
-            0.4f,
-            i * spacing * sin(glm::radians(72.0f))); // Adjust z based on sin of the angle
-        chair_left(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(75.5f)) - 6.75f,
-            0.6f,
-            i * spacing * sin(glm::radians(75.5f))); // Adjust z based on sin of the angle
-        chair_left(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(78.5f)) - 9.0f,
-            0.8f,
-            i * spacing * sin(glm::radians(78.5f))); // Adjust z based on sin of the angle
-        chair_left(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(82.0f)) - 11.25f,
-            1.0f,
-            i * spacing * sin(glm::radians(82.0f))); // Adjust z based on sin of the angle
-        chair_left(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(85.5f)) - 13.5f,
-            1.2f,
-            i * spacing * sin(glm::radians(85.5f))); // Adjust z based on sin of the angle
-        chair_left(cubeVAO, lightingShader, position);
-    }
-
-
-
-
-
-
-
-
-
-    //right chairs
-
-     angleDegrees = -66.0f;
-     angleRadians = glm::radians(angleDegrees);
-     spacing = 1.5f; // Distance between chairs along the angled line
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(angleRadians),
-            0.0f,
-            i * spacing * sin(angleRadians)); // Adjust z based on sin of the angle
-        chair_right(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(-68.5f)) - 2.23f,
-            0.2f,
-            i * spacing * sin(glm::radians(-68.5f))); // Adjust z based on sin of the angle
-        chair_right(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(-72.0f)) - 4.3f,
-            0.4f,
-            i * spacing * sin(glm::radians(-72.0f))); // Adjust z based on sin of the angle
-        chair_right(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(-74.5f)) - 6.71f,
-            0.6f,
-            i * spacing * sin(glm::radians(-75.5f))); // Adjust z based on sin of the angle
-        chair_right(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(-78.5f)) - 8.8f,
-            0.8f,
-            i * spacing * sin(glm::radians(-78.5f))); // Adjust z based on sin of the angle
-        chair_right(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(-81.0f)) - 11.2f,
-            1.0f,
-            i * spacing * sin(glm::radians(-82.0f))); // Adjust z based on sin of the angle
-        chair_right(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(-85.5f)) - 13.2f,
-            1.2f,
-            i * spacing * sin(glm::radians(-85.5f))); // Adjust z based on sin of the angle
-        chair_right(cubeVAO, lightingShader, position);
-    }
-
-
-
-
-
-
-
-
-    for (int i = 0; i < 7; ++i) {
-        glm::vec3 position = glm::vec3(0.0f, 0.0f, i*1.5f); // Space chairs by 3 units along the x-axis
-        chair_center(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        glm::vec3 position = glm::vec3(-2.2f, 0.2f, i * 1.5f); // Space chairs by 3 units along the x-axis
-        chair_center(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        glm::vec3 position = glm::vec3(-4.4f, 0.4f, i * 1.5f); // Space chairs by 3 units along the x-axis
-        chair_center(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        glm::vec3 position = glm::vec3(-6.6f, 0.6f, i * 1.5f); // Space chairs by 3 units along the x-axis
-        chair_center(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        glm::vec3 position = glm::vec3(-8.8f, 0.8f, i * 1.5f); // Space chairs by 3 units along the x-axis
-        chair_center(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        glm::vec3 position = glm::vec3(-11.0f, 1.0f, i * 1.5f); // Space chairs by 3 units along the x-axis
-        chair_center(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        glm::vec3 position = glm::vec3(-13.2f, 1.2f, i * 1.5f); // Space chairs by 3 units along the x-axis
-        chair_center(cubeVAO, lightingShader, position);
-    }
-
-
-//////.............2nd floor..............///////
-
-    /// center chairs
-    for (int i = 0; i < 7; ++i) {
-        glm::vec3 position = glm::vec3(-8.8f, 0.8f+5.0f, i * 1.5f); // Space chairs by 3 units along the x-axis
-        chair_center(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        glm::vec3 position = glm::vec3(-11.0f, 1.0f+5.0f, i * 1.5f); // Space chairs by 3 units along the x-axis
-        chair_center(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        glm::vec3 position = glm::vec3(-13.2f, 1.2f+5.0f, i * 1.5f); // Space chairs by 3 units along the x-axis
-        chair_center(cubeVAO, lightingShader, position);
-    }
-
-
-    /// right chairs
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(-78.5f)) - 8.8f,
-            0.8f+5.0f,
-            i * spacing * sin(glm::radians(-78.5f))); // Adjust z based on sin of the angle
-        chair_right(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(-81.0f)) - 11.2f,
-            1.0f+5.0f,
-            i * spacing * sin(glm::radians(-82.0f))); // Adjust z based on sin of the angle
-        chair_right(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(-85.5f)) - 13.2f,
-            1.2f+5.0f,
-            i * spacing * sin(glm::radians(-85.5f))); // Adjust z based on sin of the angle
-        chair_right(cubeVAO, lightingShader, position);
-    }
-
-
-    /// left chairs
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(78.5f)) - 9.0f,
-            0.8f+5.0f,
-            i * spacing * sin(glm::radians(78.5f))); // Adjust z based on sin of the angle
-        chair_left(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(82.0f)) - 11.25f,
-            1.0f+5.0f,
-            i * spacing * sin(glm::radians(82.0f))); // Adjust z based on sin of the angle
-        chair_left(cubeVAO, lightingShader, position);
-    }
-
-    for (int i = 0; i < 7; ++i) {
-        // Calculate the position for each chair along a 25-degree line
-        glm::vec3 position = glm::vec3(i * spacing * cos(glm::radians(85.5f)) - 13.5f,
-            1.2f+5.0f,
-            i * spacing * sin(glm::radians(85.5f))); // Adjust z based on sin of the angle
-        chair_left(cubeVAO, lightingShader, position);
+// the transforms of every seat in the hall, two cubes per chair; computed once and drawn instanced
+void layoutRowsOfChairs(std::vector<glm::mat4>& seats, const SceneFile& sceneFile) {
+    // the rows themselves are seatrow lines in the scene file
+    for (size_t i = 0; i < sceneFile.seatCount(); i++)
+    {
+        const SceneSeat& seat = sceneFile.seats()[i];
+        if (seat.style == SEAT_LEFT)
+            chair_left(seats, seat.position);
+        else if (seat.style == SEAT_RIGHT)
+            chair_right(seats, seat.position);
+        else
+            chair_center(seats, seat.position);
     }
-    
 }
 
 
 
-void axis(unsigned int& cubeVAO, Shader& lightingShader)
-{
-    lightingShader.use();
-    //base
-    glm::mat4 identityMatrix = glm::mat4(1.0f);
-    glm::mat4 translate = glm::mat4(1.0f);
-    //glm::mat4 translate2 = glm::mat4(1.0f);
-    glm::mat4 scale = glm::mat4(1.0f);
-    //x
-    scale = glm::scale(identityMatrix, glm::vec3(2.0, 0.1, 0.1));
-    translate = glm::translate(identityMatrix, glm::vec3(0.0, 0.0, 0.0));
-    glm::mat4 model = translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 1.0, 0.0, 0.0, 32.0);
-    //y
-    scale = glm::scale(identityMatrix, glm::vec3(0.1, 2.0, 0.1));
-    translate = glm::translate(identityMatrix, glm::vec3(0.0, 0.0, 0.0));
-    model = translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 0.0, 1.0, 0.0, 32.0);
-    //z
-    scale = glm::scale(identityMatrix, glm::vec3(0.1, 0.1, 2.0));
-    translate = glm::translate(identityMatrix, glm::vec3(0.0, 0.0, 0.0));
-    model = translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 0.0, 0.0, 1.0, 32.0);
-}
+
 
 
 
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 
-void drawDoors(Shader& lightingShaderWithTexture, Door& door, glm::mat4 identityMatrix) {
+void drawDoors(RenderQueue& queue, Shader& lightingShaderWithTexture, Door& door, glm::mat4 identityMatrix) {
     glm::mat4 scale, translate, rotation, model;
 
     /// left door1
@@ -3266,7 +1193,7 @@ void drawDoors(Shader& lightingShaderWithTexture, Door& door, glm::mat4 identity
         rotation = glm::mat4(1.0f); // No rotation
     }
     model = translate * rotation * scale;
-    door.drawDoorWithTexture(lightingShaderWithTexture, model);
+    door.queueDoorWithTexture(queue, lightingShaderWithTexture, model);
 
     /// left door2
     scale = glm::scale(identityMatrix, glm::vec3(4.0, 4.8, 0.2));
@@ -3280,7 +1207,7 @@ void drawDoors(Shader& lightingShaderWithTexture, Door& door, glm::mat4 identity
         rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     }
     model = translate * rotation * scale;
-    door.drawDoorWithTexture(lightingShaderWithTexture, model);
+    door.queueDoorWithTexture(queue, lightingShaderWithTexture, model);
 
     /// right door1
     scale = glm::scale(identityMatrix, glm::vec3(4.0, 4.8, 0.2));
@@ -3293,7 +1220,7 @@ void drawDoors(Shader& lightingShaderWithTexture, Door& door, glm::mat4 identity
         rotation = glm::mat4(1.0f); // No rotation
     }
     model = translate * rotation * scale;
-    door.drawDoorWithTexture(lightingShaderWithTexture, model);
+    door.queueDoorWithTexture(queue, lightingShaderWithTexture, model);
 
     /// right door2
     scale = glm::scale(identityMatrix, glm::vec3(4.0, 4.8, 0.2));
@@ -3307,13 +1234,27 @@ void drawDoors(Shader& lightingShaderWithTexture, Door& door, glm::mat4 identity
         rotation = glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     }
     model = translate * rotation * scale;
-    door.drawDoorWithTexture(lightingShaderWithTexture, model);
+    door.queueDoorWithTexture(queue, lightingShaderWithTexture, model);
 }
 
 
 
 
-void drawCar(Shader& lightingShader, unsigned int& cubeVAO, unsigned int& triangleVAO) {
+// the openings drawDoors closes: one per door leaf, open while its flag is set
+void doorPortals(CellPortals& portals) {
+    const float bottom = -0.8f, top = 4.0f;
+    const float left[2] = { 1.0f, 5.0f }, right[2] = { 5.0f, 9.0f };
+    bool* flags[4] = { &leftDoor1Open, &leftDoor2Open, &rightDoor1Open, &rightDoor2Open };
+    for (int i = 0; i < 4; i++)
+    {
+        float z = i < 2 ? 20.0f : -20.0f;
+        portals.addPortal(glm::vec3(left[i % 2], bottom, z), glm::vec3(right[i % 2], bottom, z),
+            glm::vec3(right[i % 2], top, z), glm::vec3(left[i % 2], top, z), flags[i]);
+    }
+}
+
+
+void drawCar(RenderQueue& queue, Shader& lightingShader, const SharedMesh& cube, const SharedMesh& wedge, CylinderNoTex& wheel) {
     // Create the car's overall transformation matrix
     glm::mat4 carTransform = glm::mat4(1.0f);
     carTransform = glm::translate(carTransform, carPosition);
@@ -3327,7 +1268,7 @@ void drawCar(Shader& lightingShader, unsigned int& cubeVAO, unsigned int& triang
     translate = glm::translate(identityMatrix, glm::vec3(-43.0, 1.1, 0.0));
     rotation = glm::rotate(identityMatrix, glm::radians(-90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     model = carTransform * translate * rotation * scale;
-    drawCube(triangleVAO, lightingShader, model, 0.9, 0.1, 0.1, 32.0);
+    queueCube(queue, wedge, lightingShader, model, 0.9, 0.1, 0.1, 32.0);
 
     // Back triangle - reduced scale and adjusted position
     scale = glm::scale(identityMatrix, glm::vec3(0.6, 3.0, 1.2));
@@ -3335,50 +1276,47 @@ void drawCar(Shader& lightingShader, unsigned int& cubeVAO, unsigned int& triang
     rotation = glm::rotate(identityMatrix, glm::radians(-90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     rotation = glm::rotate(rotation, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
     model = carTransform * translate * rotation * scale;
-    drawCube(triangleVAO, lightingShader, model, 0.9, 0.1, 0.1, 32.0);
+    queueCube(queue, wedge, lightingShader, model, 0.9, 0.1, 0.1, 32.0);
 
     // Upper body - reduced scale and adjusted position
     scale = glm::scale(identityMatrix, glm::vec3(3.0, 0.6, 2.4));
     translate = glm::translate(identityMatrix, glm::vec3(-43.0, 0.0 + 0.5, 1.2));
     model = carTransform * translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 0.9, 0.1, 0.1, 32.0);
+    queueCube(queue, cube, lightingShader, model, 0.9, 0.1, 0.1, 32.0);
 
     // Lower body - reduced scale and adjusted position
     scale = glm::scale(identityMatrix, glm::vec3(3.0, 0.9, 8.4));
     translate = glm::translate(identityMatrix, glm::vec3(-43.0, -0.4, -1.5));
     model = carTransform * translate * scale;
-    drawCube(cubeVAO, lightingShader, model, 0.9, 0.1, 0.1, 32.0);
-
-    // Create wheel object once
-    CylinderNoTex wheel = CylinderNoTex();
+    queueCube(queue, cube, lightingShader, model, 0.9, 0.1, 0.1, 32.0);
 
     // Front left wheel - reduced scale and adjusted position
     scale = glm::scale(identityMatrix, glm::vec3(0.5, 0.25, 0.5));
     translate = glm::translate(identityMatrix, glm::vec3(-42.8, -0.5, 0.0));
     rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     model = carTransform * translate * rotation * scale;
-    wheel.drawCylinderNoTex(lightingShader, model);
+    wheel.queueCylinderNoTex(queue, lightingShader, model);
 
     // Front right wheel - reduced scale and adjusted position
     scale = glm::scale(identityMatrix, glm::vec3(0.5, 0.25, 0.5));
     translate = glm::translate(identityMatrix, glm::vec3(-40.2, -0.5, 0.0));
     rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     model = carTransform * translate * rotation * scale;
-    wheel.drawCylinderNoTex(lightingShader, model);
+    wheel.queueCylinderNoTex(queue, lightingShader, model);
 
     // Back left wheel - reduced scale and adjusted position
     scale = glm::scale(identityMatrix, glm::vec3(0.5, 0.25, 0.5));
     translate = glm::translate(identityMatrix, glm::vec3(-42.8, -0.5, 5.4));
     rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     model = carTransform * translate * rotation * scale;
-    wheel.drawCylinderNoTex(lightingShader, model);
+    wheel.queueCylinderNoTex(queue, lightingShader, model);
 
     // Back right wheel - reduced scale and adjusted position
     scale = glm::scale(identityMatrix, glm::vec3(0.5, 0.25, 0.5));
     translate = glm::translate(identityMatrix, glm::vec3(-40.2, -0.5, 5.4));
     rotation = glm::rotate(identityMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     model = carTransform * translate * rotation * scale;
-    wheel.drawCylinderNoTex(lightingShader, model);
+    wheel.queueCylinderNoTex(queue, lightingShader, model);
 }
 
 
@@ -3557,74 +1495,65 @@ void processInput(GLFWwindow* window)
     //}
 
 }
-void ambienton_off(Shader& lightingShader)
+void ambienton_off()
 {
     double currentTime = glfwGetTime();
     if (currentTime - lastKeyPressTime < keyPressDelay) return;
-    lightingShader.use();
     if (AmbientON)
     {
-        pointlight1.turnAmbientOff();
-        pointlight2.turnAmbientOff();
-        lightingShader.setVec3("directionalLight.ambient", 0.0f, 0.0f, 0.0f);
-        lightingShader.setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
+        for (int i = 0; i < numLights && i < 2; i++)
+            pointLights[i]->turnAmbientOff();
+        directionalLight.turnAmbientOff();
         AmbientON = !AmbientON;
         lastKeyPressTime = currentTime;
     }
     else
     {
-        pointlight1.turnAmbientOn();
-        pointlight2.turnAmbientOn();
-        lightingShader.setVec3("directionalLight.ambient", 0.2f, 0.2f, 0.2f);
-        lightingShader.setVec3("spotLight.ambient", 0.2f, 0.2f, 0.2f);
+        for (int i = 0; i < numLights && i < 2; i++)
+            pointLights[i]->turnAmbientOn();
+        directionalLight.turnAmbientOn();
         AmbientON = !AmbientON;
         lastKeyPressTime = currentTime;
     }
 }
-void diffuse_on_off(Shader& lightingShader)
+void diffuse_on_off()
 {
     double currentTime = glfwGetTime();
     if (currentTime - lastKeyPressTime < keyPressDelay) return;
-    lightingShader.use();
     if (DiffusionON)
     {
-        pointlight1.turnDiffuseOff();
-        pointlight2.turnDiffuseOff();
-        lightingShader.setVec3("directionalLight.diffuse", 0.0f, 0.0f, 0.0f);
-        lightingShader.setVec3("spotLight.diffuse", 0.0f, 0.0f, 0.0f);
+        for (int i = 0; i < numLights && i < 2; i++)
+            pointLights[i]->turnDiffuseOff();
+        directionalLight.turnDiffuseOff();
         DiffusionON = !DiffusionON;
         lastKeyPressTime = currentTime;
     }
     else
     {
-        pointlight1.turnDiffuseOn();
-        pointlight2.turnDiffuseOn();
-        lightingShader.setVec3("directionalLight.diffuse", 0.8f, 0.8f, 0.8f);
-        lightingShader.setVec3("spotLight.diffuse", 0.8f, 0.8f, 0.8f);
+        for (int i = 0; i < numLights && i < 2; i++)
+            pointLights[i]->turnDiffuseOn();
+        directionalLight.turnDiffuseOn();
         DiffusionON = !DiffusionON;
         lastKeyPressTime = currentTime;
     }
 }
-void specular_on_off(Shader& lightingShader)
+void specular_on_off()
 {
     double currentTime = glfwGetTime();
     if (currentTime - lastKeyPressTime < keyPressDelay) return;
-    lightingShader.use();
     if (SpecularON)
     {
-        pointlight1.turnSpecularOff();
-        pointlight2.turnSpecularOff();
-        lightingShader.setVec3("directionalLight.specular", 0.0f, 0.0f, 0.0f);
-        lightingShader.setVec3("spotLight.specular", 0.0f, 0.0f, 0.0f);
+        for (int i = 0; i < numLights && i < 2; i++)
+            pointLights[i]->turnSpecularOff();
+        directionalLight.turnSpecularOff();
         SpecularON = !SpecularON;
         lastKeyPressTime = currentTime;
     }
     else
     {
-        pointlight1.turnSpecularOn();
-        pointlight2.turnSpecularOn();
-        lightingShader.setVec3("directionalLight.specular", 1.0f, 1.0f, 1.0f);
-        lightingShader.setVec3("spotLight.specular", 1.0f, 1.0f, 1.0f);
+        for (int i = 0; i < numLights && i < 2; i++)
+            pointLights[i]->turnSpecularOn();
+        directionalLight.turnSpecularOn();
         SpecularON = !SpecularON;
         lastKeyPressTime = currentTime;
     }
@@ -3651,24 +1580,6 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     //    }
     //}
 
-    // First, declare the array of point lights at the top with your other variables
-    PointLight* pointLights[] = {
-    &pointlight1, &pointlight2, &pointlight3, &pointlight4, &pointlight5,
-    &pointlight6, &pointlight7, &pointlight8, &pointlight9, &pointlight10,
-    &pointlight11, &pointlight12, &pointlight13, &pointlight14, &pointlight15,
-    &pointlight16, &pointlight17, &pointlight18, &pointlight19, &pointlight20,
-    &pointlight21, &pointlight22, &pointlight23, &pointlight24, &pointlight25,
-    &pointlight26, &pointlight27, &pointlight28, &pointlight29, &pointlight30,
-    &pointlight31, &pointlight32, &pointlight33, &pointlight34, &pointlight35,
-    &pointlight36, &pointlight37, &pointlight38, &pointlight39, &pointlight40,
-    &pointlight41, &pointlight42, &pointlight43, &pointlight44, &pointlight45,
-    &pointlight46, &pointlight47, &pointlight48, &pointlight49, &pointlight50,
-    &pointlight51, &pointlight52, &pointlight53, &pointlight54, &pointlight55,
-    &pointlight56, &pointlight57, &pointlight58,& pointlight59,& pointlight60,
-    & pointlight61,& pointlight62,& pointlight63,& pointlight64
-    };
-    const int numLights = 64;  // Updated number of point lights
-
     // In your key callback function:
     if (key == GLFW_KEY_2 && action == GLFW_PRESS)
     {
@@ -3689,26 +1600,24 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
     if (key == GLFW_KEY_1 && action == GLFW_PRESS)
     {
+        if (directionalLightOn)
+            directionalLight.turnOff();
+        else
+            directionalLight.turnOn();
         directionalLightOn = !directionalLightOn;
     }
     if (key == GLFW_KEY_3 && action == GLFW_PRESS)
     {
         if (SpotLightOn)
         {
-            spotlight1.turnOff();
-            spotlight2.turnOff();
-            spotlight3.turnOff();
-            spotlight4.turnOff();
-            spotlight5.turnOff();
+            for (int i = 0; i < numSpotLights; i++)
+                spotLights[i]->turnOff();
             SpotLightOn = !SpotLightOn;
         }
         else
         {
-            spotlight1.turnOn();
-            spotlight2.turnOn();
-            spotlight3.turnOn();
-            spotlight4.turnOn();
-            spotlight5.turnOn();
+            for (int i = 0; i < numSpotLights; i++)
+                spotLights[i]->turnOn();
             SpotLightOn = !SpotLightOn;
         }
     }
@@ -3725,6 +1634,8 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
     // make sure the viewport matches the new window dimensions; note that width and
     // height will be significantly larger than specified on retina displays.
     glViewport(0, 0, width, height);
+    framebufferWidth = width;
+    framebufferHeight = height;
 }
 
 
@@ -3758,40 +1669,14 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
     camera.ProcessMouseScroll(static_cast<float>(yoffset));
 }
 
-unsigned int loadTexture(char const* path, GLenum textureWrappingModeS, GLenum textureWrappingModeT, GLenum textureFilteringModeMin, GLenum textureFilteringModeMax)
+// the asset-build step: every texture of the scene file, compressed with its mip chain next to the source
+bool buildTextures(const char* scenePath)
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, textureWrappingModeS);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, textureWrappingModeT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, textureFilteringModeMin);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, textureFilteringModeMax);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
-}
\ No newline at end of file
+    SceneFile sceneFile;
+    if (!sceneFile.load(scenePath))
+        return false;
+    bool built = true;
+    for (size_t i = 0; i < sceneFile.textureCount(); i++)
+        built = buildDDS(sceneFile.textures()[i].path) && built;
+    return built;
+}
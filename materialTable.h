@@ -0,0 +1,153 @@
+//
+//  materialTable.h
+//  test
+//
+//  Every untextured Phong material the scene uses, deduplicated into one
+//  table that lives in a texture buffer. A draw only sets materialIndex and
+//  the fragment shader fetches ambient, diffuse, specular and shininess from
+//  the table, instead of four uniforms being looked up and sent per draw.
+//  Objects register their material when it is set; the table is uploaded
+//  again only after it has grown.
+//
+
+#ifndef materialTable_h
+#define materialTable_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <vector>
+#include "shader.h"
+#include "glResources.h"
+
+// texture units 0 and 1 belong to the material maps, 4 to 6 to the lights, 8 to the buffer
+// textures of queued packets (see renderQueue.h)
+#define MATERIAL_DATA_UNIT 7
+
+// three RGBA32F texels per material, read by FetchMaterial in the fragment shader
+struct MaterialStd140 {
+    glm::vec4 ambient;  // w = shininess
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+};
+
+static_assert(sizeof(MaterialStd140) == 48, "MaterialStd140 must be three RGBA32F texels");
+
+class MaterialTable {
+public:
+    unsigned int uploadedBytes = 0;  // bytes sent by the last update(), 0 when nothing changed
+
+    static MaterialTable& shared()
+    {
+        static MaterialTable table;
+        return table;
+    }
+
+    MaterialTable(const MaterialTable&) = delete;
+    MaterialTable& operator=(const MaterialTable&) = delete;
+
+    ~MaterialTable()
+    {
+        release();
+    }
+
+    // needs a current GL context, so call it after glad is loaded
+    void create()
+    {
+        genBuffers(1, &buffer);
+        glGenTextures(1, &texture);
+        activeTexture(GL_TEXTURE0 + MATERIAL_DATA_UNIT);
+        bindTexture(GL_TEXTURE_BUFFER, texture);
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, sizeof(MaterialStd140), NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+        activeTexture(GL_TEXTURE0);
+    }
+
+    // the table outlives main(), so its GL objects are released explicitly while the context is still there
+    void release()
+    {
+        if (buffer != 0)
+            deleteBuffers(1, &buffer);
+        if (texture != 0)
+        {
+            forgetTexture(texture);
+            glDeleteTextures(1, &texture);
+        }
+        buffer = texture = 0;
+        capacity = uploadedCount = 0;
+    }
+
+    void bindTo(Shader& shader)
+    {
+        shader.use();
+        shader.setInt("materialData", MATERIAL_DATA_UNIT);
+    }
+
+    // index of the material, added if no equal one is in the table yet
+    int add(const glm::vec3& ambient, const glm::vec3& diffuse, const glm::vec3& specular, float shininess)
+    {
+        MaterialStd140 material;
+        material.ambient = glm::vec4(ambient, shininess);
+        material.diffuse = glm::vec4(diffuse, 0.0f);
+        material.specular = glm::vec4(specular, 0.0f);
+
+        std::map<MaterialStd140, int, MaterialLess>::iterator it = index.find(material);
+        if (it != index.end())
+            return it->second;
+        materials.push_back(material);
+        index[material] = (int)materials.size() - 1;
+        return (int)materials.size() - 1;
+    }
+
+    size_t size() const
+    {
+        return materials.size();
+    }
+
+    // sends the table when materials were added since the last call
+    void update()
+    {
+        uploadedBytes = 0;
+        if (buffer == 0 || materials.size() == uploadedCount)
+            return;
+
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        if (materials.size() > capacity)
+        {
+            capacity = materials.size();
+            glBufferData(GL_TEXTURE_BUFFER, capacity * sizeof(MaterialStd140), NULL, GL_STATIC_DRAW);
+            uploadedCount = 0;
+        }
+        glBufferSubData(GL_TEXTURE_BUFFER, uploadedCount * sizeof(MaterialStd140), (materials.size() - uploadedCount) * sizeof(MaterialStd140),
+            &materials[uploadedCount]);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        uploadedBytes = (unsigned int)((materials.size() - uploadedCount) * sizeof(MaterialStd140));
+        uploadedCount = materials.size();
+    }
+
+private:
+    struct MaterialLess {
+        bool operator()(const MaterialStd140& a, const MaterialStd140& b) const
+        {
+            return memcmp(&a, &b, sizeof(MaterialStd140)) < 0;
+        }
+    };
+
+    unsigned int buffer = 0, texture = 0;
+    size_t capacity = 0;       // materials the buffer has room for
+    size_t uploadedCount = 0;  // materials already in the buffer
+    std::vector<MaterialStd140> materials;
+    std::map<MaterialStd140, int, MaterialLess> index;
+
+    // index 0 is what an object draws with before it was given a material
+    MaterialTable()
+    {
+        add(glm::vec3(1.0f), glm::vec3(1.0f), glm::vec3(0.5f), 32.0f);
+    }
+};
+
+#endif /* materialTable_h */
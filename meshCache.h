@@ -0,0 +1,146 @@
+//
+//  meshCache.h
+//  test
+//
+//  Geometry shared between mesh instances. A mesh is keyed by its primitive
+//  type and shape parameters; the first instance uploads it, every later one
+//  with the same key just takes a reference. Anything that differs between
+//  instances (material, texture, texture coordinate range) is set per draw.
+//
+
+#ifndef meshCache_h
+#define meshCache_h
+
+#include <glad/glad.h>
+#include <cstdio>
+#include <map>
+#include <string>
+#include "glResources.h"
+#include "bounds.h"
+#include "occlusion.h"
+
+// vertices are position/normal[/texcoord]; each layout gets its own VAO over the same buffers
+struct SharedMesh {
+    unsigned int VBO = 0, EBO = 0;
+    unsigned int texturedVAO = 0;  // position, normal, texture coordinates (0 for untextured data)
+    unsigned int litVAO = 0;       // position, normal
+    unsigned int colorVAO = 0;     // position
+    GLsizei indexCount = 0;
+    Bounds bounds;  // of the vertex positions
+    OccluderMesh occluder;  // CPU copy of the triangles, left empty for large meshes
+    int references = 0;
+    std::string key;
+};
+
+class MeshCache {
+public:
+    unsigned int uploads = 0;  // meshes that were built
+    unsigned int hits = 0;     // instances that reused one
+
+    static MeshCache& shared()
+    {
+        static MeshCache cache;
+        return cache;
+    }
+
+    // "Cylinder" + (0.4, 1.0, 36) -> "Cylinder(0.400000006,1,36)"; 9 digits tell every float apart,
+    // so two sets of parameters only share a mesh when they are the same numbers
+    static std::string key(const char* type, float a = 0.0f, float b = 0.0f, float c = 0.0f)
+    {
+        char buffer[128];
+        snprintf(buffer, sizeof(buffer), "%s(%.9g,%.9g,%.9g)", type, a, b, c);
+        return buffer;
+    }
+
+    // the mesh for key with one more reference, or NULL if it has not been built yet
+    SharedMesh* acquire(const std::string& key)
+    {
+        std::map<std::string, SharedMesh>::iterator it = meshes.find(key);
+        if (it == meshes.end())
+            return NULL;
+        it->second.references++;
+        hits++;
+        return &it->second;
+    }
+
+    // uploads the data under key; stride is in floats, 8 with texture coordinates and 6 without
+    SharedMesh* create(const std::string& key, const float* vertices, size_t vertexBytes, int stride,
+        const unsigned int* indices, size_t indexBytes)
+    {
+        SharedMesh* existing = acquire(key);
+        if (existing != NULL)
+            return existing;
+
+        SharedMesh& mesh = meshes[key];
+        mesh.key = key;
+        mesh.references = 1;
+        mesh.indexCount = (GLsizei)(indexBytes / sizeof(unsigned int));
+        mesh.bounds = Bounds::fromVertices(vertices, vertexBytes / sizeof(float) / stride, stride);
+        if (mesh.indexCount <= OCCLUDER_MAX_INDICES)
+            mesh.occluder = OccluderMesh::fromVertices(vertices, vertexBytes / sizeof(float) / stride, stride, indices, mesh.indexCount);
+
+        genBuffers(1, &mesh.VBO);
+        genBuffers(1, &mesh.EBO);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertices, GL_STATIC_DRAW);
+
+        if (stride >= 8)
+            mesh.texturedVAO = makeVAO(mesh, stride, 3);
+        mesh.litVAO = makeVAO(mesh, stride, 2);
+        mesh.colorVAO = makeVAO(mesh, stride, 1);
+
+        // the element buffer binding is VAO state, so it is filled with the last VAO still bound
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, indices, GL_STATIC_DRAW);
+        bindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        uploads++;
+        return &mesh;
+    }
+
+    // drops one reference; the GL objects go away with the last one
+    void release(SharedMesh* mesh)
+    {
+        if (mesh == NULL || --mesh->references > 0)
+            return;
+        deleteVertexArrays(1, &mesh->texturedVAO);
+        deleteVertexArrays(1, &mesh->litVAO);
+        deleteVertexArrays(1, &mesh->colorVAO);
+        deleteBuffers(1, &mesh->VBO);
+        deleteBuffers(1, &mesh->EBO);
+        std::string key = mesh->key;
+        meshes.erase(key);
+    }
+
+    size_t size() const
+    {
+        return meshes.size();
+    }
+
+private:
+    std::map<std::string, SharedMesh> meshes;  // node based, so SharedMesh pointers stay valid
+
+    MeshCache() {}
+    MeshCache(const MeshCache&) = delete;
+    MeshCache& operator=(const MeshCache&) = delete;
+
+    // enables the first attributeCount of position, normal, texcoord
+    static unsigned int makeVAO(const SharedMesh& mesh, int stride, int attributeCount)
+    {
+        static const int sizes[3] = { 3, 3, 2 };
+        unsigned int vao;
+        genVertexArrays(1, &vao);
+        bindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+        int offset = 0;
+        for (int i = 0; i < attributeCount; i++)
+        {
+            glVertexAttribPointer(i, sizes[i], GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(offset * sizeof(float)));
+            glEnableVertexAttribArray(i);
+            offset += sizes[i];
+        }
+        return vao;
+    }
+};
+
+#endif /* meshCache_h */
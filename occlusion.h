@@ -0,0 +1,429 @@
+//
+//  occlusion.h
+//  test
+//
+//  Occlusion culling on the CPU. Every frame the largest occluders in view
+//  (walls, roofs, floors) are rasterized into a small depth buffer that
+//  keeps the nearest depth per pixel. This runs on a worker thread while the
+//  main thread uploads lights and sets up shaders. On top of the buffer a
+//  second level keeps the furthest depth of every 8x8 tile, so testing a box
+//  mostly looks at tiles: where a tile's furthest occluder is still in front
+//  of the box's nearest point, the box is hidden there. Only the tiles that
+//  are not decided that way are checked pixel by pixel.
+//
+//  Rasterizing and testing handle four pixels at a time with SSE2 where the
+//  compiler targets it, and fall back to plain loops otherwise.
+//
+
+#ifndef occlusion_h
+#define occlusion_h
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "bounds.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_SSE 1
+#endif
+
+// the depth buffer; the width must stay a multiple of 4 and both a multiple of the tile size
+#define OCCLUSION_WIDTH 256
+#define OCCLUSION_HEIGHT 128
+#define OCCLUSION_TILE 8
+#define OCCLUSION_MAX_OCCLUDERS 32
+// occluders smaller than this on screen (radius over distance) hide too little to be worth drawing
+#define OCCLUSION_MIN_SIZE 0.05f
+// meshes with more indices than this keep no copy on the CPU
+#define OCCLUDER_MAX_INDICES 4096
+// clip-space w below which a point counts as at or behind the eye
+#define OCCLUSION_CLIP_EPSILON 1e-5f
+
+// the triangles of a mesh kept on the CPU for the occlusion rasterizer
+struct OccluderMesh {
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+
+    bool empty() const
+    {
+        return indices.empty();
+    }
+
+    // stride is in floats and the position comes first
+    static OccluderMesh fromVertices(const float* vertices, size_t vertexCount, int stride, const unsigned int* indices, size_t indexCount)
+    {
+        OccluderMesh mesh;
+        mesh.positions.resize(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++)
+            mesh.positions[i] = glm::vec3(vertices[i * stride], vertices[i * stride + 1], vertices[i * stride + 2]);
+        mesh.indices.assign(indices, indices + indexCount);
+        return mesh;
+    }
+};
+
+// a placed occluder; world is its box, for picking the ones in view
+struct Occluder {
+    const OccluderMesh* mesh;
+    glm::mat4 model;
+    Bounds world;
+};
+
+class OcclusionCuller {
+public:
+    unsigned int occludersDrawn = 0;   // occluders the last frame rasterized
+    unsigned int trianglesDrawn = 0;   // their triangles, after clipping
+    unsigned int boxesTested = 0;      // occluded() calls since the last begin()
+    unsigned int boxesOccluded = 0;    // of those, the boxes found hidden
+    double rasterMilliseconds = 0.0;   // time the last frame's rasterization took
+
+    // without a thread begin() rasterizes on the spot
+    explicit OcclusionCuller(bool threaded = true)
+        : depth(OCCLUSION_WIDTH * OCCLUSION_HEIGHT, 1.0f), tileMax(TILES_X * TILES_Y, 1.0f)
+    {
+        if (threaded)
+            worker = std::thread(&OcclusionCuller::work, this);
+    }
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    ~OcclusionCuller()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (worker.joinable())
+            worker.join();
+    }
+
+    // starts the depth buffer for this frame; occluders must stay untouched until wait()
+    void begin(const glm::mat4& viewProjection, const glm::vec3& eye, const std::vector<Occluder>& occluders)
+    {
+        wait();
+        this->viewProjection = viewProjection;
+        this->eye = eye;
+        source = &occluders;
+        boxesTested = boxesOccluded = 0;
+        started = true;
+        waited = false;
+        if (!worker.joinable())
+        {
+            render();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready = false;
+            requested = true;
+        }
+        wake.notify_one();
+    }
+
+    // blocks until the buffer begin() started is complete
+    void wait()
+    {
+        if (!started || waited)
+            return;
+        if (worker.joinable())
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this] { return ready; });
+        }
+        waited = true;
+    }
+
+    // whether the whole box is behind the occluders; false until a frame was begun and waited for
+    bool occluded(const Bounds& world)
+    {
+        if (!waited || world.empty())
+            return false;
+        boxesTested++;
+
+        // the screen rectangle and nearest depth of the box; a box reaching behind the eye stays visible
+        float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, nearest = FLT_MAX;
+        for (int i = 0; i < 8; i++)
+        {
+            glm::vec3 corner((i & 1) ? world.max.x : world.min.x, (i & 2) ? world.max.y : world.min.y, (i & 4) ? world.max.z : world.min.z);
+            glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+            if (clip.w <= OCCLUSION_CLIP_EPSILON || clip.z < -clip.w)
+                return false;
+            float x = (clip.x / clip.w * 0.5f + 0.5f) * OCCLUSION_WIDTH;
+            float y = (clip.y / clip.w * 0.5f + 0.5f) * OCCLUSION_HEIGHT;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            nearest = std::min(nearest, clip.z / clip.w);
+        }
+        int x0 = std::max(0, (int)floorf(minX)), x1 = std::min(OCCLUSION_WIDTH - 1, (int)floorf(maxX));
+        int y0 = std::max(0, (int)floorf(minY)), y1 = std::min(OCCLUSION_HEIGHT - 1, (int)floorf(maxY));
+        if (x0 > x1 || y0 > y1)
+            return false;
+
+        for (int ty = y0 / OCCLUSION_TILE; ty <= y1 / OCCLUSION_TILE; ty++)
+        {
+            for (int tx = x0 / OCCLUSION_TILE; tx <= x1 / OCCLUSION_TILE; tx++)
+            {
+                if (tileMax[ty * TILES_X + tx] < nearest)
+                    continue;
+                int px0 = std::max(x0, tx * OCCLUSION_TILE), px1 = std::min(x1, tx * OCCLUSION_TILE + OCCLUSION_TILE - 1);
+                int py0 = std::max(y0, ty * OCCLUSION_TILE), py1 = std::min(y1, ty * OCCLUSION_TILE + OCCLUSION_TILE - 1);
+                // the furthest pixel of a tile the box covers whole is not in front of it
+                if (px1 - px0 == OCCLUSION_TILE - 1 && py1 - py0 == OCCLUSION_TILE - 1)
+                    return false;
+                if (anyAtOrBehind(px0, px1, py0, py1, nearest))
+                    return false;
+            }
+        }
+        boxesOccluded++;
+        return true;
+    }
+
+private:
+    enum {
+        TILES_X = OCCLUSION_WIDTH / OCCLUSION_TILE,
+        TILES_Y = OCCLUSION_HEIGHT / OCCLUSION_TILE
+    };
+
+    std::vector<float> depth;    // nearest occluder depth (z / w) per pixel, 1 where there is none
+    std::vector<float> tileMax;  // the furthest of those per tile
+    glm::mat4 viewProjection;
+    glm::vec3 eye;
+    const std::vector<Occluder>* source = NULL;
+    std::vector<std::pair<float, unsigned int> > picked;
+    std::vector<glm::vec4> clipped;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    bool requested = false, ready = false, stopping = false;
+    bool started = false, waited = false;  // main thread only
+
+    void work()
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || requested; });
+                if (stopping)
+                    return;
+                requested = false;
+            }
+            render();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready = true;
+            }
+            done.notify_one();
+        }
+    }
+
+    // the largest occluders in view, nearest depth per pixel, then the tile level
+    void render()
+    {
+        std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+        std::fill(depth.begin(), depth.end(), 1.0f);
+        occludersDrawn = trianglesDrawn = 0;
+
+        const std::vector<Occluder>& occluders = *source;
+        Frustum frustum(viewProjection);
+        picked.clear();
+        for (size_t i = 0; i < occluders.size(); i++)
+        {
+            const Occluder& occluder = occluders[i];
+            if (occluder.mesh == NULL || occluder.mesh->empty() || !frustum.visible(occluder.world))
+                continue;
+            float distance = std::max(glm::length(occluder.world.center() - eye), 0.001f);
+            float size = glm::length(occluder.world.extent()) / distance;
+            if (size >= OCCLUSION_MIN_SIZE)
+                picked.push_back(std::make_pair(size, (unsigned int)i));
+        }
+        size_t count = std::min(picked.size(), (size_t)OCCLUSION_MAX_OCCLUDERS);
+        std::partial_sort(picked.begin(), picked.begin() + count, picked.end(),
+            [](const std::pair<float, unsigned int>& a, const std::pair<float, unsigned int>& b) { return a.first > b.first; });
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const Occluder& occluder = occluders[picked[i].second];
+            const OccluderMesh& mesh = *occluder.mesh;
+            glm::mat4 mvp = viewProjection * occluder.model;
+            clipped.resize(mesh.positions.size());
+            for (size_t v = 0; v < mesh.positions.size(); v++)
+                clipped[v] = mvp * glm::vec4(mesh.positions[v], 1.0f);
+            for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+                drawTriangle(clipped[mesh.indices[t]], clipped[mesh.indices[t + 1]], clipped[mesh.indices[t + 2]]);
+            occludersDrawn++;
+        }
+        buildTiles();
+        rasterMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+    }
+
+    // clips against the near plane (z = -w), which leaves at most a quad
+    void drawTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+    {
+        const glm::vec4 in[3] = { a, b, c };
+        glm::vec4 out[4];
+        int n = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            const glm::vec4& current = in[i];
+            const glm::vec4& next = in[(i + 1) % 3];
+            float dc = current.z + current.w, dn = next.z + next.w;
+            if (dc >= 0.0f)
+                out[n++] = current;
+            if ((dc >= 0.0f) != (dn >= 0.0f))
+                out[n++] = current + (next - current) * (dc / (dc - dn));
+        }
+        for (int i = 1; i + 1 < n; i++)
+            rasterize(out[0], out[i], out[i + 1]);
+    }
+
+    void rasterize(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+    {
+        if (a.w <= OCCLUSION_CLIP_EPSILON || b.w <= OCCLUSION_CLIP_EPSILON || c.w <= OCCLUSION_CLIP_EPSILON)
+            return;
+        glm::vec3 p[3] = { screen(a), screen(b), screen(c) };
+        float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+        if (fabsf(area) < 1e-8f)
+            return;
+        if (area < 0.0f)
+        {
+            std::swap(p[1], p[2]);
+            area = -area;
+        }
+
+        int x0 = std::max(0, (int)floorf(std::min(p[0].x, std::min(p[1].x, p[2].x))));
+        int x1 = std::min(OCCLUSION_WIDTH - 1, (int)ceilf(std::max(p[0].x, std::max(p[1].x, p[2].x))));
+        int y0 = std::max(0, (int)floorf(std::min(p[0].y, std::min(p[1].y, p[2].y))));
+        int y1 = std::min(OCCLUSION_HEIGHT - 1, (int)ceilf(std::max(p[0].y, std::max(p[1].y, p[2].y))));
+        if (x0 > x1 || y0 > y1)
+            return;
+        x0 &= ~3;
+        trianglesDrawn++;
+
+        // edge i is opposite vertex i and positive inside; its value over the area is that vertex's weight
+        float A[3], B[3], C[3];
+        for (int i = 0; i < 3; i++)
+        {
+            const glm::vec3& from = p[(i + 1) % 3];
+            const glm::vec3& to = p[(i + 2) % 3];
+            A[i] = from.y - to.y;
+            B[i] = to.x - from.x;
+            C[i] = -(A[i] * from.x + B[i] * from.y);
+        }
+        // depth as a plane over the screen, from the same weights
+        float inverseArea = 1.0f / area;
+        float dA = (p[0].z * A[0] + p[1].z * A[1] + p[2].z * A[2]) * inverseArea;
+        float dB = (p[0].z * B[0] + p[1].z * B[1] + p[2].z * B[2]) * inverseArea;
+        float dC = (p[0].z * C[0] + p[1].z * C[1] + p[2].z * C[2]) * inverseArea;
+
+#ifdef OCCLUSION_SSE
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 lanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        for (int y = y0; y <= y1; y++)
+        {
+            float cy = y + 0.5f;
+            __m128 row0 = _mm_set1_ps(B[0] * cy + C[0]), row1 = _mm_set1_ps(B[1] * cy + C[1]), row2 = _mm_set1_ps(B[2] * cy + C[2]);
+            __m128 rowDepth = _mm_set1_ps(dB * cy + dC);
+            float* line = &depth[y * OCCLUSION_WIDTH];
+            for (int x = x0; x <= x1; x += 4)
+            {
+                __m128 cx = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+                __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A[0]), cx), row0);
+                __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A[1]), cx), row1);
+                __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A[2]), cx), row2);
+                __m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+                if (_mm_movemask_ps(inside) == 0)
+                    continue;
+                __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dA), cx), rowDepth);
+                __m128 old = _mm_loadu_ps(line + x);
+                __m128 nearer = _mm_min_ps(old, z);
+                _mm_storeu_ps(line + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+            }
+        }
+#else
+        for (int y = y0; y <= y1; y++)
+        {
+            float cy = y + 0.5f;
+            float* line = &depth[y * OCCLUSION_WIDTH];
+            for (int x = x0; x <= x1; x++)
+            {
+                float cx = x + 0.5f;
+                if (A[0] * cx + B[0] * cy + C[0] < 0.0f || A[1] * cx + B[1] * cy + C[1] < 0.0f || A[2] * cx + B[2] * cy + C[2] < 0.0f)
+                    continue;
+                line[x] = std::min(line[x], dA * cx + dB * cy + dC);
+            }
+        }
+#endif
+    }
+
+    // pixels across, pixels up and z / w of a clip-space point
+    static glm::vec3 screen(const glm::vec4& clip)
+    {
+        float inverseW = 1.0f / clip.w;
+        return glm::vec3((clip.x * inverseW * 0.5f + 0.5f) * OCCLUSION_WIDTH, (clip.y * inverseW * 0.5f + 0.5f) * OCCLUSION_HEIGHT, clip.z * inverseW);
+    }
+
+    void buildTiles()
+    {
+        for (int ty = 0; ty < TILES_Y; ty++)
+        {
+            for (int tx = 0; tx < TILES_X; tx++)
+            {
+                const float* first = &depth[ty * OCCLUSION_TILE * OCCLUSION_WIDTH + tx * OCCLUSION_TILE];
+#ifdef OCCLUSION_SSE
+                __m128 furthest = _mm_loadu_ps(first);
+                for (int y = 0; y < OCCLUSION_TILE; y++)
+                    for (int x = 0; x < OCCLUSION_TILE; x += 4)
+                        furthest = _mm_max_ps(furthest, _mm_loadu_ps(first + y * OCCLUSION_WIDTH + x));
+                furthest = _mm_max_ps(furthest, _mm_shuffle_ps(furthest, furthest, _MM_SHUFFLE(1, 0, 3, 2)));
+                furthest = _mm_max_ps(furthest, _mm_shuffle_ps(furthest, furthest, _MM_SHUFFLE(2, 3, 0, 1)));
+                tileMax[ty * TILES_X + tx] = _mm_cvtss_f32(furthest);
+#else
+                float furthest = first[0];
+                for (int y = 0; y < OCCLUSION_TILE; y++)
+                    for (int x = 0; x < OCCLUSION_TILE; x++)
+                        furthest = std::max(furthest, first[y * OCCLUSION_WIDTH + x]);
+                tileMax[ty * TILES_X + tx] = furthest;
+#endif
+            }
+        }
+    }
+
+    // whether a pixel of the rectangle has no occluder in front of depth
+    bool anyAtOrBehind(int x0, int x1, int y0, int y1, float nearest) const
+    {
+#ifdef OCCLUSION_SSE
+        const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        const __m128 first = _mm_set1_ps((float)x0), last = _mm_set1_ps((float)x1), limit = _mm_set1_ps(nearest);
+        for (int y = y0; y <= y1; y++)
+        {
+            const float* line = &depth[y * OCCLUSION_WIDTH];
+            for (int x = x0 & ~3; x <= x1; x += 4)
+            {
+                __m128 index = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+                __m128 inRange = _mm_and_ps(_mm_cmpge_ps(index, first), _mm_cmple_ps(index, last));
+                if (_mm_movemask_ps(_mm_and_ps(inRange, _mm_cmpge_ps(_mm_loadu_ps(line + x), limit))) != 0)
+                    return true;
+            }
+        }
+#else
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++)
+                if (depth[y * OCCLUSION_WIDTH + x] >= nearest)
+                    return true;
+#endif
+        return false;
+    }
+};
+
+#endif /* occlusion_h */
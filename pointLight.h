@@ -16,6 +16,21 @@
 
 using namespace std;
 
+// lights dimmer than this fraction of full intensity are treated as out of range when culling
+#define LIGHT_CUTOFF (1.0f / 256.0f)
+
+// one light in the point light texture buffer: four RGBA32F texels, each vec3 packed with the float after it
+struct PointLightStd140 {
+    glm::vec3 position;
+    float k_c;
+    glm::vec3 ambient;
+    float k_l;
+    glm::vec3 diffuse;
+    float k_q;
+    glm::vec3 specular;
+    float radius;
+};
+
 class PointLight {
 public:
     glm::vec3 position;
@@ -26,6 +41,7 @@ public:
     float k_l;
     float k_q;
     int Number;
+    bool dirty = true;  // set whenever the light changes; the light block re-uploads it and clears this
 
     PointLight(float posX, float posY, float posZ, float ambR, float ambG, float ambB, float diffR, float diffG, float diffB, float specR, float specG, float specB, float constant, float linear, float quadratic, int num) {
         position = glm::vec3(posX, posY, posZ);
@@ -38,17 +54,36 @@ public:
         Number = num - 1;
     }
 
-    void setUpPointLight(Shader& lightingShader)
+    // writes the light as the shader sees it, with the on/off switches applied
+    void writeStd140(PointLightStd140& block) const
+    {
+        block.position = position;
+        block.ambient = ambient * ambientOn;
+        block.diffuse = diffuse * diffuseOn;
+        block.specular = specular * specularOn;
+        block.k_c = k_c;
+        block.k_l = k_l;
+        block.k_q = k_q;
+        block.radius = effectiveRadius();
+    }
+
+    // distance where the brightest switched-on channel, attenuated, drops below LIGHT_CUTOFF;
+    // 0 for a light that is off, so it never lands in a cluster
+    float effectiveRadius() const
     {
-        lightingShader.use();
-        string lightNumber = to_string(Number);
-        lightingShader.setVec3("pointLights[" + lightNumber + "].position", position);
-        lightingShader.setVec3("pointLights[" + lightNumber + "].ambient", ambient * ambientOn);
-        lightingShader.setVec3("pointLights[" + lightNumber + "].diffuse", diffuse * diffuseOn);
-        lightingShader.setVec3("pointLights[" + lightNumber + "].specular", specular * specularOn);
-        lightingShader.setFloat("pointLights[" + lightNumber + "].k_c", k_c);
-        lightingShader.setFloat("pointLights[" + lightNumber + "].k_l", k_l);
-        lightingShader.setFloat("pointLights[" + lightNumber + "].k_q", k_q);
+        glm::vec3 brightest = glm::max(ambient * ambientOn, glm::max(diffuse * diffuseOn, specular * specularOn));
+        float intensity = glm::max(brightest.x, glm::max(brightest.y, brightest.z));
+        if (intensity <= 0.0f)
+            return 0.0f;
+        // solve k_q * r^2 + k_l * r + k_c = intensity / LIGHT_CUTOFF for r
+        float c = k_c - intensity / LIGHT_CUTOFF;
+        if (c >= 0.0f)
+            return 0.0f;
+        if (k_q > 0.0f)
+            return (-k_l + sqrt(k_l * k_l - 4.0f * k_q * c)) / (2.0f * k_q);
+        if (k_l > 0.0f)
+            return -c / k_l;
+        return 1.0e6f;  // no falloff at all: reaches everything
     }
 
     void turnOff()
@@ -56,6 +91,7 @@ public:
         ambientOn = 0.0;
         diffuseOn = 0.0;
         specularOn = 0.0;
+        dirty = true;
     }
 
     void turnOn()
@@ -63,36 +99,43 @@ public:
         ambientOn = 1.0;
         diffuseOn = 1.0;
         specularOn = 1.0;
+        dirty = true;
     }
 
     void turnAmbientOn()
     {
         ambientOn = 1.0;
+        dirty = true;
     }
 
     void turnAmbientOff()
     {
         ambientOn = 0.0;
+        dirty = true;
     }
 
     void turnDiffuseOn()
     {
         diffuseOn = 1.0;
+        dirty = true;
     }
 
     void turnDiffuseOff()
     {
         diffuseOn = 0.0;
+        dirty = true;
     }
 
     void turnSpecularOn()
     {
         specularOn = 1.0;
+        dirty = true;
     }
 
     void turnSpecularOff()
     {
         specularOn = 0.0;
+        dirty = true;
     }
 
 private:
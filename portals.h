@@ -0,0 +1,158 @@
+//
+//  portals.h
+//  test
+//
+//  Cell-and-portal visibility for a building with one inside and one
+//  outside. Every node is put in the interior cell, the exterior cell or
+//  both (walls and anything else that straddles the interior box). The
+//  cells only see each other through portals, the door openings, and a
+//  portal only counts while its door is open and the opening is in view.
+//  Each such portal narrows the view to the frustum from the eye through
+//  the opening, and a node of the other cell is drawn only if it lies in
+//  one of those frusta.
+//
+
+#ifndef portals_h
+#define portals_h
+
+#include <glm/glm.hpp>
+#include <vector>
+#include "bounds.h"
+
+enum CellMask {
+    CELL_INTERIOR = 1,
+    CELL_EXTERIOR = 2,
+    CELL_BOTH = CELL_INTERIOR | CELL_EXTERIOR
+};
+
+// slack for boxes that touch the interior box; walls are thicker than this
+#define CELL_MARGIN 0.05f
+// an eye this close to an opening sees the other cell without narrowing
+#define PORTAL_STRADDLE_DISTANCE 0.5f
+
+class CellPortals {
+public:
+    unsigned int portalsInView = 0;  // open portals the last update() looked through
+
+    CellPortals() {}
+
+    void setInterior(const Bounds& box)
+    {
+        interior = box;
+    }
+
+    // a rectangular opening, corners in order around it; open is read every frame
+    void addPortal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& d, const bool* open)
+    {
+        Portal portal;
+        portal.corners[0] = a;
+        portal.corners[1] = b;
+        portal.corners[2] = c;
+        portal.corners[3] = d;
+        portal.open = open;
+        for (int i = 0; i < 4; i++)
+            portal.bounds.add(portal.corners[i]);
+        portals.push_back(portal);
+    }
+
+    size_t portalCount() const
+    {
+        return portals.size();
+    }
+
+    // the cells a node with this world box belongs to; everything belongs to both without an interior
+    int classify(const Bounds& world) const
+    {
+        if (interior.empty() || world.empty())
+            return CELL_BOTH;
+        if (interior.expanded(CELL_MARGIN).contains(world))
+            return CELL_INTERIOR;
+        if (!interior.expanded(-CELL_MARGIN).intersects(world))
+            return CELL_EXTERIOR;
+        return CELL_BOTH;
+    }
+
+    // once per frame, before any visible() call
+    void update(const glm::vec3& eye, const Frustum& view)
+    {
+        eyeCell = interior.empty() ? CELL_BOTH : (interior.contains(eye) ? CELL_INTERIOR : CELL_EXTERIOR);
+        otherCellVisible = false;
+        views.clear();
+        for (size_t i = 0; i < portals.size(); i++)
+        {
+            const Portal& portal = portals[i];
+            if (!*portal.open || !view.visible(portal.bounds))
+                continue;
+            if (portal.bounds.expanded(PORTAL_STRADDLE_DISTANCE).contains(eye))
+            {
+                // standing in the doorway: the narrowed frustum would be degenerate
+                otherCellVisible = true;
+                continue;
+            }
+            views.push_back(throughPortal(portal, eye, view));
+        }
+        portalsInView = (unsigned int)views.size() + (otherCellVisible ? 1 : 0);
+    }
+
+    // whether anything of the cells in mask can be seen at all this frame
+    bool cellVisible(int mask) const
+    {
+        return (mask & eyeCell) != 0 || otherCellVisible || !views.empty();
+    }
+
+    // for a node already inside the view frustum
+    bool visible(int mask, const Bounds& world) const
+    {
+        if ((mask & eyeCell) != 0 || otherCellVisible)
+            return true;
+        for (size_t i = 0; i < views.size(); i++)
+            if (views[i].visible(world))
+                return true;
+        return false;
+    }
+
+private:
+    struct Portal {
+        glm::vec3 corners[4];
+        Bounds bounds;
+        const bool* open;
+    };
+
+    Bounds interior;
+    std::vector<Portal> portals;
+    int eyeCell = CELL_BOTH;
+    bool otherCellVisible = false;
+    std::vector<Frustum> views;  // one per open portal in view
+
+    // four planes through the eye and the edges of the opening, the opening itself and the far plane
+    static Frustum throughPortal(const Portal& portal, const glm::vec3& eye, const Frustum& view)
+    {
+        glm::vec3 center = (portal.corners[0] + portal.corners[1] + portal.corners[2] + portal.corners[3]) * 0.25f;
+        Frustum frustum;
+        for (int i = 0; i < 4; i++)
+        {
+            const glm::vec3& a = portal.corners[i];
+            const glm::vec3& b = portal.corners[(i + 1) % 4];
+            frustum.planes[i] = facing(glm::cross(a - eye, b - eye), eye, center);
+        }
+        glm::vec3 normal = glm::cross(portal.corners[1] - portal.corners[0], portal.corners[2] - portal.corners[0]);
+        frustum.planes[4] = facing(normal, portal.corners[0], center + (center - eye));
+        frustum.planes[5] = view.planes[5];
+        return frustum;
+    }
+
+    // the plane with normal n through point, turned so inside lies on its positive side
+    static glm::vec4 facing(glm::vec3 n, const glm::vec3& point, const glm::vec3& inside)
+    {
+        n = glm::normalize(n);
+        float d = -glm::dot(n, point);
+        if (glm::dot(n, inside) + d < 0.0f)
+        {
+            n = -n;
+            d = -d;
+        }
+        return glm::vec4(n, d);
+    }
+};
+
+#endif /* portals_h */
@@ -0,0 +1,336 @@
+//
+//  renderQueue.h
+//  test
+//
+//  Draw calls recorded as small packets instead of being issued on the spot.
+//  Each packet gets a 64-bit sort key (program | material | texture | VAO |
+//  depth); submit() radix-sorts the keys and issues the whole frame in one
+//  pass, setting material uniforms only when they differ from what the
+//  program last saw and leaving redundant binds to the state cache
+//  (glState.h). Program and texture switches then follow the number of
+//  distinct states rather than the number of objects, and equal states are
+//  drawn front to back.
+//
+
+#ifndef renderQueue_h
+#define renderQueue_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+#include "shader.h"
+
+// where a packet's buffer texture is bound; 0 and 1 hold the material maps, 4 to 6 the light data
+// and 7 the material table (see materialTable.h), which is bound once and must not be displaced
+#define PACKET_BUFFER_UNIT 8
+
+// which material uniforms the packet's program reads
+enum PacketKind {
+    PACKET_TEXTURED,  // diffuse/specular maps, shininess, textureRange
+    PACKET_LIT,       // a row of the MaterialTable
+    PACKET_COLOR      // one flat color
+};
+
+// every field is 4 bytes wide, so two materials compare equal with memcmp
+struct PacketMaterial {
+    int kind;
+    int materialIndex;  // PACKET_LIT
+    glm::vec3 color;    // PACKET_COLOR
+    float shininess;
+    glm::vec4 textureRange;
+    float lineWidth;
+};
+
+struct DrawPacket {
+    glm::mat4 model;
+    unsigned int VAO;
+    unsigned int diffuseMap, specularMap;
+    unsigned int bufferTexture;  // 0 for none, else bound at PACKET_BUFFER_UNIT
+    GLenum mode;
+    GLsizei count;
+    bool indexed;
+    unsigned int program, material, textures;  // indices into the queue's tables
+};
+
+class RenderQueue {
+public:
+    // what the last submit() issued; the binds themselves are counted in glStateStats()
+    unsigned int packetCount = 0;
+    unsigned int materialChanges = 0;
+
+    RenderQueue() {}
+
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    // for the textured Phong program; shares the arguments of the drawXWithTexture helpers
+    void addTextured(Shader& shader, unsigned int VAO, GLsizei count, unsigned int diffuseMap, unsigned int specularMap, float shininess,
+        const glm::vec4& textureRange, const glm::mat4& model)
+    {
+        PacketMaterial material = blankMaterial(PACKET_TEXTURED);
+        material.shininess = shininess;
+        material.textureRange = textureRange;
+        add(shader, material, VAO, GL_TRIANGLES, count, true, diffuseMap, specularMap, model);
+    }
+
+    // the same material for a program that reads its geometry from bufferTexture; count vertices
+    // of mode are drawn without indices
+    void addTexturedBuffer(Shader& shader, unsigned int VAO, GLenum mode, GLsizei count, unsigned int bufferTexture, unsigned int diffuseMap,
+        unsigned int specularMap, float shininess, const glm::vec4& textureRange, const glm::mat4& model)
+    {
+        PacketMaterial material = blankMaterial(PACKET_TEXTURED);
+        material.shininess = shininess;
+        material.textureRange = textureRange;
+        add(shader, material, VAO, mode, count, false, diffuseMap, specularMap, model);
+        packets.back().bufferTexture = bufferTexture;
+    }
+
+    // for the untextured Phong program; materialIndex comes from MaterialTable::add
+    void addLit(Shader& shader, unsigned int VAO, GLsizei count, int materialIndex, const glm::mat4& model)
+    {
+        PacketMaterial material = blankMaterial(PACKET_LIT);
+        material.materialIndex = materialIndex;
+        add(shader, material, VAO, GL_TRIANGLES, count, true, 0, 0, model);
+    }
+
+    // for programs with a flat "color"; lines may ask for a width
+    void addColor(Shader& shader, unsigned int VAO, GLenum mode, GLsizei count, bool indexed, const glm::vec3& color, const glm::mat4& model,
+        float lineWidth = 1.0f)
+    {
+        PacketMaterial material = blankMaterial(PACKET_COLOR);
+        material.color = color;
+        material.lineWidth = lineWidth;
+        add(shader, material, VAO, mode, count, indexed, 0, 0, model);
+    }
+
+    size_t size() const
+    {
+        return packets.size();
+    }
+
+    // sorts and issues everything queued since the last submit; depth is measured in view space up to far
+    void submit(const glm::mat4& view, float far)
+    {
+        packetCount = (unsigned int)packets.size();
+        materialChanges = 0;
+        if (packets.empty())
+            return;
+
+        entries.resize(packets.size());
+        for (size_t i = 0; i < packets.size(); i++)
+        {
+            entries[i].key = sortKey(packets[i], view, far);
+            entries[i].packet = (unsigned int)i;
+        }
+        radixSort();
+
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            const DrawPacket& packet = packets[entries[i].packet];
+            ProgramState& program = programs[packet.program];
+            const PacketMaterial& material = materials[packet.material];
+
+            // glState.h drops the binds that repeat the previous packet's state
+            program.shader->use();
+            if (material.kind == PACKET_TEXTURED && !program.samplersSet)
+            {
+                program.shader->setInt(program.diffuseSampler, 0);
+                program.shader->setInt(program.specularSampler, 1);
+                program.samplersSet = true;
+            }
+
+            // uniforms stay with their program, so each program remembers the material it last saw
+            if (packet.material != program.material)
+            {
+                applyMaterial(program, material);
+                program.material = packet.material;
+                materialChanges++;
+            }
+
+            if (material.kind == PACKET_TEXTURED)
+            {
+                bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, packet.diffuseMap);
+                bindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D, packet.specularMap);
+            }
+            if (packet.bufferTexture != 0)
+                bindTextureUnit(GL_TEXTURE0 + PACKET_BUFFER_UNIT, GL_TEXTURE_BUFFER, packet.bufferTexture);
+            lineWidth(material.lineWidth);
+            bindVertexArray(packet.VAO);
+
+            program.shader->setMat4(program.model, packet.model);
+            if (packet.indexed)
+                glDrawElements(packet.mode, packet.count, GL_UNSIGNED_INT, 0);
+            else
+                glDrawArrays(packet.mode, 0, packet.count);
+        }
+
+        lineWidth(1.0f);
+        packets.clear();
+
+        // other code may have changed these between frames
+        for (size_t i = 0; i < programs.size(); i++)
+            programs[i].material = NO_MATERIAL;
+    }
+
+private:
+    static const unsigned int NO_MATERIAL = 0xFFFFFFFFu;
+
+    // uniform handles resolved once per program
+    struct ProgramState {
+        Shader* shader;
+        UniformHandle model, color;
+        UniformHandle materialIndex, shininess, textureRange;
+        UniformHandle diffuseSampler, specularSampler;
+        unsigned int material;
+        bool samplersSet;
+    };
+
+    struct SortEntry {
+        uint64_t key;
+        unsigned int packet;
+    };
+
+    struct MaterialLess {
+        bool operator()(const PacketMaterial& a, const PacketMaterial& b) const
+        {
+            return memcmp(&a, &b, sizeof(PacketMaterial)) < 0;
+        }
+    };
+
+    std::vector<DrawPacket> packets;
+    std::vector<SortEntry> entries, scratch;
+    std::vector<ProgramState> programs;
+    std::map<unsigned int, unsigned int> programIndex;  // program ID -> programs
+    std::vector<PacketMaterial> materials;
+    std::map<PacketMaterial, unsigned int, MaterialLess> materialIndex;
+    std::map<std::pair<unsigned int, unsigned int>, unsigned int> textureIndex;  // (diffuse, specular) -> sort id
+
+    static PacketMaterial blankMaterial(int kind)
+    {
+        PacketMaterial material;
+        memset((void*)&material, 0, sizeof(material));
+        material.kind = kind;
+        material.lineWidth = 1.0f;
+        return material;
+    }
+
+    void add(Shader& shader, const PacketMaterial& material, unsigned int VAO, GLenum mode, GLsizei count, bool indexed,
+        unsigned int diffuseMap, unsigned int specularMap, const glm::mat4& model)
+    {
+        DrawPacket packet;
+        packet.model = model;
+        packet.VAO = VAO;
+        packet.diffuseMap = diffuseMap;
+        packet.specularMap = specularMap;
+        packet.bufferTexture = 0;
+        packet.mode = mode;
+        packet.count = count;
+        packet.indexed = indexed;
+        packet.program = programFor(shader);
+        packet.material = materialFor(material);
+        packet.textures = texturesFor(diffuseMap, specularMap);
+        packets.push_back(packet);
+    }
+
+    unsigned int programFor(Shader& shader)
+    {
+        std::map<unsigned int, unsigned int>::iterator it = programIndex.find(shader.ID);
+        if (it != programIndex.end())
+            return it->second;
+
+        ProgramState program;
+        program.shader = &shader;
+        program.model = shader.getUniformHandle("model");
+        program.color = shader.getUniformHandle("color");
+        program.materialIndex = shader.getUniformHandle("materialIndex");
+        program.shininess = shader.getUniformHandle("material.shininess");
+        program.textureRange = shader.getUniformHandle("textureRange");
+        program.diffuseSampler = shader.getUniformHandle("material.diffuse");
+        program.specularSampler = shader.getUniformHandle("material.specular");
+        program.material = NO_MATERIAL;
+        program.samplersSet = false;
+        programs.push_back(program);
+        programIndex[shader.ID] = (unsigned int)programs.size() - 1;
+        return (unsigned int)programs.size() - 1;
+    }
+
+    unsigned int materialFor(const PacketMaterial& material)
+    {
+        std::map<PacketMaterial, unsigned int, MaterialLess>::iterator it = materialIndex.find(material);
+        if (it != materialIndex.end())
+            return it->second;
+        materials.push_back(material);
+        materialIndex[material] = (unsigned int)materials.size() - 1;
+        return (unsigned int)materials.size() - 1;
+    }
+
+    unsigned int texturesFor(unsigned int diffuseMap, unsigned int specularMap)
+    {
+        std::pair<unsigned int, unsigned int> maps(diffuseMap, specularMap);
+        std::map<std::pair<unsigned int, unsigned int>, unsigned int>::iterator it = textureIndex.find(maps);
+        if (it != textureIndex.end())
+            return it->second;
+        unsigned int id = (unsigned int)textureIndex.size();
+        textureIndex[maps] = id;
+        return id;
+    }
+
+    void applyMaterial(const ProgramState& program, const PacketMaterial& material)
+    {
+        Shader& shader = *program.shader;
+        if (material.kind == PACKET_COLOR)
+            shader.setVec3(program.color, material.color);
+        else if (material.kind == PACKET_LIT)
+            shader.setInt(program.materialIndex, material.materialIndex);
+        else
+        {
+            shader.setFloat(program.shininess, material.shininess);
+            shader.setVec4(program.textureRange, material.textureRange);
+        }
+    }
+
+    // program 8 bits | material 12 | texture 12 | VAO 16 | depth 16; the ids only order packets,
+    // the binds compare the real state, so an id that overflows its field costs a bind, not a wrong draw
+    static uint64_t sortKey(const DrawPacket& packet, const glm::mat4& view, float far)
+    {
+        glm::vec4 center = view * packet.model[3];
+        float depth = glm::clamp(-center.z / far, 0.0f, 1.0f);
+        return ((uint64_t)(packet.program & 0xFF) << 56)
+            | ((uint64_t)(packet.material & 0xFFF) << 44)
+            | ((uint64_t)(packet.textures & 0xFFF) << 32)
+            | ((uint64_t)(packet.VAO & 0xFFFF) << 16)
+            | (uint64_t)(depth * 65535.0f);
+    }
+
+    // least significant byte first; a byte that is the same in every key needs no pass
+    void radixSort()
+    {
+        size_t n = entries.size();
+        scratch.resize(n);
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            size_t counts[256] = { 0 };
+            for (size_t i = 0; i < n; i++)
+                counts[(entries[i].key >> shift) & 0xFF]++;
+            if (counts[(entries[0].key >> shift) & 0xFF] == n)
+                continue;
+
+            size_t offset = 0;
+            for (int b = 0; b < 256; b++)
+            {
+                size_t count = counts[b];
+                counts[b] = offset;
+                offset += count;
+            }
+            for (size_t i = 0; i < n; i++)
+                scratch[counts[(entries[i].key >> shift) & 0xFF]++] = entries[i];
+            entries.swap(scratch);
+        }
+    }
+};
+
+#endif /* renderQueue_h */
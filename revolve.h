@@ -0,0 +1,218 @@
+//
+//  revolve.h
+//  test
+//
+//  Surfaces of revolution. A profile is a run of points in the half plane
+//  of the y axis, each with its distance r from the axis, its height y, its
+//  normal in that plane and a v texture coordinate. revolve() sweeps it
+//  around the axis and writes interleaved vertices and triangle indices
+//  straight into buffers sized once up front. The cosine and sine of every
+//  angle of a sweep come from a table cached per sweep, so meshes with the
+//  same sweep share one and no vertex calls cos() or sin().
+//
+//  A vertex lies at x = r cos(angle), z = r sin(angle). A sweep that starts
+//  at pi / 2 and turns by -2 pi puts it at x = r sin(a), z = r cos(a)
+//  instead, which is where the sphere and the roof design have their seam.
+//
+
+#ifndef revolve_h
+#define revolve_h
+
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#define REVOLVE_FULL_TURN 6.28318530717958647692
+
+// one point of a profile; (nr, ny) is the unit normal in the plane of the axis
+struct ProfilePoint {
+    float r, y;
+    float nr, ny;
+    float v;
+};
+
+struct RevolveSweep {
+    int segments;
+    float start;  // radians
+    float turn;   // radians, negative to sweep the other way round
+
+    static RevolveSweep arc(int segments, float start, float turn)
+    {
+        RevolveSweep sweep = { segments, start, turn };
+        return sweep;
+    }
+
+    static RevolveSweep full(int segments)
+    {
+        return arc(segments, 0.0f, (float)REVOLVE_FULL_TURN);
+    }
+
+    bool operator<(const RevolveSweep& other) const
+    {
+        if (segments != other.segments)
+            return segments < other.segments;
+        if (start != other.start)
+            return start < other.start;
+        return turn < other.turn;
+    }
+};
+
+// segments + 1 angles; on a full turn the last is the first again, so the seam closes exactly
+struct SinCosTable {
+    std::vector<float> cosines;
+    std::vector<float> sines;
+};
+
+// built on first use and kept for the lifetime of the program; meshes are only built on the main thread
+inline const SinCosTable& sinCosTable(const RevolveSweep& sweep)
+{
+    static std::map<RevolveSweep, SinCosTable> tables;
+    std::map<RevolveSweep, SinCosTable>::iterator found = tables.find(sweep);
+    if (found != tables.end())
+        return found->second;
+
+    SinCosTable& table = tables[sweep];
+    table.cosines.resize(sweep.segments + 1);
+    table.sines.resize(sweep.segments + 1);
+    for (int j = 0; j <= sweep.segments; j++)
+    {
+        double angle = sweep.start + (double)sweep.turn * j / sweep.segments;
+        table.cosines[j] = (float)cos(angle);
+        table.sines[j] = (float)sin(angle);
+    }
+    if (fabs(fabs((double)sweep.turn) - REVOLVE_FULL_TURN) < 1e-5)
+    {
+        table.cosines[sweep.segments] = table.cosines[0];
+        table.sines[sweep.segments] = table.sines[0];
+    }
+    return table;
+}
+
+enum RevolveFlags {
+    REVOLVE_TEXCOORDS = 1,  // 8 floats a vertex instead of 6: u runs 0 to 1 along the sweep
+    REVOLVE_CAP_FIRST = 2,  // a flat disc closing the first ring, facing -y
+    REVOLVE_CAP_LAST = 4    // a flat disc closing the last ring, facing +y
+};
+
+struct RevolvedMesh {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    int stride = 8;  // floats per vertex
+
+    size_t vertexCount() const
+    {
+        return vertices.size() / stride;
+    }
+};
+
+// rings points of profile(i), i from 0, swept into mesh. A ring at r == 0 is a pole: the
+// triangles that would collapse onto it are left out. Caps get their own rim vertices, so
+// their normals and texture coordinates are those of a flat disc
+template <class Profile>
+void revolve(const Profile& profile, int rings, const RevolveSweep& sweep, RevolvedMesh& mesh, int flags = REVOLVE_TEXCOORDS)
+{
+    const SinCosTable& table = sinCosTable(sweep);
+    const bool textured = (flags & REVOLVE_TEXCOORDS) != 0;
+    const int segments = sweep.segments;
+    const size_t columns = segments + 1;
+    const int caps = ((flags & REVOLVE_CAP_FIRST) ? 1 : 0) + ((flags & REVOLVE_CAP_LAST) ? 1 : 0);
+
+    std::vector<ProfilePoint> points(rings);
+    size_t triangles = (size_t)caps * segments;
+    for (int i = 0; i < rings; i++)
+    {
+        points[i] = profile(i);
+        if (i + 1 < rings)
+            triangles += 2 * segments;
+        // a pole loses one triangle per segment in each band it borders
+        if (points[i].r == 0.0f)
+            triangles -= (size_t)segments * ((i > 0 ? 1 : 0) + (i + 1 < rings ? 1 : 0));
+    }
+
+    mesh.stride = textured ? 8 : 6;
+    mesh.vertices.resize((rings * columns + caps * (columns + 1)) * mesh.stride);
+    mesh.indices.resize(triangles * 3);
+    float* v = mesh.vertices.data();
+    unsigned int* index = mesh.indices.data();
+
+    for (int i = 0; i < rings; i++)
+    {
+        const ProfilePoint& p = points[i];
+        for (int j = 0; j <= segments; j++)
+        {
+            float c = table.cosines[j], s = table.sines[j];
+            *v++ = p.r * c;
+            *v++ = p.y;
+            *v++ = p.r * s;
+            *v++ = p.nr * c;
+            *v++ = p.ny;
+            *v++ = p.nr * s;
+            if (textured)
+            {
+                *v++ = (float)j / segments;
+                *v++ = p.v;
+            }
+        }
+    }
+
+    // k1--k1+1
+    // |  / |
+    // | /  |
+    // k2--k2+1
+    for (int i = 0; i + 1 < rings; i++)
+    {
+        unsigned int k1 = (unsigned int)(i * columns);
+        unsigned int k2 = (unsigned int)(k1 + columns);
+        bool firstPole = points[i].r == 0.0f, secondPole = points[i + 1].r == 0.0f;
+        for (int j = 0; j < segments; j++, k1++, k2++)
+        {
+            if (!firstPole)
+            {
+                *index++ = k1;
+                *index++ = k2;
+                *index++ = k1 + 1;
+            }
+            if (!secondPole)
+            {
+                *index++ = k1 + 1;
+                *index++ = k2;
+                *index++ = k2 + 1;
+            }
+        }
+    }
+
+    // a center and its own rim per cap, after the rings
+    unsigned int base = (unsigned int)(rings * columns);
+    for (int cap = 0; cap < 2; cap++)
+    {
+        if (!(flags & (cap == 0 ? REVOLVE_CAP_FIRST : REVOLVE_CAP_LAST)))
+            continue;
+        const ProfilePoint& p = points[cap == 0 ? 0 : rings - 1];
+        float ny = cap == 0 ? -1.0f : 1.0f;
+        for (int j = -1; j <= segments; j++)
+        {
+            float c = j < 0 ? 0.0f : table.cosines[j], s = j < 0 ? 0.0f : table.sines[j];
+            *v++ = p.r * c;
+            *v++ = p.y;
+            *v++ = p.r * s;
+            *v++ = 0.0f;
+            *v++ = ny;
+            *v++ = 0.0f;
+            if (textured)
+            {
+                *v++ = 0.5f + 0.5f * c;
+                *v++ = 0.5f + 0.5f * s;
+            }
+        }
+        for (int j = 0; j < segments; j++)
+        {
+            *index++ = base;
+            *index++ = base + 1 + (cap == 0 ? j : j + 1);
+            *index++ = base + 1 + (cap == 0 ? j + 1 : j);
+        }
+        base += (unsigned int)columns + 1;
+    }
+}
+
+#endif /* revolve_h */
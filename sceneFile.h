@@ -0,0 +1,527 @@
+//
+//  sceneFile.h
+//  test
+//
+//  Reads the layout of a venue from a text scene file (see auditorium.scene
+//  for the format): the textures, the materials placed by name, the point
+//  and spot lights, the seat rows, the transform of every static object and
+//  the trees scattered over the grounds (see forest.h). A forest is scattered
+//  once, when the text is parsed, from the seed it is given, so the same
+//  file always grows the same trees.
+//  The parsed result is written next to the source as <file>.bin, one header
+//  followed by plain arrays, with the model matrices already evaluated. On
+//  later runs the cache is memory-mapped and used in place; it is rebuilt
+//  whenever the text file changes size or modification time.
+//
+
+#ifndef sceneFile_h
+#define sceneFile_h
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "mappedFile.h"
+
+#define SCENE_CACHE_MAGIC 0x4e435341  // "ASCN"
+#define SCENE_CACHE_VERSION 2
+#define SCENE_NAME_LENGTH 32
+#define SCENE_PATH_LENGTH 128
+
+enum SceneSection {
+    SCENE_TEXTURES,
+    SCENE_MATERIALS,
+    SCENE_POINT_LIGHTS,
+    SCENE_SPOT_LIGHTS,
+    SCENE_OBJECTS,
+    SCENE_SEATS,
+    SCENE_TREES,
+    SCENE_SECTION_COUNT
+};
+
+enum SeatStyle {
+    SEAT_CENTER,
+    SEAT_LEFT,
+    SEAT_RIGHT
+};
+
+// every record is plain data so the cache can be used straight from the file bytes
+struct SceneTexture {
+    char name[SCENE_NAME_LENGTH];
+    char path[SCENE_PATH_LENGTH];
+};
+
+struct SceneMaterial {
+    char name[SCENE_NAME_LENGTH];
+    char kind[SCENE_NAME_LENGTH];     // Cube, Cube2, RightWall, Roof or Angular_roof
+    char texture[SCENE_NAME_LENGTH];
+    float shininess;
+    glm::vec4 textureRange;           // TXmin, TYmin, TXmax, TYmax
+};
+
+struct ScenePointLight {
+    glm::vec3 position;
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+    float k_c, k_l, k_q;
+    float markerSize;                 // the small cube drawn at the light
+    float markerBrightness;
+};
+
+struct SceneSpotLight {
+    glm::vec3 position;
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+    float k_c, k_l, k_q;
+    float innerCutOff, outerCutOff;   // cosines, as SpotLight takes them
+    glm::vec3 direction;
+};
+
+struct SceneObject {
+    char drawable[SCENE_NAME_LENGTH];
+    glm::mat4 model;
+};
+
+struct SceneSeat {
+    int style;                        // SeatStyle
+    glm::vec3 position;
+};
+
+// laid out as forest.h uploads it, one record per instance
+struct SceneTree {
+    glm::vec4 placement;              // x y z of the foot of the trunk, yaw in radians
+    glm::vec4 look;                   // scale, then r g b multiplying the forest's color
+};
+
+struct SceneCacheHeader {
+    unsigned int magic;
+    unsigned int version;
+    long long sourceSize;
+    long long sourceTime;
+    unsigned int count[SCENE_SECTION_COUNT];
+    unsigned int offset[SCENE_SECTION_COUNT];  // bytes from the start of the file, 16-byte aligned
+};
+
+class SceneFile {
+public:
+    SceneFile() {}
+
+    SceneFile(const SceneFile&) = delete;
+    SceneFile& operator=(const SceneFile&) = delete;
+
+    // uses path + ".bin" when it is up to date, otherwise parses path and rewrites the cache
+    bool load(const std::string& path)
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        std::string cachePath = path + ".bin";
+
+        long long sourceSize = -1, sourceTime = -1;
+        struct stat info;
+        if (stat(path.c_str(), &info) == 0)
+        {
+            sourceSize = (long long)info.st_size;
+            sourceTime = (long long)info.st_mtime;
+        }
+
+        fromCache = readCache(cachePath, sourceSize, sourceTime);
+        if (!fromCache)
+        {
+            if (sourceSize < 0)
+            {
+                std::cout << "SceneFile: cannot open " << path << std::endl;
+                return false;
+            }
+            if (!parse(path, sourceSize, sourceTime))
+                return false;
+            writeCache(cachePath);
+        }
+
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << "SceneFile: " << objectCount() << " objects, " << seatCount() << " seats, " << pointLightCount() << " point lights, "
+            << treeCount() << " trees from "
+            << (fromCache ? cachePath : path) << " in " << milliseconds << " ms" << std::endl;
+        return true;
+    }
+
+    bool loadedFromCache() const
+    {
+        return fromCache;
+    }
+
+    const SceneTexture* textures() const { return section<SceneTexture>(SCENE_TEXTURES); }
+    size_t textureCount() const { return count(SCENE_TEXTURES); }
+
+    const SceneMaterial* materials() const { return section<SceneMaterial>(SCENE_MATERIALS); }
+    size_t materialCount() const { return count(SCENE_MATERIALS); }
+
+    const ScenePointLight* pointLights() const { return section<ScenePointLight>(SCENE_POINT_LIGHTS); }
+    size_t pointLightCount() const { return count(SCENE_POINT_LIGHTS); }
+
+    const SceneSpotLight* spotLights() const { return section<SceneSpotLight>(SCENE_SPOT_LIGHTS); }
+    size_t spotLightCount() const { return count(SCENE_SPOT_LIGHTS); }
+
+    const SceneObject* objects() const { return section<SceneObject>(SCENE_OBJECTS); }
+    size_t objectCount() const { return count(SCENE_OBJECTS); }
+
+    const SceneSeat* seats() const { return section<SceneSeat>(SCENE_SEATS); }
+    size_t seatCount() const { return count(SCENE_SEATS); }
+
+    const SceneTree* trees() const { return section<SceneTree>(SCENE_TREES); }
+    size_t treeCount() const { return count(SCENE_TREES); }
+
+    // the largest factor any object of this drawable is scaled by, 1 when there is none; a tolerance
+    // in world units divided by it is one the mesh can be cut to in its own units
+    float largestScale(const char* drawable) const
+    {
+        float largest = 0.0f;
+        for (size_t i = 0; i < objectCount(); i++)
+        {
+            if (strcmp(objects()[i].drawable, drawable) != 0)
+                continue;
+            const glm::mat4& m = objects()[i].model;
+            for (int axis = 0; axis < 3; axis++)
+                largest = std::max(largest, glm::length(glm::vec3(m[axis])));
+        }
+        return largest > 0.0f ? largest : 1.0f;
+    }
+
+private:
+    MappedFile cache;                    // the cache file, when it was up to date
+    std::vector<unsigned char> blob;     // the cache image, when the text was parsed instead
+    const unsigned char* image = NULL;   // whichever of the two holds the scene, header first
+    size_t imageSize = 0;
+    bool fromCache = false;
+
+    const SceneCacheHeader& header() const
+    {
+        return *(const SceneCacheHeader*)image;
+    }
+
+    size_t count(int s) const
+    {
+        return image == NULL ? 0 : header().count[s];
+    }
+
+    template <class T>
+    const T* section(int s) const
+    {
+        if (count(s) == 0)
+            return NULL;
+        return (const T*)(image + header().offset[s]);
+    }
+
+    static size_t align16(size_t bytes)
+    {
+        return (bytes + 15) & ~(size_t)15;
+    }
+
+    bool readCache(const std::string& cachePath, long long sourceSize, long long sourceTime)
+    {
+        if (!cache.open(cachePath))
+            return false;
+        image = cache.data();
+        imageSize = cache.size();
+        if (imageSize < sizeof(SceneCacheHeader))
+            return rejectCache();
+
+        // a missing source file leaves the cache as the only copy of the scene
+        const SceneCacheHeader& h = header();
+        if (h.magic != SCENE_CACHE_MAGIC || h.version != SCENE_CACHE_VERSION)
+            return rejectCache();
+        if (sourceSize >= 0 && (h.sourceSize != sourceSize || h.sourceTime != sourceTime))
+            return rejectCache();
+
+        static const size_t recordSize[SCENE_SECTION_COUNT] = {
+            sizeof(SceneTexture), sizeof(SceneMaterial), sizeof(ScenePointLight), sizeof(SceneSpotLight), sizeof(SceneObject), sizeof(SceneSeat),
+            sizeof(SceneTree)
+        };
+        for (int s = 0; s < SCENE_SECTION_COUNT; s++)
+            if (h.offset[s] % 16 != 0 || h.offset[s] + (size_t)h.count[s] * recordSize[s] > imageSize)
+                return rejectCache();
+        return true;
+    }
+
+    bool rejectCache()
+    {
+        cache.close();
+        image = NULL;
+        imageSize = 0;
+        return false;
+    }
+
+    void writeCache(const std::string& cachePath) const
+    {
+        std::ofstream file(cachePath.c_str(), std::ios::binary | std::ios::trunc);
+        if (file)
+            file.write((const char*)&blob[0], blob.size());
+        if (!file)
+            std::cout << "SceneFile: could not write " << cachePath << std::endl;
+    }
+
+    template <class T>
+    static void pack(std::vector<unsigned char>& image, SceneCacheHeader& h, int s, const std::vector<T>& records)
+    {
+        h.count[s] = (unsigned int)records.size();
+        h.offset[s] = (unsigned int)image.size();
+        if (!records.empty())
+        {
+            image.resize(align16(image.size() + records.size() * sizeof(T)));
+            memcpy(&image[h.offset[s]], &records[0], records.size() * sizeof(T));
+        }
+    }
+
+    static void copyName(char* destination, size_t size, const std::string& source)
+    {
+        memset(destination, 0, size);
+        strncpy(destination, source.c_str(), size - 1);
+    }
+
+    static bool readVec3(std::istringstream& in, glm::vec3& v)
+    {
+        return (bool)(in >> v.x >> v.y >> v.z);
+    }
+
+    // a forest line, scattered once the whole file is read so every clearing counts
+    struct ForestArea {
+        int count;
+        glm::vec2 min, max;
+        float ground;
+        float minScale, maxScale;
+        unsigned int seed;
+    };
+
+    // uniform in [0, 1) from the top 24 bits, the same on every standard library
+    static float random01(std::mt19937& random)
+    {
+        return (float)(random() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    static bool inClearing(const std::vector<glm::vec4>& clearings, float x, float z)
+    {
+        for (size_t i = 0; i < clearings.size(); i++)
+            if (x >= clearings[i].x && z >= clearings[i].y && x <= clearings[i].z && z <= clearings[i].w)
+                return true;
+        return false;
+    }
+
+    // count trees at random spots of the area outside every clearing, each turned, scaled and tinted
+    // its own way; gives up after a few attempts per tree when the clearings cover most of it
+    static void scatter(const ForestArea& area, const std::vector<glm::vec4>& clearings, std::vector<SceneTree>& trees)
+    {
+        std::mt19937 random(area.seed);
+        int planted = 0;
+        for (int attempt = 0; planted < area.count && attempt < area.count * 20; attempt++)
+        {
+            float x = area.min.x + (area.max.x - area.min.x) * random01(random);
+            float z = area.min.y + (area.max.y - area.min.y) * random01(random);
+            float yaw = 6.28318530718f * random01(random);
+            float scale = area.minScale + (area.maxScale - area.minScale) * random01(random);
+            // lighter or darker, yellower or bluer
+            float shade = 0.75f + 0.4f * random01(random);
+            float warmth = random01(random);
+            if (inClearing(clearings, x, z))
+                continue;
+            SceneTree tree;
+            tree.placement = glm::vec4(x, area.ground, z, yaw);
+            tree.look = glm::vec4(scale, shade * (0.7f + 0.6f * warmth), shade, shade * (1.3f - 0.6f * warmth));
+            trees.push_back(tree);
+            planted++;
+        }
+    }
+
+    bool parse(const std::string& path, long long sourceSize, long long sourceTime)
+    {
+        std::ifstream file(path.c_str());
+        if (!file)
+        {
+            std::cout << "SceneFile: cannot open " << path << std::endl;
+            return false;
+        }
+
+        std::vector<SceneTexture> textureList;
+        std::vector<SceneMaterial> materialList;
+        std::vector<ScenePointLight> pointLightList;
+        std::vector<SceneSpotLight> spotLightList;
+        std::vector<SceneObject> objectList;
+        std::vector<SceneSeat> seatList;
+        std::vector<SceneTree> treeList;
+        std::vector<ForestArea> forests;
+        std::vector<glm::vec4> clearings;  // min x z, max x z
+
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            lineNumber++;
+            size_t comment = line.find('#');
+            if (comment != std::string::npos)
+                line.erase(comment);
+
+            std::istringstream in(line);
+            std::string directive;
+            if (!(in >> directive))
+                continue;
+
+            bool ok = true;
+            if (directive == "texture")
+            {
+                SceneTexture texture;
+                std::string name, texturePath;
+                ok = (bool)(in >> name >> texturePath);
+                copyName(texture.name, sizeof(texture.name), name);
+                copyName(texture.path, sizeof(texture.path), texturePath);
+                if (ok)
+                    textureList.push_back(texture);
+            }
+            else if (directive == "material")
+            {
+                SceneMaterial material;
+                std::string name, kind, texture;
+                ok = (bool)(in >> name >> kind >> texture >> material.shininess
+                    >> material.textureRange.x >> material.textureRange.y >> material.textureRange.z >> material.textureRange.w);
+                copyName(material.name, sizeof(material.name), name);
+                copyName(material.kind, sizeof(material.kind), kind);
+                copyName(material.texture, sizeof(material.texture), texture);
+                if (ok)
+                    materialList.push_back(material);
+            }
+            else if (directive == "pointlight")
+            {
+                ScenePointLight light;
+                ok = readVec3(in, light.position) && readVec3(in, light.ambient) && readVec3(in, light.diffuse) && readVec3(in, light.specular)
+                    && (in >> light.k_c >> light.k_l >> light.k_q >> light.markerSize >> light.markerBrightness);
+                if (ok)
+                    pointLightList.push_back(light);
+            }
+            else if (directive == "spotlight")
+            {
+                SceneSpotLight light;
+                float innerDegrees = 0.0f, outerDegrees = 0.0f;
+                ok = readVec3(in, light.position) && readVec3(in, light.ambient) && readVec3(in, light.diffuse) && readVec3(in, light.specular)
+                    && (in >> light.k_c >> light.k_l >> light.k_q >> innerDegrees >> outerDegrees) && readVec3(in, light.direction);
+                light.innerCutOff = glm::cos(glm::radians(innerDegrees));
+                light.outerCutOff = glm::cos(glm::radians(outerDegrees));
+                if (ok)
+                    spotLightList.push_back(light);
+            }
+            else if (directive == "seatrow")
+            {
+                // count chairs from origin, spacing apart, x stepping by cos(xAngle) and z by sin(zAngle)
+                std::string style;
+                glm::vec3 origin;
+                float xAngle = 0.0f, zAngle = 0.0f, spacing = 0.0f;
+                int chairs = 0;
+                ok = (in >> style) && readVec3(in, origin) && (in >> xAngle >> zAngle >> chairs >> spacing);
+                SceneSeat seat;
+                if (style == "center")
+                    seat.style = SEAT_CENTER;
+                else if (style == "left")
+                    seat.style = SEAT_LEFT;
+                else if (style == "right")
+                    seat.style = SEAT_RIGHT;
+                else
+                    ok = false;
+                for (int i = 0; ok && i < chairs; i++)
+                {
+                    seat.position = origin + glm::vec3(i * spacing * cos(glm::radians(xAngle)), 0.0f, i * spacing * sin(glm::radians(zAngle)));
+                    seatList.push_back(seat);
+                }
+            }
+            else if (directive == "forest")
+            {
+                ForestArea area;
+                ok = (in >> area.count >> area.min.x >> area.min.y >> area.max.x >> area.max.y >> area.ground
+                    >> area.minScale >> area.maxScale >> area.seed) && area.count > 0;
+                if (ok)
+                    forests.push_back(area);
+            }
+            else if (directive == "clearing")
+            {
+                glm::vec4 clearing;
+                ok = (bool)(in >> clearing.x >> clearing.y >> clearing.z >> clearing.w);
+                if (ok)
+                    clearings.push_back(clearing);
+            }
+            else if (directive == "plant")
+            {
+                glm::vec3 position;
+                float degrees = 0.0f, scale = 1.0f;
+                ok = readVec3(in, position) && (in >> degrees >> scale);
+                SceneTree tree;
+                tree.placement = glm::vec4(position, glm::radians(degrees));
+                tree.look = glm::vec4(scale, 1.0f, 1.0f, 1.0f);
+                if (ok)
+                    treeList.push_back(tree);
+            }
+            else if (directive == "object")
+            {
+                // the transforms multiply in the order written, as with glm::translate(model, ...) and friends
+                SceneObject object;
+                std::string drawable, operation;
+                ok = (bool)(in >> drawable);
+                copyName(object.drawable, sizeof(object.drawable), drawable);
+                object.model = glm::mat4(1.0f);
+                while (ok && in >> operation)
+                {
+                    glm::vec3 v;
+                    float degrees = 0.0f;
+                    if (operation == "translate" && readVec3(in, v))
+                        object.model = glm::translate(object.model, v);
+                    else if (operation == "rotate" && (in >> degrees) && readVec3(in, v))
+                        object.model = glm::rotate(object.model, glm::radians(degrees), v);
+                    else if (operation == "scale" && readVec3(in, v))
+                        object.model = glm::scale(object.model, v);
+                    else
+                        ok = false;
+                }
+                if (ok)
+                    objectList.push_back(object);
+            }
+            else
+            {
+                std::cout << "SceneFile: " << path << ":" << lineNumber << ": unknown directive \"" << directive << "\"" << std::endl;
+                continue;
+            }
+
+            if (!ok)
+                std::cout << "SceneFile: " << path << ":" << lineNumber << ": malformed " << directive << ", skipped" << std::endl;
+        }
+
+        for (size_t i = 0; i < forests.size(); i++)
+            scatter(forests[i], clearings, treeList);
+
+        SceneCacheHeader h;
+        memset(&h, 0, sizeof(h));
+        h.magic = SCENE_CACHE_MAGIC;
+        h.version = SCENE_CACHE_VERSION;
+        h.sourceSize = sourceSize;
+        h.sourceTime = sourceTime;
+
+        std::vector<unsigned char> packed(align16(sizeof(SceneCacheHeader)));
+        pack(packed, h, SCENE_TEXTURES, textureList);
+        pack(packed, h, SCENE_MATERIALS, materialList);
+        pack(packed, h, SCENE_POINT_LIGHTS, pointLightList);
+        pack(packed, h, SCENE_SPOT_LIGHTS, spotLightList);
+        pack(packed, h, SCENE_OBJECTS, objectList);
+        pack(packed, h, SCENE_SEATS, seatList);
+        pack(packed, h, SCENE_TREES, treeList);
+        memcpy(&packed[0], &h, sizeof(h));
+        blob.swap(packed);
+        image = &blob[0];
+        imageSize = blob.size();
+        return true;
+    }
+};
+
+#endif /* sceneFile_h */
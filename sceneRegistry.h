@@ -0,0 +1,90 @@
+//
+//  sceneRegistry.h
+//  test
+//
+//  Owns every mesh of the scene for the lifetime of the program. Meshes are
+//  built once before the render loop and looked up by reference afterwards,
+//  so nothing allocates GL objects while frames are being drawn.
+//
+
+#ifndef sceneRegistry_h
+#define sceneRegistry_h
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class SceneRegistry {
+public:
+    SceneRegistry() {}
+    ~SceneRegistry()
+    {
+        clear();
+    }
+
+    SceneRegistry(const SceneRegistry&) = delete;
+    SceneRegistry& operator=(const SceneRegistry&) = delete;
+
+    // constructs the mesh in place; the reference stays valid until clear()
+    template <class T, class... Args>
+    T& add(const std::string& name, Args&&... args)
+    {
+        if (entries.count(name) != 0)
+            std::cout << "SceneRegistry: \"" << name << "\" is registered twice" << std::endl;
+        Holder<T>* holder = new Holder<T>(std::forward<Args>(args)...);
+        objects.push_back(std::unique_ptr<Entry>(holder));
+        entries[name] = holder;
+        return holder->object;
+    }
+
+    template <class T>
+    T* get(const std::string& name) const
+    {
+        std::unordered_map<std::string, Entry*>::const_iterator it = entries.find(name);
+        if (it == entries.end())
+        {
+            std::cout << "SceneRegistry: no mesh named \"" << name << "\"" << std::endl;
+            return NULL;
+        }
+        Holder<T>* holder = dynamic_cast<Holder<T>*>(it->second);
+        if (holder == NULL)
+        {
+            std::cout << "SceneRegistry: \"" << name << "\" has a different type" << std::endl;
+            return NULL;
+        }
+        return &holder->object;
+    }
+
+    size_t size() const
+    {
+        return objects.size();
+    }
+
+    // destroys the meshes in reverse order of creation; needs the GL context to still be current
+    void clear()
+    {
+        entries.clear();
+        while (!objects.empty())
+            objects.pop_back();
+    }
+
+private:
+    struct Entry {
+        virtual ~Entry() {}
+    };
+
+    template <class T>
+    struct Holder : Entry {
+        T object;
+        template <class... Args>
+        Holder(Args&&... args) : object(std::forward<Args>(args)...) {}
+    };
+
+    std::vector<std::unique_ptr<Entry>> objects;
+    std::unordered_map<std::string, Entry*> entries;
+};
+
+#endif /* sceneRegistry_h */
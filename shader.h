@@ -9,6 +9,33 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
+#include "glState.h"
+
+// location of a uniform resolved once per program; -1 means the uniform is not active
+struct UniformHandle
+{
+    GLint location = -1;
+
+    bool valid() const { return location >= 0; }
+};
+
+// per-frame uniform traffic, reset by the render loop once the frame is done
+struct UniformStats
+{
+    unsigned int driverLookups = 0;  // glGetUniformLocation calls that reached the driver
+    unsigned int nameLookups = 0;    // setters called with a string name (served from the cache)
+    unsigned int uploads = 0;        // glUniform* calls of any kind
+
+    void reset() { driverLookups = nameLookups = uploads = 0; }
+};
+
+inline UniformStats& uniformStats()
+{
+    static UniformStats stats;
+    return stats;
+}
 
 class Shader
 {
@@ -90,6 +117,7 @@ public:
             glAttachShader(ID, geometry);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
+        cacheUniformLocations();
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
@@ -97,72 +125,225 @@ public:
             glDeleteShader(geometry);
 
     }
+#ifdef GL_TESS_CONTROL_SHADER
+    // the same with tessellation control and evaluation stages between the vertex and fragment
+    // shaders; only links in a 4.0 context
+    // ------------------------------------------------------------------------
+    Shader(const char* vertexPath, const char* tessControlPath, const char* tessEvaluationPath, const char* fragmentPath)
+    {
+        unsigned int vertex = compileStage(GL_VERTEX_SHADER, vertexPath, "VERTEX");
+        unsigned int tessControl = compileStage(GL_TESS_CONTROL_SHADER, tessControlPath, "TESS_CONTROL");
+        unsigned int tessEvaluation = compileStage(GL_TESS_EVALUATION_SHADER, tessEvaluationPath, "TESS_EVALUATION");
+        unsigned int fragment = compileStage(GL_FRAGMENT_SHADER, fragmentPath, "FRAGMENT");
+        ID = glCreateProgram();
+        glAttachShader(ID, vertex);
+        glAttachShader(ID, tessControl);
+        glAttachShader(ID, tessEvaluation);
+        glAttachShader(ID, fragment);
+        glLinkProgram(ID);
+        checkCompileErrors(ID, "PROGRAM");
+        cacheUniformLocations();
+        glDeleteShader(vertex);
+        glDeleteShader(tessControl);
+        glDeleteShader(tessEvaluation);
+        glDeleteShader(fragment);
+    }
+#endif
+    // whether the program linked; a failed one draws nothing
+    // ------------------------------------------------------------------------
+    bool linked() const
+    {
+        GLint success = 0;
+        glGetProgramiv(ID, GL_LINK_STATUS, &success);
+        return success != 0;
+    }
     // activate the shader
     // ------------------------------------------------------------------------
     void use()
     {
-        glUseProgram(ID);
+        useProgram(ID);
+    }
+    // resolve a uniform once; the result can be kept and passed to the setters below
+    // ------------------------------------------------------------------------
+    UniformHandle getUniformHandle(const std::string& name) const
+    {
+        UniformHandle handle;
+        std::unordered_map<std::string, GLint>::const_iterator it = uniformLocations.find(name);
+        if (it != uniformLocations.end())
+        {
+            handle.location = it->second;
+            return handle;
+        }
+        // not an active uniform reported at link time (or an inactive one): ask once and remember
+        handle.location = glGetUniformLocation(ID, name.c_str());
+        uniformStats().driverLookups++;
+        uniformLocations[name] = handle.location;
+        return handle;
     }
     // utility uniform functions
     // ------------------------------------------------------------------------
     void setBool(const std::string& name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        setBool(lookup(name), value);
+    }
+    void setBool(UniformHandle handle, bool value) const
+    {
+        uniformStats().uploads++;
+        glUniform1i(handle.location, (int)value);
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string& name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        setInt(lookup(name), value);
+    }
+    void setInt(UniformHandle handle, int value) const
+    {
+        uniformStats().uploads++;
+        glUniform1i(handle.location, value);
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string& name, float value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        setFloat(lookup(name), value);
+    }
+    void setFloat(UniformHandle handle, float value) const
+    {
+        uniformStats().uploads++;
+        glUniform1f(handle.location, value);
     }
     // ------------------------------------------------------------------------
     void setVec2(const std::string& name, const glm::vec2& value) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec2(lookup(name), value);
     }
     void setVec2(const std::string& name, float x, float y) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        setVec2(lookup(name), glm::vec2(x, y));
+    }
+    void setVec2(UniformHandle handle, const glm::vec2& value) const
+    {
+        uniformStats().uploads++;
+        glUniform2fv(handle.location, 1, &value[0]);
     }
     // ------------------------------------------------------------------------
     void setVec3(const std::string& name, const glm::vec3& value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec3(lookup(name), value);
     }
     void setVec3(const std::string& name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        setVec3(lookup(name), glm::vec3(x, y, z));
+    }
+    void setVec3(UniformHandle handle, const glm::vec3& value) const
+    {
+        uniformStats().uploads++;
+        glUniform3fv(handle.location, 1, &value[0]);
     }
     // ------------------------------------------------------------------------
     void setVec4(const std::string& name, const glm::vec4& value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec4(lookup(name), value);
     }
     void setVec4(const std::string& name, float x, float y, float z, float w)
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        setVec4(lookup(name), glm::vec4(x, y, z, w));
+    }
+    void setVec4(UniformHandle handle, const glm::vec4& value) const
+    {
+        uniformStats().uploads++;
+        glUniform4fv(handle.location, 1, &value[0]);
     }
     // ------------------------------------------------------------------------
     void setMat2(const std::string& name, const glm::mat2& mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat2(lookup(name), mat);
+    }
+    void setMat2(UniformHandle handle, const glm::mat2& mat) const
+    {
+        uniformStats().uploads++;
+        glUniformMatrix2fv(handle.location, 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat3(const std::string& name, const glm::mat3& mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat3(lookup(name), mat);
+    }
+    void setMat3(UniformHandle handle, const glm::mat3& mat) const
+    {
+        uniformStats().uploads++;
+        glUniformMatrix3fv(handle.location, 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat4(const std::string& name, const glm::mat4& mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat4(lookup(name), mat);
+    }
+    void setMat4(UniformHandle handle, const glm::mat4& mat) const
+    {
+        uniformStats().uploads++;
+        glUniformMatrix4fv(handle.location, 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
+    // name -> location for every active uniform, plus any misses asked for later
+    mutable std::unordered_map<std::string, GLint> uniformLocations;
+
+    UniformHandle lookup(const std::string& name) const
+    {
+        uniformStats().nameLookups++;
+        return getUniformHandle(name);
+    }
+
+    // walk the active uniforms once after linking so the setters never hit the driver
+    // ------------------------------------------------------------------------
+    void cacheUniformLocations()
+    {
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<GLchar> nameBuffer(maxLength > 0 ? maxLength : 1);
+        for (GLint i = 0; i < count; i++)
+        {
+            GLint size = 0;
+            GLenum type = 0;
+            GLsizei length = 0;
+            glGetActiveUniform(ID, (GLuint)i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+            std::string name(nameBuffer.data(), length);
+            GLint location = glGetUniformLocation(ID, name.c_str());
+            uniformLocations[name] = location;
+            // arrays of plain types are reported as "name[0]"; make "name" resolve too
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+                uniformLocations[name.substr(0, name.size() - 3)] = location;
+        }
+    }
+
+    // reads and compiles one stage; a file that cannot be read is reported and compiles as empty
+    // ------------------------------------------------------------------------
+    unsigned int compileStage(GLenum type, const char* path, const std::string& name)
+    {
+        std::string code;
+        std::ifstream file;
+        file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        try
+        {
+            file.open(path);
+            std::stringstream stream;
+            stream << file.rdbuf();
+            file.close();
+            code = stream.str();
+        }
+        catch (std::ifstream::failure& e)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << " " << e.what() << std::endl;
+        }
+        const char* source = code.c_str();
+        unsigned int shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        checkCompileErrors(shader, name);
+        return shader;
+    }
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
@@ -7,6 +7,12 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "shader.h"
+#include "glResources.h"
+#include "renderQueue.h"
+#include "bounds.h"
+#include "materialTable.h"
+#include "lod.h"
+#include "revolve.h"
 
 # define PI 3.1416
 
@@ -18,48 +24,40 @@ const int MIN_MINOR_SEGMENTS = 3;
 const int MIN_SECTOR_COUNT = 3;
 const int MIN_STACK_COUNT = 2;
 
+// the coarsest levels of detail keep at least this much of the shape
+const int MIN_LOD_MAJOR_SEGMENTS = 8;
+const int MIN_LOD_MINOR_SEGMENTS = 4;
+const int MIN_LOD_SECTOR_COUNT = 8;
+const int MIN_LOD_STACK_COUNT = 4;
+
 class Torus {
 public:
     glm::vec3 ambient;
     glm::vec3 diffuse;
     glm::vec3 specular;
     float shininess;
+    int materialIndex = 0;  // row in MaterialTable
 
     // Constructor
     Torus(float majorRadius = 1.0f, float minorRadius = 0.3f, int majorSegments = 36, int minorSegments = 18,
         glm::vec3 amb = glm::vec3(1.0, 0.0, 0.0), glm::vec3 diff = glm::vec3(1.0, 0.0, 0.0),
         glm::vec3 spec = glm::vec3(1.0f, 0.0f, 0.0f), float shiny = 32.0f) : verticesStride(24) {
         set(majorRadius, minorRadius, majorSegments, minorSegments, amb, diff, spec, shiny);
-        buildCoordinatesAndIndices();
-        buildVertices();
-
-        // Generate VAO, VBO, EBO
-        glGenVertexArrays(1, &torusVAO);
-        glBindVertexArray(torusVAO);
-
-        unsigned int torusVBO, torusEBO;
-
-        glGenBuffers(1, &torusVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, torusVBO);
-        glBufferData(GL_ARRAY_BUFFER, this->getVertexSize(), this->getVertices(), GL_STATIC_DRAW);
-
-        glGenBuffers(1, &torusEBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, torusEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->getIndexSize(), this->getIndices(), GL_STATIC_DRAW);
-
-        // Enable attribute arrays
-        glEnableVertexAttribArray(0); // Position
-        glEnableVertexAttribArray(1); // Normal
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, verticesStride, (void*)0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, verticesStride, (void*)(3 * sizeof(float)));
-
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        // coarse levels first, so the vectors are left holding the full one
+        for (int level = LOD_LEVELS - 1; level >= 0; level--)
+        {
+            build(lodSegments(this->majorSegments, level, MIN_LOD_MAJOR_SEGMENTS),
+                lodSegments(this->minorSegments, level, MIN_LOD_MINOR_SEGMENTS));
+            levels[level].upload(geometry.vertices, geometry.indices, verticesStride / sizeof(float));
+        }
+        bounds = Bounds::fromVertices(geometry.vertices.data(), geometry.vertexCount(), 6);
     }
 
-    ~Torus() {}
+    ~Torus()
+    {
+        for (int level = 0; level < LOD_LEVELS; level++)
+            levels[level].release();
+    }
 
     // Set parameters
     void set(float majorRadius, float minorRadius, int majorSegments, int minorSegments, glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny) {
@@ -73,97 +71,59 @@ public:
         this->diffuse = diff;
         this->specular = spec;
         this->shininess = shiny;
+        this->materialIndex = MaterialTable::shared().add(amb, diff, spec, shiny);
     }
 
     // Accessors
-    unsigned int getVertexCount() const { return (unsigned int)coordinates.size() / 3; }
-    unsigned int getVertexSize() const { return (unsigned int)vertices.size() * sizeof(float); }
+    unsigned int getVertexCount() const { return (unsigned int)geometry.vertexCount(); }
+    unsigned int getVertexSize() const { return (unsigned int)geometry.vertices.size() * sizeof(float); }
     int getVerticesStride() const { return verticesStride; }
-    const float* getVertices() const { return vertices.data(); }
+    const float* getVertices() const { return geometry.vertices.data(); }
 
-    unsigned int getIndexCount() const { return (unsigned int)indices.size(); }
-    unsigned int getIndexSize() const { return (unsigned int)indices.size() * sizeof(unsigned int); }
-    const unsigned int* getIndices() const { return indices.data(); }
+    unsigned int getIndexCount() const { return (unsigned int)geometry.indices.size(); }
+    unsigned int getIndexSize() const { return (unsigned int)geometry.indices.size() * sizeof(unsigned int); }
+    const unsigned int* getIndices() const { return geometry.indices.data(); }
 
     // Draw torus
     void drawTorus(Shader& shader, glm::mat4 model) const {
         shader.use();
-        shader.setVec3("material.ambient", this->ambient);
-        shader.setVec3("material.diffuse", this->diffuse);
-        shader.setVec3("material.specular", this->specular);
-        shader.setFloat("material.shininess", this->shininess);
+        shader.setInt("materialIndex", this->materialIndex);
         shader.setMat4("model", model);
 
-        glBindVertexArray(torusVAO);
+        bindVertexArray(levels[0].VAO);
         glDrawElements(GL_TRIANGLES, this->getIndexCount(), GL_UNSIGNED_INT, (void*)0);
-        glBindVertexArray(0);
+    }
+
+    // records the torus at the level the node's size on screen calls for
+    void queueTorus(RenderQueue& queue, Shader& shader, const glm::mat4& model, LodState& lod) const
+    {
+        const LodLevel& level = levels[LodSelector::shared().select(localBounds().transformed(model), lod)];
+        queue.addLit(shader, level.VAO, level.indexCount, this->materialIndex, model);
+    }
+
+    // the box of the vertex positions, before any model matrix
+    Bounds localBounds() const
+    {
+        return bounds;
     }
 
 private:
-    unsigned int torusVAO;
+    LodLevel levels[LOD_LEVELS];
+    Bounds bounds;
     float majorRadius, minorRadius;
     int majorSegments, minorSegments;
-    vector<float> vertices;
-    vector<float> normals;
-    vector<unsigned int> indices;
-    vector<float> coordinates;
+    RevolvedMesh geometry;  // the last level built, the full one once the constructor is done
     int verticesStride;
 
-    // Generate torus coordinates and indices
-    void buildCoordinatesAndIndices() {
-        float majorStep = 2.0f * PI / majorSegments;
-        float minorStep = 2.0f * PI / minorSegments;
-
-        // Generate vertices
-        for (int i = 0; i <= majorSegments; ++i) {
-            float majorAngle = i * majorStep;
-            glm::vec3 majorCircle(cos(majorAngle), 0.0f, sin(majorAngle));
-
-            for (int j = 0; j <= minorSegments; ++j) {
-                float minorAngle = j * minorStep;
-                float x = (majorRadius + minorRadius * cos(minorAngle)) * majorCircle.x;
-                float y = minorRadius * sin(minorAngle);
-                float z = (majorRadius + minorRadius * cos(minorAngle)) * majorCircle.z;
-
-                coordinates.push_back(x);
-                coordinates.push_back(y);
-                coordinates.push_back(z);
-
-                glm::vec3 normal = glm::normalize(glm::vec3(cos(minorAngle) * majorCircle.x, sin(minorAngle), cos(minorAngle) * majorCircle.z));
-                normals.push_back(normal.x);
-                normals.push_back(normal.y);
-                normals.push_back(normal.z);
-            }
-        }
-
-        // Generate indices
-        for (int i = 0; i < majorSegments; ++i) {
-            for (int j = 0; j < minorSegments; ++j) {
-                int current = i * (minorSegments + 1) + j;
-                int next = (i + 1) * (minorSegments + 1) + j;
-
-                indices.push_back(current);
-                indices.push_back(next);
-                indices.push_back(current + 1);
-
-                indices.push_back(current + 1);
-                indices.push_back(next);
-                indices.push_back(next + 1);
-            }
-        }
-    }
-
-    // Interleave vertices and normals
-    void buildVertices() {
-        for (size_t i = 0; i < coordinates.size(); i += 3) {
-            vertices.push_back(coordinates[i]);
-            vertices.push_back(coordinates[i + 1]);
-            vertices.push_back(coordinates[i + 2]);
-
-            vertices.push_back(normals[i]);
-            vertices.push_back(normals[i + 1]);
-            vertices.push_back(normals[i + 2]);
-        }
+    // the minor circle, swept round the major one
+    void build(int majors, int minors) {
+        const SinCosTable& minor = sinCosTable(RevolveSweep::full(minors));
+        float R = majorRadius, r = minorRadius;
+        revolve([&minor, R, r, minors](int j) {
+            float c = minor.cosines[j], s = minor.sines[j];
+            ProfilePoint point = { R + r * c, r * s, c, s, (float)j / minors };
+            return point;
+        }, minors + 1, RevolveSweep::full(majors), geometry, 0);
     }
 };
 
@@ -182,42 +142,21 @@ public:
         float shiny = 32.0f) : verticesStride(32)
     {
         set(radius, sectorCount, stackCount, amb, diff, spec, shiny);
-        buildCoordinatesAndIndices();
-        buildVertices();
-
-        glGenVertexArrays(1, &sphereVAO);
-        glBindVertexArray(sphereVAO);
-
-        // Create VBO for vertex data
-        unsigned int sphereVBO;
-        glGenBuffers(1, &sphereVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
-        glBufferData(GL_ARRAY_BUFFER, this->getVertexSize(), this->getVertices(), GL_STATIC_DRAW);
-
-        // Create EBO for index data
-        unsigned int sphereEBO;
-        glGenBuffers(1, &sphereEBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->getIndexSize(), this->getIndices(), GL_STATIC_DRAW);
-
-        // Enable vertex attributes
-        glEnableVertexAttribArray(0); // Position
-        glEnableVertexAttribArray(1); // Normal
-        glEnableVertexAttribArray(2); // Texture Coordinates
-
-        // Set attribute pointers
-        int stride = this->getVerticesStride();
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);                        // Position
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 3));      // Normal
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 6));      // Texture Coordinates
-
-        // Unbind VAO and buffers
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        // coarse levels first, so the vectors are left holding the full one
+        for (int level = LOD_LEVELS - 1; level >= 0; level--)
+        {
+            build(lodSegments(this->sectorCount, level, MIN_LOD_SECTOR_COUNT),
+                lodSegments(this->stackCount, level, MIN_LOD_STACK_COUNT));
+            levels[level].upload(geometry.vertices, geometry.indices, verticesStride / sizeof(float));
+        }
+        bounds = Bounds::fromVertices(geometry.vertices.data(), geometry.vertexCount(), 8);
     }
 
-    ~SphereTex() {}
+    ~SphereTex()
+    {
+        for (int level = 0; level < LOD_LEVELS; level++)
+            levels[level].release();
+    }
 
     void set(float radius, int sectors, int stacks, glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny)
     {
@@ -237,12 +176,12 @@ public:
 
     unsigned int getVertexCount() const
     {
-        return (unsigned int)coordinates.size() / 3;
+        return (unsigned int)geometry.vertexCount();
     }
 
     unsigned int getVertexSize() const
     {
-        return (unsigned int)vertices.size() * sizeof(float);
+        return (unsigned int)geometry.vertices.size() * sizeof(float);
     }
 
     int getVerticesStride() const
@@ -252,136 +191,77 @@ public:
 
     const float* getVertices() const
     {
-        return vertices.data();
+        return geometry.vertices.data();
     }
 
     unsigned int getIndexSize() const
     {
-        return (unsigned int)indices.size() * sizeof(unsigned int);
+        return (unsigned int)geometry.indices.size() * sizeof(unsigned int);
     }
 
     const unsigned int* getIndices() const
     {
-        return indices.data();
+        return geometry.indices.data();
     }
 
     unsigned int getIndexCount() const
     {
-        return (unsigned int)indices.size();
+        return (unsigned int)geometry.indices.size();
     }
 
     void drawSphere(Shader& lightingShader, unsigned int texture, glm::mat4 model) const
     {
         lightingShader.use();
-
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
         lightingShader.setFloat("material.shininess", this->shininess);
+        lightingShader.setVec4("textureRange", glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
         lightingShader.setMat4("model", model);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, texture);
 
-        glBindVertexArray(sphereVAO);
+        bindVertexArray(levels[0].VAO);
         glDrawElements(GL_TRIANGLES, this->getIndexCount(), GL_UNSIGNED_INT, (void*)0);
-        glBindVertexArray(0);
     }
 
-private:
-    void buildCoordinatesAndIndices()
+    void queueSphere(RenderQueue& queue, Shader& lightingShader, unsigned int texture, const glm::mat4& model) const
     {
-        float x, y, z, xz;
-        float nx, ny, nz, lengthInv = 1.0f / radius;
-        float s, t;
-
-        float sectorStep = 2 * PI / sectorCount;
-        float stackStep = PI / stackCount;
-        float sectorAngle = -sectorStep;
-        float stackAngle = PI / 2 + stackStep;
-
-        for (int i = 0; i <= stackCount; ++i)
-        {
-            stackAngle -= stackStep;
-            xz = radius * cosf(stackAngle);
-            y = radius * sinf(stackAngle);
-
-            for (int j = 0; j <= sectorCount; ++j)
-            {
-                sectorAngle += sectorStep;
-
-                z = xz * cosf(sectorAngle);
-                x = xz * sinf(sectorAngle);
-                coordinates.push_back(x);
-                coordinates.push_back(y);
-                coordinates.push_back(z);
-
-                nx = x * lengthInv;
-                ny = y * lengthInv;
-                nz = z * lengthInv;
-                normals.push_back(nx);
-                normals.push_back(ny);
-                normals.push_back(nz);
-
-                s = (float)j / sectorCount; // U-coordinate
-                t = (float)i / stackCount; // V-coordinate
-                texCoords.push_back(s);
-                texCoords.push_back(t);
-            }
-        }
-
-        int k1, k2;
-        for (int i = 0; i < stackCount; ++i)
-        {
-            k1 = i * (sectorCount + 1);
-            k2 = k1 + sectorCount + 1;
-
-            for (int j = 0; j < sectorCount; ++j, ++k1, ++k2)
-            {
-                if (i != 0)
-                {
-                    indices.push_back(k1);
-                    indices.push_back(k2);
-                    indices.push_back(k1 + 1);
-                }
-
-                if (i != (stackCount - 1))
-                {
-                    indices.push_back(k1 + 1);
-                    indices.push_back(k2);
-                    indices.push_back(k2 + 1);
-                }
-            }
-        }
+        queue.addTextured(lightingShader, levels[0].VAO, this->getIndexCount(), texture, texture, this->shininess,
+            glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), model);
     }
 
-    void buildVertices()
+    // the same at the level the node's size on screen calls for
+    void queueSphere(RenderQueue& queue, Shader& lightingShader, unsigned int texture, const glm::mat4& model, LodState& lod) const
     {
-        for (size_t i = 0; i < coordinates.size(); i += 3)
-        {
-            vertices.push_back(coordinates[i]);
-            vertices.push_back(coordinates[i + 1]);
-            vertices.push_back(coordinates[i + 2]);
+        const LodLevel& level = levels[LodSelector::shared().select(localBounds().transformed(model), lod)];
+        queue.addTextured(lightingShader, level.VAO, level.indexCount, texture, texture, this->shininess,
+            glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), model);
+    }
 
-            vertices.push_back(normals[i]);
-            vertices.push_back(normals[i + 1]);
-            vertices.push_back(normals[i + 2]);
+    // the box of the vertex positions, before any model matrix
+    Bounds localBounds() const
+    {
+        return bounds;
+    }
 
-            size_t texIndex = i / 3 * 2;
-            vertices.push_back(texCoords[texIndex]);
-            vertices.push_back(texCoords[texIndex + 1]);
-        }
+private:
+    // the half circle from the north pole to the south one, swept round with the seam at +z
+    void build(int sectors, int stacks)
+    {
+        const SinCosTable& latitude = sinCosTable(RevolveSweep::arc(stacks, (float)(REVOLVE_FULL_TURN / 4.0), (float)(-REVOLVE_FULL_TURN / 2.0)));
+        float R = radius;
+        revolve([&latitude, R, stacks](int i) {
+            // exactly 0 at the poles, so their collapsed triangles are left out
+            float c = (i == 0 || i == stacks) ? 0.0f : latitude.cosines[i], s = latitude.sines[i];
+            ProfilePoint point = { R * c, R * s, c, s, (float)i / stacks };
+            return point;
+        }, stacks + 1, RevolveSweep::arc(sectors, (float)(REVOLVE_FULL_TURN / 4.0), (float)-REVOLVE_FULL_TURN), geometry);
     }
 
-    unsigned int sphereVAO;
+    LodLevel levels[LOD_LEVELS];
+    Bounds bounds;
     float radius;
     int sectorCount;
     int stackCount;
-    std::vector<float> vertices;
-    std::vector<float> normals;
-    std::vector<float> texCoords;
-    std::vector<unsigned int> indices;
-    std::vector<float> coordinates;
+    RevolvedMesh geometry;  // the last level built, the full one once the constructor is done
     int verticesStride;
 };
 
@@ -0,0 +1,90 @@
+//
+//  tessellate.h
+//  test
+//
+//  How finely to cut a curve so that no chord strays from it by more than a
+//  tolerance. A circular arc has the same curvature everywhere, so its
+//  segment count follows from the radius alone. A general curve is cut
+//  where it bends: a span is split in two while the curve between its ends
+//  strays too far from the chord, so flat stretches stay a single span and
+//  tight wiggles get as many as they need.
+//
+
+#ifndef tessellate_h
+#define tessellate_h
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// spans the curve is cut into before any is tested, so a wiggle that crosses its chord at the
+// probes cannot pass for flat
+#define TESSELLATION_INITIAL_SPANS 8
+// no span is halved more often than this
+#define TESSELLATION_MAX_DEPTH 12
+
+// segments for an arc of radius through sweep radians whose chords stay within tolerance of it
+inline int chordSegments(float radius, float sweep, float tolerance, int minimum)
+{
+    radius = fabsf(radius);
+    sweep = fabsf(sweep);
+    if (radius <= tolerance)
+        return minimum;
+    // a chord over angle a misses the arc by radius * (1 - cos(a / 2)) at its middle
+    float step = 2.0f * acosf(1.0f - tolerance / radius);
+    return std::max(minimum, (int)ceilf(sweep / step));
+}
+
+// the distance from p to the segment from a to b
+inline float distanceToChord(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b)
+{
+    glm::vec2 ab = b - a;
+    float lengthSquared = glm::dot(ab, ab);
+    float f = lengthSquared > 0.0f ? glm::clamp(glm::dot(p - a, ab) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+    return glm::length(p - (a + ab * f));
+}
+
+// parameters from 0 to 1, in order, such that the curve between each two stays within tolerance of
+// their chord; curve(t) gives the point at t. Each span is probed at its quarters
+template <class Curve>
+std::vector<float> adaptiveParameters(const Curve& curve, float tolerance)
+{
+    struct Span {
+        float t0, t1;
+        glm::vec2 p0, p1;
+        int depth;
+    };
+
+    std::vector<float> parameters(1, 0.0f);
+    std::vector<Span> pending;
+    // pushed last to first, so spans come off the back in order of t
+    for (int i = TESSELLATION_INITIAL_SPANS - 1; i >= 0; i--)
+    {
+        float t0 = (float)i / TESSELLATION_INITIAL_SPANS, t1 = (float)(i + 1) / TESSELLATION_INITIAL_SPANS;
+        Span span = { t0, t1, curve(t0), curve(t1), 0 };
+        pending.push_back(span);
+    }
+    while (!pending.empty())
+    {
+        Span span = pending.back();
+        pending.pop_back();
+        float tm = (span.t0 + span.t1) * 0.5f;
+        glm::vec2 pm = curve(tm);
+        float deviation = std::max(distanceToChord(pm, span.p0, span.p1),
+            std::max(distanceToChord(curve((span.t0 + tm) * 0.5f), span.p0, span.p1),
+                distanceToChord(curve((tm + span.t1) * 0.5f), span.p0, span.p1)));
+        if (deviation > tolerance && span.depth < TESSELLATION_MAX_DEPTH)
+        {
+            Span second = { tm, span.t1, pm, span.p1, span.depth + 1 };
+            Span first = { span.t0, tm, span.p0, pm, span.depth + 1 };
+            pending.push_back(second);
+            pending.push_back(first);
+        }
+        else
+            parameters.push_back(span.t1);
+    }
+    return parameters;
+}
+
+#endif /* tessellate_h */
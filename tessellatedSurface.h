@@ -0,0 +1,228 @@
+//
+//  tessellatedSurface.h
+//  test
+//
+//  Curved surfaces cut into triangles on the GPU. Only the control points
+//  are uploaded: the profiles go into a texture buffer, binomials folded in
+//  as bezierEval.h keeps them, and each patch is a single vertex naming the
+//  range of angles it is swept through, the two profiles it runs between
+//  and the range of t it covers. The tessellation control shader probes
+//  every edge of a patch, measures how far the curve strays from the chord
+//  in pixels at its distance from the eye, and asks for just enough
+//  segments to bring that under TESSELLATION_TOLERANCE_PIXELS. The levels
+//  are fractional, so the detail follows the camera without popping.
+//
+//  A patch is the surface of revolution of a profile when both profiles
+//  are the same one, and a flat strip between them when the sweep has no
+//  angle (the ends of the curved wall). Neighbouring patches give their
+//  shared edge the same numbers, so both sides cut it alike.
+//
+//  This needs a 4.0 context. Without one TessellationPath stays disabled
+//  and the surfaces build their meshes on the CPU (see tessellate.h).
+//
+
+#ifndef tessellatedSurface_h
+#define tessellatedSurface_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "shader.h"
+#include "glResources.h"
+#include "renderQueue.h"
+#include "bezierEval.h"
+
+#if defined(GL_PATCHES) && defined(GL_TESS_CONTROL_SHADER)
+#define TESSELLATION_SUPPORTED 1
+#endif
+
+// how far in pixels the triangles may stray from the true surface
+#define TESSELLATION_TOLERANCE_PIXELS 0.5f
+// patch vertex attributes, see vertexShaderForTessellatedSurface.vs
+#define TESSELLATED_PATCH_FLOATS 12
+
+// one patch, uploaded as one vertex
+struct SurfacePatch {
+    float angle0, angle1;    // radians swept from u = 0 to u = 1
+    float texU0, texU1;      // texture u at either end of the sweep
+    float firstA, firstB;    // first point of the profile at u = 0 and at u = 1
+    float pointCount;        // points in each profile, degree + 1
+    float radialNormals;     // 1 to light the surface as if it faced straight away from the axis
+    float t0, t1;            // the range of the profiles' t from v = 0 to v = 1
+    float texV0, texV1;      // texture v at either end of that range
+};
+static_assert(sizeof(SurfacePatch) == TESSELLATED_PATCH_FLOATS * sizeof(float), "SurfacePatch must stay tightly packed");
+
+class TessellationPath {
+public:
+    unsigned int uploadedBytes = 0;  // control points and patches of every surface uploaded so far
+
+    static TessellationPath& shared()
+    {
+        static TessellationPath path;
+        return path;
+    }
+
+    // builds the program once the context is up; false, and the path stays disabled, on a context
+    // older than 4.0 or when the shaders do not link
+    bool enable(const char* vertexPath, const char* tessControlPath, const char* tessEvaluationPath, const char* fragmentPath)
+    {
+#ifdef TESSELLATION_SUPPORTED
+        GLint major = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        if (major < 4)
+            return false;
+        program.reset(new Shader(vertexPath, tessControlPath, tessEvaluationPath, fragmentPath));
+        if (!program->linked())
+        {
+            std::cout << "Tessellated surfaces disabled, the program did not link" << std::endl;
+            program.reset();
+            return false;
+        }
+        // every patch is one vertex; nothing else is drawn as patches
+        glPatchParameteri(GL_PATCH_VERTICES, 1);
+        program->use();
+        program->setInt("profilePoints", PACKET_BUFFER_UNIT);
+        return true;
+#else
+        (void)vertexPath;
+        (void)tessControlPath;
+        (void)tessEvaluationPath;
+        (void)fragmentPath;
+        return false;
+#endif
+    }
+
+    bool enabled() const
+    {
+        return program != nullptr;
+    }
+
+    // NULL while disabled
+    Shader* shader() const
+    {
+        return program.get();
+    }
+
+    // once per frame, with the projection the surfaces are drawn with
+    void setView(const glm::mat4& projection, int viewportHeight)
+    {
+        if (!program)
+            return;
+        float pixelsPerUnit = projection[1][1] * 0.5f * (float)viewportHeight;
+        program->use();
+        program->setFloat("tessellationScale", pixelsPerUnit / TESSELLATION_TOLERANCE_PIXELS);
+    }
+
+private:
+    std::unique_ptr<Shader> program;
+
+    TessellationPath() {}
+    TessellationPath(const TessellationPath&) = delete;
+    TessellationPath& operator=(const TessellationPath&) = delete;
+};
+
+// the control points and patches of one surface
+class PatchSurface {
+public:
+    PatchSurface() {}
+    ~PatchSurface()
+    {
+        release();
+    }
+
+    PatchSurface(const PatchSurface&) = delete;
+    PatchSurface& operator=(const PatchSurface&) = delete;
+
+    // a profile's points in the buffer, r and y each with its binomial folded in; returns the
+    // index of its first point for addPatch
+    int addProfile(const BezierEvaluator& curve)
+    {
+        int first = (int)points.size();
+        for (int i = 0; i <= curve.degree(); i++)
+            points.push_back(curve.weighted(i));
+        return first;
+    }
+
+    void addPatch(const SurfacePatch& patch)
+    {
+        patches.push_back(patch);
+    }
+
+    // sends what was added; the CPU copies are dropped
+    void upload()
+    {
+        genBuffers(1, &pointBuffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, pointBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, points.size() * sizeof(glm::vec2), points.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glGenTextures(1, &pointTexture);
+        bindTextureUnit(GL_TEXTURE0 + PACKET_BUFFER_UNIT, GL_TEXTURE_BUFFER, pointTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, pointBuffer);
+
+        genVertexArrays(1, &VAO);
+        bindVertexArray(VAO);
+        genBuffers(1, &patchBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, patchBuffer);
+        glBufferData(GL_ARRAY_BUFFER, patches.size() * sizeof(SurfacePatch), patches.data(), GL_STATIC_DRAW);
+        for (int i = 0; i < 3; i++)
+        {
+            glEnableVertexAttribArray(i);
+            glVertexAttribPointer(i, 4, GL_FLOAT, GL_FALSE, sizeof(SurfacePatch), (void*)(i * 4 * sizeof(float)));
+        }
+        bindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        patchCount = (GLsizei)patches.size();
+        unsigned int bytes = (unsigned int)(points.size() * sizeof(glm::vec2) + patches.size() * sizeof(SurfacePatch));
+        TessellationPath::shared().uploadedBytes += bytes;
+        std::vector<glm::vec2>().swap(points);
+        std::vector<SurfacePatch>().swap(patches);
+    }
+
+    void release()
+    {
+        if (VAO == 0)
+            return;
+        deleteVertexArrays(1, &VAO);
+        deleteBuffers(1, &patchBuffer);
+        deleteBuffers(1, &pointBuffer);
+        forgetTexture(pointTexture);
+        glDeleteTextures(1, &pointTexture);
+        VAO = patchBuffer = pointBuffer = pointTexture = 0;
+        patchCount = 0;
+    }
+
+    bool uploaded() const
+    {
+        return VAO != 0;
+    }
+
+    // with the textured lighting material, through the program of the TessellationPath
+    void queue(RenderQueue& queue, unsigned int diffuseMap, unsigned int specularMap, float shininess, const glm::vec4& textureRange,
+        const glm::mat4& model) const
+    {
+#ifdef TESSELLATION_SUPPORTED
+        Shader* shader = TessellationPath::shared().shader();
+        if (shader != NULL && uploaded())
+            queue.addTexturedBuffer(*shader, VAO, GL_PATCHES, patchCount, pointTexture, diffuseMap, specularMap, shininess, textureRange, model);
+#else
+        (void)queue;
+        (void)diffuseMap;
+        (void)specularMap;
+        (void)shininess;
+        (void)textureRange;
+        (void)model;
+#endif
+    }
+
+private:
+    std::vector<glm::vec2> points;
+    std::vector<SurfacePatch> patches;
+    unsigned int VAO = 0, patchBuffer = 0, pointBuffer = 0, pointTexture = 0;
+    GLsizei patchCount = 0;
+};
+
+#endif /* tessellatedSurface_h */
@@ -0,0 +1,335 @@
+//
+//  textureLoader.h
+//  test
+//
+//  Loads image files off the main thread. request() creates the texture at
+//  once with a 1x1 grey placeholder, so meshes and draw packets can take its
+//  handle right away, and queues the file for a pool of worker threads that
+//  decode it with stb_image. update() runs on the GL thread once per frame:
+//  it copies a few decoded images into a pixel buffer object and respecifies
+//  the same texture from it, so the handle never changes and the placeholder
+//  is simply replaced in place.
+//
+//  With zero worker threads request() decodes and uploads on the spot, which
+//  is how textures were loaded before; the benchmark uses it for comparison.
+//
+//  When an image has an up-to-date block-compressed copy (see ddsTexture.h)
+//  the worker maps that instead and all its levels are uploaded as stored.
+//
+
+#ifndef textureLoader_h
+#define textureLoader_h
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "stb_image.h"
+#include "glResources.h"
+#include "ddsTexture.h"
+
+// decoded images handed to GL per update(), so a burst of finished files does not stall one frame
+#define TEXTURE_UPLOADS_PER_FRAME 2
+#define TEXTURE_UPLOAD_BUFFERS 2
+
+class TextureLoader {
+public:
+    unsigned int loaded = 0;   // textures holding their real image
+    unsigned int failed = 0;   // files that could not be decoded; they keep the placeholder
+    double blockedMilliseconds = 0.0;   // main thread time spent inside request()
+    double residentMilliseconds = 0.0;  // from the first request until the last texture was uploaded
+    unsigned int compressed = 0;        // textures uploaded from a .dds
+    size_t textureBytes = 0;            // what the loaded textures take on the GPU, mip chains included
+
+    // threads < 0 leaves one hardware thread to the main loop, 0 loads synchronously
+    explicit TextureLoader(int threads = -1)
+    {
+        if (threads < 0)
+            threads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+        // stb keeps this flag in a global, so it is set once before any worker reads it
+        stbi_set_flip_vertically_on_load(true);
+        useDDS = ddsSupported();
+        for (int i = 0; i < threads; i++)
+            workers.push_back(std::thread(&TextureLoader::work, this));
+    }
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    ~TextureLoader()
+    {
+        stop();
+    }
+
+    // the texture is usable immediately; its image follows once update() has uploaded it
+    unsigned int request(const char* path, GLenum wrapS, GLenum wrapT, GLenum minFilter, GLenum magFilter)
+    {
+        std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+        if (requested == 0)
+            start = begin;
+
+        unsigned int textureID;
+        glGenTextures(1, &textureID);
+        bindTexture(GL_TEXTURE_2D, textureID);
+        static const unsigned char grey[4] = { 128, 128, 128, 255 };
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+        requested++;
+
+        Job job;
+        job.texture = textureID;
+        job.path = path;
+        if (workers.empty())
+        {
+            Image image = decode(job);
+            upload(image);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(job);
+            wake.notify_one();
+        }
+
+        blockedMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+        return textureID;
+    }
+
+    // textures requested but not uploaded yet
+    unsigned int pending() const
+    {
+        return requested - loaded - failed;
+    }
+
+    // on the GL thread, once per frame
+    void update(int maxUploads = TEXTURE_UPLOADS_PER_FRAME)
+    {
+        for (int i = 0; i < maxUploads; i++)
+        {
+            Image image;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (decoded.empty())
+                    return;
+                image = decoded.front();
+                decoded.pop_front();
+            }
+            upload(image);
+        }
+    }
+
+    // blocks until every requested texture holds its image, e.g. before frames are measured
+    void finish()
+    {
+        while (pending() > 0)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                done.wait(lock, [this] { return !decoded.empty(); });
+            }
+            update(1 << 30);
+        }
+    }
+
+    // the pixel buffers need the context, so they are released before glfwTerminate
+    void release()
+    {
+        stop();
+        for (int i = 0; i < TEXTURE_UPLOAD_BUFFERS; i++)
+            if (uploadBuffers[i] != 0)
+                deleteBuffers(1, &uploadBuffers[i]);
+        memset(uploadBuffers, 0, sizeof(uploadBuffers));
+    }
+
+private:
+    struct Job {
+        unsigned int texture;
+        std::string path;
+    };
+
+    struct Image {
+        unsigned int texture = 0;
+        std::string path;
+        int width = 0, height = 0, components = 0;
+        unsigned char* data = NULL;
+        MappedFile* file = NULL;  // set instead of data when a .dds was mapped
+        DDSLevels levels;
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    std::deque<Job> jobs;
+    std::deque<Image> decoded;
+    bool stopping = false;
+    bool useDDS = false;  // written before the workers start
+
+    unsigned int requested = 0;
+    unsigned int uploadBuffers[TEXTURE_UPLOAD_BUFFERS] = { 0 };
+    int nextBuffer = 0;
+    std::chrono::high_resolution_clock::time_point start;
+
+    Image decode(const Job& job) const
+    {
+        Image image;
+        image.texture = job.texture;
+        image.path = job.path;
+        if (useDDS)
+        {
+            image.file = new MappedFile();
+            if (openDDS(job.path, *image.file, image.levels))
+                return image;
+            delete image.file;
+            image.file = NULL;
+        }
+        image.data = stbi_load(job.path.c_str(), &image.width, &image.height, &image.components, 0);
+        return image;
+    }
+
+    static void discard(Image& image)
+    {
+        stbi_image_free(image.data);
+        delete image.file;
+        image.data = NULL;
+        image.file = NULL;
+    }
+
+    void work()
+    {
+        for (;;)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping)
+                    return;
+                job = jobs.front();
+                jobs.pop_front();
+            }
+            Image image = decode(job);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                decoded.push_back(image);
+            }
+            done.notify_one();
+        }
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i].join();
+        workers.clear();
+        for (size_t i = 0; i < decoded.size(); i++)
+            discard(decoded[i]);
+        decoded.clear();
+        jobs.clear();
+    }
+
+    // the pixels go through a pixel buffer, so glTexImage2D reads from GPU-visible memory and returns
+    // without waiting for the copy; orphaning the buffer first keeps it from waiting on the previous upload
+    void upload(Image& image)
+    {
+        if (image.file != NULL)
+        {
+            uploadCompressed(image);
+            return;
+        }
+        if (image.data == NULL)
+        {
+            std::cout << "Texture failed to load at path: " << image.path << std::endl;
+            failed++;
+            finishedOne();
+            return;
+        }
+
+        GLenum format = GL_RGB;
+        if (image.components == 1)
+            format = GL_RED;
+        else if (image.components == 4)
+            format = GL_RGBA;
+        size_t size = (size_t)image.width * image.height * image.components;
+
+        const unsigned char* pixels = stage(image.data, size);
+        bindTexture(GL_TEXTURE_2D, image.texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, pixels);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        // drivers keep RGB8 as four bytes a texel; the mip chain adds a third
+        textureBytes += (size_t)image.width * image.height * 4 * 4 / 3;
+        discard(image);
+        loaded++;
+        finishedOne();
+    }
+
+    // every level of the .dds in one copy; the levels are already compressed and filtered
+    void uploadCompressed(Image& image)
+    {
+        const DDSLevels& levels = image.levels;
+        const unsigned char* base = stage(levels.payload, levels.payloadBytes);
+        bindTexture(GL_TEXTURE_2D, image.texture);
+        int width = levels.width, height = levels.height;
+        for (int i = 0; i < levels.levels; i++)
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, i, levels.format, width, height, 0, (GLsizei)levels.size[i],
+                (const void*)((uintptr_t)base + levels.offset[i]));
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels.levels - 1);
+
+        textureBytes += levels.payloadBytes;
+        discard(image);
+        compressed++;
+        loaded++;
+        finishedOne();
+    }
+
+    // copies data into the next pixel buffer and leaves it bound; the result is what the glTex*Image
+    // calls take as their pixels: an offset into the buffer, or data itself when it could not be mapped
+    const unsigned char* stage(const unsigned char* data, size_t size)
+    {
+        unsigned int& buffer = uploadBuffers[nextBuffer];
+        nextBuffer = (nextBuffer + 1) % TEXTURE_UPLOAD_BUFFERS;
+        if (buffer == 0)
+            genBuffers(1, &buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_DRAW);
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped == NULL)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return data;
+        }
+        memcpy(mapped, data, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        return NULL;
+    }
+
+    void finishedOne()
+    {
+        if (pending() == 0)
+            residentMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+};
+
+#endif /* textureLoader_h */
@@ -10,6 +10,7 @@ out vec2 TexCoords;
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform vec4 textureRange;    // xmin, ymin, xmax, ymax; the shared meshes store 0..1 coordinates
 
 void main()
 {
@@ -17,6 +18,6 @@ void main()
     
     FragPos = vec3(model * vec4(aPos, 1.0));
     Normal = mat3(transpose(inverse(model))) * aNormal;
-    TexCoords = aTexCoords;
+    TexCoords = mix(textureRange.xy, textureRange.zw, aTexCoords);
     
 }
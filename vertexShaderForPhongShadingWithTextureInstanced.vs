@@ -0,0 +1,23 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in mat4 aModel;    // per instance, see instancedBatch.h
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec4 textureRange;    // xmin, ymin, xmax, ymax; the shared meshes store 0..1 coordinates
+
+void main()
+{
+    gl_Position = projection * view * aModel * vec4(aPos, 1.0);
+    
+    FragPos = vec3(aModel * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(aModel))) * aNormal;
+    TexCoords = mix(textureRange.xy, textureRange.zw, aTexCoords);
+    
+}
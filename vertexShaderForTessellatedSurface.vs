@@ -0,0 +1,16 @@
+#version 400 core
+// one vertex per patch, laid out as SurfacePatch in tessellatedSurface.h
+layout (location = 0) in vec4 aSweep;    // angle at u = 0 and u = 1, texture u at both
+layout (location = 1) in vec4 aProfile;  // first point of profile A and B, points per profile, radial normals
+layout (location = 2) in vec4 aSpan;     // t at v = 0 and v = 1, texture v at both
+
+out vec4 vSweep;
+out vec4 vProfile;
+out vec4 vSpan;
+
+void main()
+{
+    vSweep = aSweep;
+    vProfile = aProfile;
+    vSpan = aSpan;
+}
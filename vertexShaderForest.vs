@@ -0,0 +1,49 @@
+#version 330 core
+// the trees of forest.h: the branch mesh or the impostor quad, placed per instance
+layout (location = 0) in vec3 aPos;        // in the tree's own units, the foot of the trunk at the origin
+layout (location = 3) in vec4 aPlacement;  // per instance: x y z of the foot, yaw
+layout (location = 4) in vec4 aLook;       // per instance: scale, then the tint
+
+out vec3 TreeColor;
+out vec2 SilhouetteCoords;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPos;
+uniform vec3 color;
+uniform float impostorDistance;  // along the ground
+uniform bool impostors;          // which of the two draws this is
+uniform vec4 silhouetteBox;      // min x y, max x y of the quad the silhouette was drawn into
+
+void main()
+{
+    // every vertex of a tree comes to the same answer, so the tree is in exactly one of the two draws
+    vec2 toEye = viewPos.xz - aPlacement.xz;
+    if ((length(toEye) > impostorDistance) != impostors)
+    {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);  // outside the clip volume, with the rest of the tree
+        TreeColor = vec3(0.0);
+        SilhouetteCoords = vec2(0.0);
+        return;
+    }
+
+    vec3 offset;
+    if (impostors)
+    {
+        // turned about the trunk to face the eye
+        vec2 side = dot(toEye, toEye) > 1e-8 ? normalize(vec2(-toEye.y, toEye.x)) : vec2(1.0, 0.0);
+        offset = vec3(side.x * aPos.x, aPos.y, side.y * aPos.x);
+        SilhouetteCoords = (aPos.xy - silhouetteBox.xy) / (silhouetteBox.zw - silhouetteBox.xy);
+    }
+    else
+    {
+        float c = cos(aPlacement.w), s = sin(aPlacement.w);
+        offset = vec3(c * aPos.x + s * aPos.z, aPos.y, c * aPos.z - s * aPos.x);
+        SilhouetteCoords = vec2(0.0);
+    }
+
+    // darker at the trunk, lighter towards the tips, the same for both draws
+    float height = clamp((aPos.y - silhouetteBox.y) / (silhouetteBox.w - silhouetteBox.y), 0.0, 1.0);
+    TreeColor = color * aLook.yzw * mix(0.45, 1.0, height);
+    gl_Position = projection * view * vec4(aPlacement.xyz + offset * aLook.x, 1.0);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aModel;    // per instance, see instancedBatch.h
+layout (location = 7) in vec4 aColor;    // per instance
+
+out vec3 InstanceColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    gl_Position = projection * view * aModel * vec4(aPos, 1.0);
+    InstanceColor = aColor.rgb;
+}